@@ -0,0 +1,30 @@
+// Replaces the global operator new with one that counts calls, so
+// heapAllocations() has real numbers. Not part of rogue_core: only the
+// programs that want the count link it, since a replacement operator new
+// applies to the whole program.
+#include "include/AllocStats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> allocations(0);
+
+uint64_t heapAllocations() {
+	return allocations.load(std::memory_order_relaxed);
+}
+
+// The array and nothrow forms forward to these two.
+void* operator new(std::size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
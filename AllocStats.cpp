@@ -0,0 +1,11 @@
+#include "include/AllocStats.h"
+
+// rogue_core's fallback, for programs that keep the standard operator new.
+// AllocCounter.cpp defines the counting one; being linked as an object it
+// wins over this archive member (weak, too, where the compiler has that).
+#if defined(__GNUC__)
+__attribute__((weak))
+#endif
+uint64_t heapAllocations() {
+	return 0;
+}
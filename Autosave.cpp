@@ -0,0 +1,70 @@
+#include "include/Autosave.h"
+#include "include/SaveGame.h"
+
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+Autosave::Autosave(std::string p) : path(std::move(p)) {
+	worker = std::thread(&Autosave::workerLoop, this);
+}
+
+Autosave::~Autosave() {
+	flush();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+void Autosave::workerLoop() {
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this]() { return stopping || hasPending; });
+			if (!hasPending) return;
+			writing.swap(pending);
+			hasPending = false;
+			busy = true;
+		}
+
+		// Disk I/O outside the lock: submit() never waits on it
+		auto start = std::chrono::steady_clock::now();
+		std::string error;
+		bool ok = writeSaveFile(path, writing, error);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (ok) { saves++; lastWriteMs = ms; }
+			else { failures++; lastError = error; }
+			busy = false;
+		}
+		idle.notify_all();
+	}
+}
+
+void Autosave::submit(std::vector<uint8_t>& bytes) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending.swap(bytes);
+		hasPending = true;
+	}
+	wake.notify_one();
+}
+
+void Autosave::flush() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this]() { return !hasPending && !busy; });
+}
+
+void Autosave::printReport(std::ostream& out) {
+	std::lock_guard<std::mutex> lock(mutex);
+	out << std::fixed << std::setprecision(2);
+	out << "[Save] " << saves << " autosaves written to " << path;
+	if (saves) out << " (last write " << lastWriteMs << " ms, off the main thread)";
+	out << "\n";
+	if (failures) out << "[Save] " << failures << " failed: " << lastError << "\n";
+}
@@ -0,0 +1,482 @@
+#include "include/BatchCombat.h"
+
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_HAVE_AVX2 1
+#include <immintrin.h>
+#define BATCH_AVX2 __attribute__((target("avx2")))
+#else
+#define BATCH_HAVE_AVX2 0
+#endif
+
+void BatchCombat::resize(int n) {
+	count = std::max(0, n);
+	size_t padded = (size_t)(count + LANES - 1) / LANES * LANES;
+	std::vector<std::vector<int32_t>*> fields = {
+		&playerHp, &playerMaxHp, &playerAttack, &playerDefense, &playerMana,
+		&enemyHp, &enemyAttack, &enemyDefense, &enemyDefending, &enemyDice,
+		&hasAbility, &abilityMinRoll, &abilityBonus,
+		&turns, &playerRolls, &playerHits, &playerCrits, &enemyHits,
+		&playerEffects, &enemyEffects
+	};
+	for (int j = 0; j < EXTRA_ABILITIES; j++)
+		fields.insert(fields.end(), { &extraCost[j], &extraMinRoll[j], &extraBonus[j], &extraDamage[j],
+		                              &extraKind[j], &extraTurns[j], &extraPower[j] });
+	for (int k = 0; k < EFFECT_KIND_COUNT - 1; k++) fields.insert(fields.end(), { &effectTurns[k], &effectPower[k] });
+	for (std::vector<int32_t>* f : fields) f->assign(padded, 0);
+	for (int w = 0; w < 4; w++) rng[w].assign(padded, 1);
+}
+
+void BatchCombat::set(int i, const CombatSnapshot& s, const Rng& r) {
+	playerHp[i] = s.playerHp;
+	playerMaxHp[i] = s.playerMaxHp;
+	playerAttack[i] = s.playerAttack;
+	playerDefense[i] = s.playerDefense;
+	playerMana[i] = s.playerMana;
+	enemyHp[i] = s.enemyHp;
+	enemyAttack[i] = s.enemyAttack;
+	enemyDefense[i] = s.enemyDefense;
+	enemyDefending[i] = s.enemyDefending;
+	enemyDice[i] = std::min<int>(std::max<int>(s.enemyDamageDice, 1), 2);
+	hasAbility[i] = s.hasAbility;
+	abilityMinRoll[i] = s.abilityMinRoll;
+	abilityBonus[i] = s.abilityBonus;
+	for (int w = 0; w < 4; w++) rng[w][i] = r.state()[w];
+}
+
+void BatchCombat::setAbilities(int i, const PlayerClassDef& def) {
+	for (int j = 0; j < EXTRA_ABILITIES; j++) {
+		SpecialAttributes a;
+		if (j + 1 < def.abilityCount) a = def.abilities[j + 1];
+		extraCost[j][i] = a.manaCost;
+		extraMinRoll[j][i] = a.minRolls;
+		extraBonus[j][i] = a.atkPowerBonus;
+		extraDamage[j][i] = a.dealsDamage;
+		extraKind[j][i] = (int)a.effect.kind;
+		extraTurns[j][i] = a.effect.turns;
+		extraPower[j][i] = a.effect.power;
+	}
+}
+
+BattleResult BatchCombat::result(int i) const {
+	BattleResult r;
+	r.playerWon = enemyHp[i] <= 0;
+	r.turns = turns[i];
+	r.playerHp = playerHp[i];
+	r.enemyHp = enemyHp[i];
+	r.playerRolls = playerRolls[i];
+	r.playerHits = playerHits[i];
+	r.playerCrits = playerCrits[i];
+	r.enemyHits = enemyHits[i];
+	return r;
+}
+
+bool BatchCombat::avx2Available() {
+#if BATCH_HAVE_AVX2
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+bool BatchCombat::run(SimPolicy policy, int maxTurns, BatchKernel kernel) {
+	if (policy == SimPolicy::Search) return false;
+	int padded = (int)playerHp.size();
+	std::vector<int32_t>* cleared[] = { &turns, &playerRolls, &playerHits, &playerCrits, &enemyHits,
+	                                    &playerEffects, &enemyEffects };
+	for (std::vector<int32_t>* f : cleared) std::fill(f->begin(), f->end(), 0);
+	for (int k = 0; k < EFFECT_KIND_COUNT - 1; k++) {
+		std::fill(effectTurns[k].begin(), effectTurns[k].end(), 0);
+		std::fill(effectPower[k].begin(), effectPower[k].end(), 0);
+	}
+	for (int i = count; i < padded; i++) playerHp[i] = 0;
+
+	if (kernel == BatchKernel::Auto) kernel = avx2Available() ? BatchKernel::AVX2 : BatchKernel::Scalar;
+	if (kernel == BatchKernel::AVX2 && avx2Available()) runAVX2(0, padded, policy, maxTurns);
+	else runScalar(0, padded, policy, maxTurns);
+	return true;
+}
+
+static bool holds(int mask, EffectKind k) {
+	return (mask >> (int)k) & 1;
+}
+
+// Counts one turn off effect kind k of the side with active mask `mask`.
+static void countDown(int& mask, int& turnsLeft, EffectKind k) {
+	if (holds(mask, k) && --turnsLeft == 0) mask &= ~(1 << (int)k);
+}
+
+// One battle at a time, line for line what simulateBattle does through
+// CombatSystem. The reference the AVX2 kernel is checked against.
+void BatchCombat::runScalar(int first, int last, SimPolicy policy, int maxTurns) {
+	bool abilityFirst = policy != SimPolicy::Attack;
+	bool effectsFirst = policy == SimPolicy::Effects;
+	const int SHIELD = (int)EffectKind::Shield - 1, GUARD = (int)EffectKind::Guard - 1;
+	const int POISON = (int)EffectKind::Poison - 1, STUN = (int)EffectKind::Stun - 1;
+
+	for (int i = first; i < last; i++) {
+		Rng g;
+		uint32_t st[4] = { rng[0][i], rng[1][i], rng[2][i], rng[3][i] };
+		g.setState(st);
+
+		int php = playerHp[i], mana = playerMana[i], ehp = enemyHp[i];
+		int t = 0, rolls = 0, hits = 0, crits = 0, ehits = 0;
+		int pfx = 0, efx = 0;
+		int fxTurns[EFFECT_KIND_COUNT - 1] = {}, fxPower[EFFECT_KIND_COUNT - 1] = {};
+
+		while (php > 0 && ehp > 0 && t < maxTurns) {
+			t++;
+			// Player: the ability simPolicyAbility picks (1 and up are Effects
+			// only), chosen before its effects tick as simulateBattle does
+			int use = -1;
+			for (int j = EXTRA_ABILITIES - 1; effectsFirst && j >= 0 && use < 0; j--) {
+				EffectKind kind = (EffectKind)extraKind[j][i];
+				if (kind == EffectKind::None || mana < extraCost[j][i]) continue;
+				bool self = effectOnSelf(kind);
+				if (self && php * 2 > playerMaxHp[i]) continue;
+				if (!holds(self ? pfx : efx, kind)) use = j + 1;
+			}
+			if (use < 0 && abilityFirst && hasAbility[i] && mana >= ABILITY_MANA_COST) use = 0;
+			// Neither Shield nor Guard costs the turn
+			countDown(pfx, fxTurns[SHIELD], EffectKind::Shield);
+			countDown(pfx, fxTurns[GUARD], EffectKind::Guard);
+
+			int roll = g.roll(20);
+			rolls++;
+			int dmg = -1;
+			if (use >= 0) {
+				int j = use - 1;
+				int minRoll = use ? extraMinRoll[j][i] : abilityMinRoll[i];
+				if (roll >= minRoll) {
+					if (!use || extraDamage[j][i])
+						dmg = g.roll(6) + g.roll(6) + playerAttack[i] + (use ? extraBonus[j][i] : abilityBonus[i]);
+					mana -= use ? extraCost[j][i] : ABILITY_MANA_COST;
+					hits++;
+					EffectKind kind = use ? (EffectKind)extraKind[j][i] : EffectKind::None;
+					if (kind != EffectKind::None) {
+						int& mask = effectOnSelf(kind) ? pfx : efx;
+						int k = (int)kind - 1;
+						if (holds(mask, kind)) {
+							fxTurns[k] = std::max(fxTurns[k], extraTurns[j][i]);
+							fxPower[k] = std::max(fxPower[k], extraPower[j][i]);
+						} else {
+							fxTurns[k] = extraTurns[j][i];
+							fxPower[k] = extraPower[j][i];
+							mask |= 1 << (int)kind;
+						}
+					}
+				}
+			} else if (roll + playerAttack[i] >= 10 + enemyDefense[i] || roll == 20) {
+				dmg = g.roll(6) + playerAttack[i];
+				if (roll == 20) { dmg += g.roll(6); crits++; }
+				hits++;
+			}
+			if (dmg >= 0) {
+				if (enemyDefending[i]) dmg /= 2;
+				ehp = std::max(0, ehp - dmg);
+			}
+			if (ehp <= 0) break;
+
+			// Enemy: poison may finish it and a stun costs it the turn
+			bool stunned = holds(efx, EffectKind::Stun);
+			if (holds(efx, EffectKind::Poison)) ehp = std::max(0, ehp - fxPower[POISON]);
+			countDown(efx, fxTurns[POISON], EffectKind::Poison);
+			countDown(efx, fxTurns[STUN], EffectKind::Stun);
+			if (stunned || ehp <= 0) continue;
+
+			roll = g.roll(20);
+			if (roll + enemyAttack[i] >= 10 + playerDefense[i] || roll == 20) {
+				dmg = enemyAttack[i];
+				for (int d = 0; d < enemyDice[i]; d++) dmg += g.roll(6);
+				if (roll == 20) dmg += g.roll(6);
+				if (holds(pfx, EffectKind::Guard)) dmg /= 2;
+				if (holds(pfx, EffectKind::Shield) && dmg > 0) {
+					int taken = std::min(dmg, fxPower[SHIELD]);
+					fxPower[SHIELD] -= taken;
+					dmg -= taken;
+					if (fxPower[SHIELD] <= 0) pfx &= ~(1 << (int)EffectKind::Shield);
+				}
+				php = std::max(0, php - dmg);
+				ehits++;
+			}
+		}
+
+		playerHp[i] = php; playerMana[i] = mana; enemyHp[i] = ehp;
+		turns[i] = t; playerRolls[i] = rolls; playerHits[i] = hits; playerCrits[i] = crits; enemyHits[i] = ehits;
+		playerEffects[i] = pfx; enemyEffects[i] = efx;
+		for (int k = 0; k < EFFECT_KIND_COUNT - 1; k++) { effectTurns[k][i] = fxTurns[k]; effectPower[k][i] = fxPower[k]; }
+		for (int w = 0; w < 4; w++) rng[w][i] = g.state()[w];
+	}
+}
+
+#if BATCH_HAVE_AVX2
+
+namespace {
+
+struct LaneRng {
+	__m256i s0, s1, s2, s3;
+};
+
+template <int K>
+BATCH_AVX2 inline __m256i rotl(__m256i x) {
+	return _mm256_or_si256(_mm256_slli_epi32(x, K), _mm256_srli_epi32(x, 32 - K));
+}
+
+// Rng::next on the lanes in `mask`; the other lanes keep their state.
+BATCH_AVX2 inline __m256i nextMasked(LaneRng& g, __m256i mask) {
+	__m256i result = _mm256_mullo_epi32(rotl<7>(_mm256_mullo_epi32(g.s1, _mm256_set1_epi32(5))), _mm256_set1_epi32(9));
+	__m256i t = _mm256_slli_epi32(g.s1, 9);
+	__m256i s2 = _mm256_xor_si256(g.s2, g.s0);
+	__m256i s3 = _mm256_xor_si256(g.s3, g.s1);
+	__m256i s1 = _mm256_xor_si256(g.s1, s2);
+	__m256i s0 = _mm256_xor_si256(g.s0, s3);
+	s2 = _mm256_xor_si256(s2, t);
+	s3 = rotl<11>(s3);
+	g.s0 = _mm256_blendv_epi8(g.s0, s0, mask);
+	g.s1 = _mm256_blendv_epi8(g.s1, s1, mask);
+	g.s2 = _mm256_blendv_epi8(g.s2, s2, mask);
+	g.s3 = _mm256_blendv_epi8(g.s3, s3, mask);
+	return result;
+}
+
+// Rng::roll(sides) on the lanes in `mask` (0 elsewhere). Lemire's
+// rejection fires for fewer than 1 in 10^8 draws; those lanes finish
+// their retries through a scalar Rng so the stream stays identical.
+BATCH_AVX2 inline __m256i rollMasked(LaneRng& g, __m256i mask, uint32_t sides) {
+	const __m256i n = _mm256_set1_epi32((int)sides);
+	const uint32_t threshold = (0u - sides) % sides;
+	__m256i r = nextMasked(g, mask);
+
+	__m256i lo = _mm256_mullo_epi32(r, n);
+	__m256i even = _mm256_srli_epi64(_mm256_mul_epu32(r, n), 32);
+	__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(r, 32), n);
+	__m256i hi = _mm256_blend_epi32(even, odd, 0xAA);
+
+	__m256i below = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(lo, _mm256_set1_epi32((int)threshold)), lo),
+	                                  _mm256_set1_epi32(-1));
+	__m256i reject = _mm256_and_si256(below, mask);
+	if (!_mm256_testz_si256(reject, reject)) {
+		alignas(32) uint32_t s[4][BatchCombat::LANES], out[BatchCombat::LANES], low[BatchCombat::LANES], bad[BatchCombat::LANES];
+		_mm256_store_si256((__m256i*)s[0], g.s0);
+		_mm256_store_si256((__m256i*)s[1], g.s1);
+		_mm256_store_si256((__m256i*)s[2], g.s2);
+		_mm256_store_si256((__m256i*)s[3], g.s3);
+		_mm256_store_si256((__m256i*)out, hi);
+		_mm256_store_si256((__m256i*)low, lo);
+		_mm256_store_si256((__m256i*)bad, reject);
+		for (int l = 0; l < BatchCombat::LANES; l++) {
+			if (!bad[l]) continue;
+			Rng one;
+			uint32_t st[4] = { s[0][l], s[1][l], s[2][l], s[3][l] };
+			one.setState(st);
+			uint64_t m = low[l];
+			while ((uint32_t)m < threshold) m = (uint64_t)one.next() * sides;
+			out[l] = (uint32_t)(m >> 32);
+			for (int w = 0; w < 4; w++) s[w][l] = one.state()[w];
+		}
+		g.s0 = _mm256_load_si256((const __m256i*)s[0]);
+		g.s1 = _mm256_load_si256((const __m256i*)s[1]);
+		g.s2 = _mm256_load_si256((const __m256i*)s[2]);
+		g.s3 = _mm256_load_si256((const __m256i*)s[3]);
+		hi = _mm256_load_si256((const __m256i*)out);
+	}
+	return _mm256_and_si256(_mm256_add_epi32(hi, _mm256_set1_epi32(1)), mask);
+}
+
+BATCH_AVX2 inline __m256i load(const std::vector<int32_t>& v, int i) {
+	return _mm256_loadu_si256((const __m256i*)(v.data() + i));
+}
+
+BATCH_AVX2 inline void store(std::vector<int32_t>& v, int i, __m256i x) {
+	_mm256_storeu_si256((__m256i*)(v.data() + i), x);
+}
+
+// Masks are all-ones lanes, so subtracting one counts it.
+BATCH_AVX2 inline __m256i tally(__m256i total, __m256i mask) {
+	return _mm256_sub_epi32(total, mask);
+}
+
+BATCH_AVX2 inline __m256i takeDamage(__m256i hp, __m256i dmg, __m256i defending, __m256i mask) {
+	dmg = _mm256_blendv_epi8(dmg, _mm256_srli_epi32(dmg, 1), defending);	// dmg >= 0, so >> 1 is / 2
+	__m256i left = _mm256_max_epi32(_mm256_sub_epi32(hp, dmg), _mm256_setzero_si256());
+	return _mm256_blendv_epi8(hp, left, mask);
+}
+
+// Lanes whose active mask holds effect kind k.
+BATCH_AVX2 inline __m256i holds(__m256i mask, EffectKind k) {
+	const __m256i bit = _mm256_set1_epi32(1 << (int)k);
+	return _mm256_cmpeq_epi32(_mm256_and_si256(mask, bit), bit);
+}
+
+// countDown on the lanes in `on`, which hold the effect.
+BATCH_AVX2 inline void countDown(__m256i& mask, __m256i& turnsLeft, EffectKind k, __m256i on) {
+	turnsLeft = _mm256_add_epi32(turnsLeft, on);
+	__m256i ended = _mm256_and_si256(on, _mm256_cmpeq_epi32(turnsLeft, _mm256_setzero_si256()));
+	mask = _mm256_andnot_si256(_mm256_and_si256(ended, _mm256_set1_epi32(1 << (int)k)), mask);
+}
+
+}
+
+// The scalar loop with every branch turned into a lane mask. A block of
+// 8 battles stays in registers until its last battle ends.
+BATCH_AVX2 void BatchCombat::runAVX2(int first, int last, SimPolicy policy, int maxTurns) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i d20 = _mm256_set1_epi32(20);
+	const __m256i ten = _mm256_set1_epi32(10);
+	const __m256i cost = _mm256_set1_epi32(ABILITY_MANA_COST);
+	const __m256i limit = _mm256_set1_epi32(maxTurns);
+	const __m256i abilityOn = _mm256_set1_epi32(policy != SimPolicy::Attack ? -1 : 0);
+	const __m256i lastTarget = _mm256_set1_epi32((int)EffectKind::Stun);	// kinds above it go on the user
+	const bool effectsFirst = policy == SimPolicy::Effects;
+	const int SHIELD = (int)EffectKind::Shield - 1, GUARD = (int)EffectKind::Guard - 1;
+	const int POISON = (int)EffectKind::Poison - 1, STUN = (int)EffectKind::Stun - 1;
+
+	for (int i = first; i < last; i += LANES) {
+		LaneRng g = { _mm256_loadu_si256((const __m256i*)(rng[0].data() + i)),
+		              _mm256_loadu_si256((const __m256i*)(rng[1].data() + i)),
+		              _mm256_loadu_si256((const __m256i*)(rng[2].data() + i)),
+		              _mm256_loadu_si256((const __m256i*)(rng[3].data() + i)) };
+		__m256i php = load(playerHp, i), mana = load(playerMana, i), ehp = load(enemyHp, i);
+		const __m256i pmaxhp = load(playerMaxHp, i);
+		const __m256i patk = load(playerAttack, i), pdefense = load(playerDefense, i);
+		const __m256i eatk = load(enemyAttack, i), edefense = load(enemyDefense, i);
+		const __m256i edefending = _mm256_cmpgt_epi32(load(enemyDefending, i), zero);
+		const __m256i twoDice = _mm256_cmpgt_epi32(load(enemyDice, i), one);
+		const __m256i canAbility = _mm256_and_si256(abilityOn, _mm256_cmpgt_epi32(load(hasAbility, i), zero));
+		const __m256i minRoll0 = load(abilityMinRoll, i), bonus0 = load(abilityBonus, i);
+		const __m256i playerTarget = _mm256_add_epi32(ten, edefense);
+		const __m256i enemyTarget = _mm256_add_epi32(ten, pdefense);
+		__m256i t = zero, rolls = zero, hits = zero, crits = zero, ehits = zero;
+		__m256i pfx = zero, efx = zero;
+		__m256i fxTurns[EFFECT_KIND_COUNT - 1], fxPower[EFFECT_KIND_COUNT - 1];
+		for (int k = 0; k < EFFECT_KIND_COUNT - 1; k++) fxTurns[k] = fxPower[k] = zero;
+
+		for (;;) {
+			__m256i live = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(php, zero), _mm256_cmpgt_epi32(ehp, zero)),
+			                                _mm256_cmpgt_epi32(limit, t));
+			if (_mm256_testz_si256(live, live)) break;
+			t = tally(t, live);
+
+			// Player: pick the ability (or none) per lane, before the tick.
+			// Every lane starts on ability 0's terms; Effects lanes whose
+			// pick comes first take over those of the extra ability.
+			__m256i picked = zero;
+			__m256i minRoll = minRoll0, bonus = bonus0, useCost = cost, deals = _mm256_set1_epi32(-1);
+			__m256i kind = zero, fxAddTurns = zero, fxAddPower = zero;
+			if (effectsFirst) {
+				// Self-buffs wait until hp * 2 <= max hp
+				__m256i hurt = _mm256_xor_si256(_mm256_cmpgt_epi32(_mm256_add_epi32(php, php), pmaxhp), _mm256_set1_epi32(-1));
+				for (int j = EXTRA_ABILITIES - 1; j >= 0; j--) {
+					__m256i k = load(extraKind[j], i), c = load(extraCost[j], i);
+					__m256i self = _mm256_cmpgt_epi32(k, lastTarget);
+					__m256i holder = _mm256_blendv_epi8(efx, pfx, self);
+					__m256i held = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_srlv_epi32(holder, k), one), one);
+					__m256i pick = _mm256_and_si256(live, _mm256_cmpgt_epi32(k, zero));
+					pick = _mm256_and_si256(pick, _mm256_cmpgt_epi32(mana, _mm256_sub_epi32(c, one)));
+					pick = _mm256_and_si256(pick, _mm256_or_si256(hurt, _mm256_xor_si256(self, _mm256_set1_epi32(-1))));
+					pick = _mm256_andnot_si256(_mm256_or_si256(held, picked), pick);
+					if (_mm256_testz_si256(pick, pick)) continue;
+					picked = _mm256_or_si256(picked, pick);
+					minRoll = _mm256_blendv_epi8(minRoll, load(extraMinRoll[j], i), pick);
+					bonus = _mm256_blendv_epi8(bonus, load(extraBonus[j], i), pick);
+					useCost = _mm256_blendv_epi8(useCost, c, pick);
+					deals = _mm256_blendv_epi8(deals, _mm256_cmpgt_epi32(load(extraDamage[j], i), zero), pick);
+					kind = _mm256_blendv_epi8(kind, k, pick);
+					fxAddTurns = _mm256_blendv_epi8(fxAddTurns, load(extraTurns[j], i), pick);
+					fxAddPower = _mm256_blendv_epi8(fxAddPower, load(extraPower[j], i), pick);
+				}
+			}
+			__m256i useFirst = _mm256_andnot_si256(picked, _mm256_and_si256(_mm256_and_si256(live, canAbility),
+			                                       _mm256_cmpgt_epi32(mana, _mm256_sub_epi32(cost, one))));
+			__m256i useAbility = _mm256_or_si256(picked, useFirst);
+
+			// Its Shield and Guard tick (neither costs the turn)
+			countDown(pfx, fxTurns[SHIELD], EffectKind::Shield, _mm256_and_si256(live, holds(pfx, EffectKind::Shield)));
+			countDown(pfx, fxTurns[GUARD], EffectKind::Guard, _mm256_and_si256(live, holds(pfx, EffectKind::Guard)));
+
+			__m256i roll = rollMasked(g, live, 20);
+			rolls = tally(rolls, live);
+			__m256i nat20 = _mm256_cmpeq_epi32(roll, d20);
+			__m256i attacking = _mm256_andnot_si256(useAbility, live);
+			__m256i connects = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_add_epi32(roll, patk), _mm256_sub_epi32(playerTarget, one)), nat20);
+			__m256i attackHit = _mm256_and_si256(attacking, connects);
+			__m256i crit = _mm256_and_si256(attacking, nat20);
+			__m256i abilityHit = _mm256_and_si256(useAbility, _mm256_cmpgt_epi32(roll, _mm256_sub_epi32(minRoll, one)));
+			__m256i abilityDamage = _mm256_and_si256(abilityHit, deals);
+			__m256i hit = _mm256_or_si256(attackHit, abilityDamage);
+
+			__m256i dmg = _mm256_add_epi32(rollMasked(g, hit, 6), patk);
+			dmg = _mm256_add_epi32(dmg, rollMasked(g, _mm256_or_si256(crit, abilityDamage), 6));
+			dmg = _mm256_add_epi32(dmg, _mm256_and_si256(bonus, abilityDamage));
+			mana = _mm256_sub_epi32(mana, _mm256_and_si256(useCost, abilityHit));
+			ehp = takeDamage(ehp, dmg, edefending, hit);
+			hits = tally(hits, _mm256_or_si256(attackHit, abilityHit));
+			crits = tally(crits, crit);
+
+			// The effect of a successful extra ability: refresh or start it
+			__m256i applied = _mm256_and_si256(abilityHit, picked);
+			if (!_mm256_testz_si256(applied, applied)) {
+				for (int k = 1; k < EFFECT_KIND_COUNT; k++) {
+					__m256i on = _mm256_and_si256(applied, _mm256_cmpeq_epi32(kind, _mm256_set1_epi32(k)));
+					if (_mm256_testz_si256(on, on)) continue;
+					__m256i& mask = effectOnSelf((EffectKind)k) ? pfx : efx;
+					__m256i had = holds(mask, (EffectKind)k);
+					fxTurns[k - 1] = _mm256_blendv_epi8(fxTurns[k - 1],
+					    _mm256_blendv_epi8(fxAddTurns, _mm256_max_epi32(fxTurns[k - 1], fxAddTurns), had), on);
+					fxPower[k - 1] = _mm256_blendv_epi8(fxPower[k - 1],
+					    _mm256_blendv_epi8(fxAddPower, _mm256_max_epi32(fxPower[k - 1], fxAddPower), had), on);
+					mask = _mm256_or_si256(mask, _mm256_and_si256(on, _mm256_set1_epi32(1 << k)));
+				}
+			}
+
+			// Enemy, where it survived: poison may finish it and a stun costs it the turn
+			__m256i enemyLive = _mm256_and_si256(live, _mm256_cmpgt_epi32(ehp, zero));
+			__m256i poisoned = _mm256_and_si256(enemyLive, holds(efx, EffectKind::Poison));
+			__m256i stunned = _mm256_and_si256(enemyLive, holds(efx, EffectKind::Stun));
+			ehp = _mm256_max_epi32(_mm256_sub_epi32(ehp, _mm256_and_si256(fxPower[POISON], poisoned)), zero);
+			countDown(efx, fxTurns[POISON], EffectKind::Poison, poisoned);
+			countDown(efx, fxTurns[STUN], EffectKind::Stun, stunned);
+			__m256i acting = _mm256_andnot_si256(stunned, _mm256_and_si256(enemyLive, _mm256_cmpgt_epi32(ehp, zero)));
+
+			roll = rollMasked(g, acting, 20);
+			nat20 = _mm256_cmpeq_epi32(roll, d20);
+			connects = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_add_epi32(roll, eatk), _mm256_sub_epi32(enemyTarget, one)), nat20);
+			hit = _mm256_and_si256(acting, connects);
+			crit = _mm256_and_si256(hit, nat20);
+
+			dmg = _mm256_add_epi32(rollMasked(g, hit, 6), eatk);
+			dmg = _mm256_add_epi32(dmg, rollMasked(g, _mm256_and_si256(hit, _mm256_or_si256(twoDice, crit)), 6));
+			dmg = _mm256_add_epi32(dmg, rollMasked(g, _mm256_and_si256(crit, twoDice), 6));
+			// Guard halves the hit, then the shield soaks up what it can
+			dmg = _mm256_blendv_epi8(dmg, _mm256_srli_epi32(dmg, 1), holds(pfx, EffectKind::Guard));
+			__m256i shielded = _mm256_and_si256(_mm256_and_si256(hit, holds(pfx, EffectKind::Shield)), _mm256_cmpgt_epi32(dmg, zero));
+			__m256i taken = _mm256_and_si256(_mm256_min_epi32(dmg, fxPower[SHIELD]), shielded);
+			fxPower[SHIELD] = _mm256_sub_epi32(fxPower[SHIELD], taken);
+			dmg = _mm256_sub_epi32(dmg, taken);
+			__m256i broken = _mm256_and_si256(shielded, _mm256_cmpgt_epi32(one, fxPower[SHIELD]));
+			pfx = _mm256_andnot_si256(_mm256_and_si256(broken, _mm256_set1_epi32(1 << (int)EffectKind::Shield)), pfx);
+			php = takeDamage(php, dmg, zero, hit);
+			ehits = tally(ehits, hit);
+		}
+
+		store(playerHp, i, php); store(playerMana, i, mana); store(enemyHp, i, ehp);
+		store(turns, i, t); store(playerRolls, i, rolls); store(playerHits, i, hits);
+		store(playerCrits, i, crits); store(enemyHits, i, ehits);
+		store(playerEffects, i, pfx); store(enemyEffects, i, efx);
+		for (int k = 0; k < EFFECT_KIND_COUNT - 1; k++) { store(effectTurns[k], i, fxTurns[k]); store(effectPower[k], i, fxPower[k]); }
+		_mm256_storeu_si256((__m256i*)(rng[0].data() + i), g.s0);
+		_mm256_storeu_si256((__m256i*)(rng[1].data() + i), g.s1);
+		_mm256_storeu_si256((__m256i*)(rng[2].data() + i), g.s2);
+		_mm256_storeu_si256((__m256i*)(rng[3].data() + i), g.s3);
+	}
+}
+
+#else
+
+void BatchCombat::runAVX2(int first, int last, SimPolicy policy, int maxTurns) {
+	runScalar(first, last, policy, maxTurns);
+}
+
+#endif
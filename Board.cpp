@@ -1,61 +1,90 @@
 #include "include/Board.h"
 
-Board::Board(int r, int c, float size) : rows(r), cols(c), tileSize(size) {
-	grid.resize(rows, std::vector<Tile*>(cols, nullptr));
-}
+#include <algorithm>
+#include <cstring>
 
-Board::~Board() {
-	for (int r=0; r<rows; r++) 
-		for (int c=0; c<cols; c++) 
-			delete grid[r][c];
+Board::Board(int r, int c) : rows(r), cols(c) {
+	chunkRows = (rows + CHUNK - 1) / CHUNK;
+	chunkCols = (cols + CHUNK - 1) / CHUNK;
+	chunks.assign(chunkRows * chunkCols, nullptr);
 }
 
-void Board::setTile(int r, int c, Tile* tile, sf::Texture& tex) {
-	if (r < 0 || r >= rows || c < 0 || c >= cols) return;
+void Board::load(int r, int c, const TileKind* tiles) {
+	rows = r; cols = c;
+	chunkRows = (rows + CHUNK - 1) / CHUNK;
+	chunkCols = (cols + CHUNK - 1) / CHUNK;
+	chunkArena.reset();
+	chunks.assign(chunkRows * chunkCols, nullptr);
+	generation++;
+
+	for (int cr = 0; cr < chunkRows; cr++) {
+		for (int cc = 0; cc < chunkCols; cc++) {
+			int w = chunkWidth(cc), h = chunkHeight(cr);
+			const TileKind* src = tiles + (cr * CHUNK) * cols + cc * CHUNK;
 
-    // Delete old tile if it exists
-    if (grid[r][c]) delete grid[r][c];
+			bool anyTile = false;
+			for (int lr = 0; lr < h && !anyTile; lr++)
+				for (int lc = 0; lc < w; lc++)
+					if (src[lr * cols + lc] != TileKind::Empty) { anyTile = true; break; }
+			if (!anyTile) continue;		// stays unallocated (all Empty)
 
-    // Assign the new tile
-    grid[r][c] = tile;
-    
-    // --- FIX: Use ->getSprite() instead of ->sprite ---
-    grid[r][c]->getSprite().setTexture(tex);
+			Chunk& ch = ensureChunk(cr * CHUNK, cc * CHUNK);
+			for (int lr = 0; lr < h; lr++)
+				std::memcpy(&ch.kinds[lr * CHUNK], src + lr * cols, w * sizeof(TileKind));
+		}
+	}
+}
 
-    // Calculate scaling for 800x900 resolution
-    sf::Vector2u texSize = tex.getSize();
-    float scaleX = this->tileSize / (float)texSize.x;
-    float scaleY = this->tileSize / (float)texSize.y;
-    
-    // --- FIX: Use ->getSprite() here too ---
-    grid[r][c]->getSprite().setScale(scaleX, scaleY);
+int Board::chunkWidth(int cc) const {
+	return std::min(CHUNK, cols - cc * CHUNK);
+}
 
-    // --- FIX: Use ->getSprite() for position ---
-    grid[r][c]->getSprite().setPosition(c * tileSize, r * tileSize);
+int Board::chunkHeight(int cr) const {
+	return std::min(CHUNK, rows - cr * CHUNK);
 }
 
-Tile* Board::getTile(int r, int c) {
-	if (r<0 || c<0 || r>=rows || c>=cols) return nullptr;
-	return grid[r][c];
+Board::Chunk& Board::ensureChunk(int r, int c) {
+	Chunk*& slot = chunks[(r / CHUNK) * chunkCols + c / CHUNK];
+	if (!slot) {
+		slot = chunkArena.acquire();
+		std::fill(slot->kinds, slot->kinds + CHUNK * CHUNK, TileKind::Empty);
+		std::fill(slot->flags, slot->flags + CHUNK * CHUNK, 0);
+		slot->revision = 1;
+		slot->lastChanged = -1;
+	}
+	return *slot;
 }
 
-void Board::draw(sf::RenderWindow& win) {
-	for (int r=0; r<rows; r++) 
-		for (int c=0; c<cols; c++) 
-			if (grid[r][c]) 
-				win.draw(grid[r][c]->getSprite());
+int Board::getAllocatedChunks() const {
+	int n = 0;
+	for (const auto& ch : chunks) if (ch) n++;
+	return n;
 }
 
-void Board::replaceWithEmpty(int r, int c, sf::Texture& texEmpty) {
-	delete grid[r][c];
-	grid[r][c] = new EmptyTile();
-	grid[r][c]->getSprite().setTexture(texEmpty);
+void Board::setTile(int r, int c, TileKind kind) {
+	if (!inBounds(r, c)) return;
+	if (kind == TileKind::Empty && !chunkAt(r, c)) return;	// already empty
+
+	Chunk& ch = ensureChunk(r, c);
+	int i = local(r, c);
+	ch.kinds[i] = kind;
+	ch.flags[i] = 0;
+	ch.revision++;
+	ch.lastChanged = i;
+}
 
-	sf::Vector2u texSize = texEmpty.getSize();
-    float scaleX = this->tileSize / (float)texSize.x;
-    float scaleY = this->tileSize / (float)texSize.y;
-    
-    // --- FIX: Use ->getSprite() here too ---
-    grid[r][c]->getSprite().setScale(scaleX, scaleY);
-	grid[r][c]->getSprite().setPosition(c * tileSize, r * tileSize);
-}
\ No newline at end of file
+bool Board::enter(int r, int c) {
+	if (!inBounds(r, c) || !isCombatKind(getTile(r, c))) return false;
+	Chunk& ch = ensureChunk(r, c);
+	ch.flags[local(r, c)] |= TILE_COMBAT_TRIGGERED;
+	return true;
+}
+
+void Board::resetCombatTrigger(int r, int c) {
+	Chunk* ch = chunkAt(r, c);
+	if (ch) ch->flags[local(r, c)] &= ~TILE_COMBAT_TRIGGERED;
+}
+
+void Board::replaceWithEmpty(int r, int c) {
+	setTile(r, c, TileKind::Empty);
+}
@@ -0,0 +1,113 @@
+#include "include/BoardRenderer.h"
+#include "include/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+BoardRenderer::BoardRenderer(float size) : tileSize(size) {}
+
+void BoardRenderer::setTexture(TileKind kind, const sf::Texture& tex) {
+	textures[(int)kind] = &tex;
+	atlasStale = true;
+}
+
+void BoardRenderer::buildAtlas() {
+	atlas.create(ATLAS_CELL * TILE_KIND_COUNT, ATLAS_CELL);
+	atlas.clear(sf::Color::Transparent);
+
+	// Scale each texture into its own cell once, instead of per tile per frame
+	for (int k = 0; k < TILE_KIND_COUNT; k++) {
+		if (!textures[k]) continue;
+		sf::Vector2u texSize = textures[k]->getSize();
+		if (texSize.x == 0 || texSize.y == 0) continue;
+
+		sf::Sprite s(*textures[k]);
+		s.setScale((float)ATLAS_CELL / texSize.x, (float)ATLAS_CELL / texSize.y);
+		s.setPosition((float)(k * ATLAS_CELL), 0.f);
+		atlas.draw(s);
+	}
+	atlas.display();
+	atlasStale = false;
+}
+
+void BoardRenderer::setQuadTexCoords(sf::Vertex* quad, TileKind kind) {
+	float u = (float)((int)kind * ATLAS_CELL);
+	float cell = (float)ATLAS_CELL;
+
+	quad[0].texCoords = sf::Vector2f(u, 0.f);
+	quad[1].texCoords = sf::Vector2f(u + cell, 0.f);
+	quad[2].texCoords = sf::Vector2f(u + cell, cell);
+	quad[3].texCoords = sf::Vector2f(u, cell);
+}
+
+void BoardRenderer::buildQuads(int w, int h, const TileKind* kinds, sf::VertexArray& out) {
+	out.setPrimitiveType(sf::Quads);
+	out.resize(w * h * 4);
+
+	for (int r=0; r<h; r++) {
+		for (int c=0; c<w; c++) {
+			sf::Vertex* quad = &out[(r * w + c) * 4];
+			float x = c * tileSize, y = r * tileSize;
+
+			quad[0].position = sf::Vector2f(x, y);
+			quad[1].position = sf::Vector2f(x + tileSize, y);
+			quad[2].position = sf::Vector2f(x + tileSize, y + tileSize);
+			quad[3].position = sf::Vector2f(x, y + tileSize);
+			setQuadTexCoords(quad, kinds ? kinds[r * Board::CHUNK + c] : TileKind::Empty);
+		}
+	}
+}
+
+void BoardRenderer::draw(const Board& board, sf::RenderTarget& target) {
+	PROFILE_SCOPE("BoardRenderer::draw");
+	if (atlasStale) buildAtlas();
+	lastDrawCalls = 0;
+
+	int chunkRows = board.getChunkRows(), chunkCols = board.getChunkCols();
+	if (&board != meshBoard || board.getGeneration() != meshGeneration || (int)meshes.size() != chunkRows * chunkCols) {
+		// New level: keep the vertex buffers, forget what they showed
+		meshes.resize(chunkRows * chunkCols);
+		for (ChunkMesh& m : meshes) m.revision = 0;
+		meshBoard = &board;
+		meshGeneration = board.getGeneration();
+	}
+
+	// Visible world rectangle -> inclusive chunk range
+	const sf::View& view = target.getView();
+	sf::Vector2f half(view.getSize().x / 2.f, view.getSize().y / 2.f);
+	float chunkPx = Board::CHUNK * tileSize;
+	int c0 = std::max(0, (int)std::floor((view.getCenter().x - half.x) / chunkPx));
+	int r0 = std::max(0, (int)std::floor((view.getCenter().y - half.y) / chunkPx));
+	int c1 = std::min(chunkCols - 1, (int)std::floor((view.getCenter().x + half.x) / chunkPx));
+	int r1 = std::min(chunkRows - 1, (int)std::floor((view.getCenter().y + half.y) / chunkPx));
+
+	for (int cr = r0; cr <= r1; cr++) {
+		for (int cc = c0; cc <= c1; cc++) {
+			int w = board.chunkWidth(cc), h = board.chunkHeight(cr);
+			sf::RenderStates states(&atlas.getTexture());
+			states.transform.translate(cc * chunkPx, cr * chunkPx);
+
+			const TileKind* kinds = board.chunkTiles(cr, cc);
+			if (kinds) {
+				ChunkMesh& mesh = meshes[cr * chunkCols + cc];
+				uint32_t revision = board.chunkRevision(cr, cc);
+				int changed = board.chunkLastChanged(cr, cc);
+				if (mesh.revision != 0 && revision == mesh.revision + 1 && changed >= 0) {
+					// Patch the one quad instead of rebuilding the chunk
+					int lr = changed / Board::CHUNK, lc = changed % Board::CHUNK;
+					setQuadTexCoords(&mesh.vertices[(lr * w + lc) * 4], kinds[changed]);
+					mesh.revision = revision;
+				} else if (revision != mesh.revision) {
+					buildQuads(w, h, kinds, mesh.vertices);
+					mesh.revision = revision;
+				}
+				target.draw(mesh.vertices, states);
+			} else {
+				sf::VertexArray& empty = emptyChunkVertices[(w << 8) | h];
+				if (empty.getVertexCount() == 0) buildQuads(w, h, nullptr, empty);
+				target.draw(empty, states);
+			}
+			lastDrawCalls++;
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#include "include/CachedText.h"
+#include "include/Profiler.h"
+
+void CachedText::setString(const std::string& s) {
+	if (valid && keyCount == 0 && s == shown) return;
+	shown = s;
+	keyCount = 0;
+	commit();
+}
+
+bool CachedText::changed(std::initializer_list<int64_t> values) {
+	int n = (int)values.size() < MAX_KEYS ? (int)values.size() : MAX_KEYS;
+	bool same = valid && n == keyCount;
+	int i = 0;
+	for (int64_t v : values) {
+		if (i == n) break;
+		if (same && key[i] != v) same = false;
+		key[i++] = v;
+	}
+	keyCount = n;
+	if (same) return false;
+	valid = false;
+	shown.clear();
+	return true;
+}
+
+void CachedText::commit() {
+	PROFILE_SCOPE("CachedText::commit");
+	text.setString(shown);
+	valid = true;
+	rebuilds++;
+}
+
+void CachedText::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+	target.draw(text, states);
+}
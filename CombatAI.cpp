@@ -0,0 +1,218 @@
+#include "include/CombatAI.h"
+#include "include/Profiler.h"
+
+#include <algorithm>
+
+static const double LOSS = 0.0;
+static const double DISCOUNT = 0.98;	// per round, so sooner wins beat later ones
+
+// A win is worth more with HP to spare, since HP carries over to the next fight.
+static double winValue(const CombatSnapshot& s) {
+	return 0.8 + 0.2 * s.playerHp / std::max<int>(1, s.playerMaxHp);
+}
+
+static uint64_t hashKey(uint64_t k) {
+	k ^= k >> 33; k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33; k *= 0xc4ceb9fe1a85ec53ULL;
+	return k ^ (k >> 33);
+}
+
+// Mask, turns and power of every active effect of one side.
+static uint64_t effectsKey(const StatusEffects& fx) {
+	uint64_t k = fx.activeMask();
+	for (int kind = 1; kind < EFFECT_KIND_COUNT; kind++) {
+		if (!fx.has((EffectKind)kind)) continue;
+		const StatusEffect& e = fx.get((EffectKind)kind);
+		k = hashKey(k ^ ((uint64_t)e.turns << 16 | (uint16_t)e.power));
+	}
+	return k;
+}
+
+// Exact for states without effects; effects are folded in by hash.
+template <bool Effects>
+static uint64_t stateKey(const CombatSnapshot& s) {
+	uint64_t k = (uint64_t)(uint16_t)s.playerHp | (uint64_t)(uint16_t)s.enemyHp << 16
+	             | (uint64_t)(uint16_t)s.playerMana << 32 | (uint64_t)s.playerDefending << 48
+	             | (uint64_t)s.enemyDefending << 49;
+	if (Effects && (s.playerEffects.any() || s.enemyEffects.any()))
+		k ^= hashKey(effectsKey(s.playerEffects) * 31 + effectsKey(s.enemyEffects));
+	return k;
+}
+
+// Entity::takeDamage: halved while defending or guarded, then soaked up by any shield.
+template <bool Effects>
+static void hit(int16_t& hp, uint8_t defending, StatusEffects& fx, int dmg) {
+	if (defending || (Effects && fx.has(EffectKind::Guard))) dmg = dmg / 2;
+	if (Effects) dmg -= fx.absorb(dmg);
+	hp = (int16_t)std::max(0, hp - dmg);
+}
+
+// CombatSystem::beginTurn: ticks the side's effects and takes the poison.
+// Returns false if the turn is lost.
+static bool beginTurn(int16_t& hp, StatusEffects& fx) {
+	EffectTick t = fx.tick();
+	hp = (int16_t)std::max(0, hp - t.poison);
+	return !t.stunned && hp > 0;
+}
+
+CombatAI::CombatAI(const CombatAIConfig& cfg) : config(cfg) {
+	table.resize((size_t)1 << config.tableBits);
+	mask = table.size() - 1;
+}
+
+void CombatAI::clearTable() {
+	std::fill(table.begin(), table.end(), Entry());
+}
+
+void CombatAI::prepare(const CombatSnapshot& s) {
+	// Only the stats matter; hp, mana and defending vary within a battle
+	CombatStatsKey stats = combatStatsKey(s);
+	if (haveRules && stats == rules) return;
+	if (haveRules) clearTable();
+	rules = stats;
+	haveRules = true;
+
+	odds.build(s);
+}
+
+// Damage race: compares the rounds each side needs to finish the other.
+double CombatAI::evaluate(const CombatSnapshot& s) const {
+	double toKill = s.enemyHp / std::max(odds.playerMeanDmg, 0.01f);
+	double toDie = s.playerHp / std::max(odds.enemyMeanDmg, 0.01f);
+	return toDie / (toDie + toKill) * winValue(s);
+}
+
+template <bool Effects>
+double CombatAI::enemyTurn(const CombatSnapshot& s, int depth) {
+	if (Effects && s.enemyEffects.any()) {
+		CombatSnapshot t = s;
+		if (!beginTurn(t.enemyHp, t.enemyEffects)) {
+			if (t.enemyHp <= 0) return winValue(t);
+			t.playerDefending = 0;
+			return DISCOUNT * playerTurn<Effects>(t, depth - 1, nullptr);
+		}
+		return enemyAttack<Effects>(t, depth);
+	}
+	return enemyAttack<Effects>(s, depth);
+}
+
+template <bool Effects>
+double CombatAI::enemyAttack(const CombatSnapshot& s, int depth) {
+	double v = 0;
+	for (const CombatOdds::Outcome& o : odds.enemy) {
+		CombatSnapshot n = s;
+		hit<Effects>(n.playerHp, n.playerDefending, n.playerEffects, o.dmg);
+		n.playerDefending = 0;
+		v += o.p * (n.playerHp <= 0 ? LOSS : DISCOUNT * playerTurn<Effects>(n, depth - 1, nullptr));
+	}
+	return v;
+}
+
+template <bool Effects>
+double CombatAI::actionValue(const CombatSnapshot& s, CombatAction a, int depth) {
+	double v = 0;
+	switch (a) {
+		case CombatAction::Attack:
+			for (const CombatOdds::Outcome& o : odds.attack) {
+				CombatSnapshot n = s;
+				hit<Effects>(n.enemyHp, n.enemyDefending, n.enemyEffects, o.dmg);
+				v += o.p * (n.enemyHp <= 0 ? winValue(n) : enemyTurn<Effects>(n, depth));
+			}
+			break;
+		case CombatAction::Ability:
+			v = odds.abilityFail > 0 ? odds.abilityFail * enemyTurn<Effects>(s, depth) : 0;
+			for (const CombatOdds::Outcome& o : odds.ability) {
+				CombatSnapshot n = s;
+				n.playerMana -= ABILITY_MANA_COST;
+				hit<Effects>(n.enemyHp, n.enemyDefending, n.enemyEffects, o.dmg);
+				v += o.p * (n.enemyHp <= 0 ? winValue(n) : enemyTurn<Effects>(n, depth));
+			}
+			break;
+		case CombatAction::Defend: {
+			CombatSnapshot n = s;
+			n.playerDefending = 1;
+			v = enemyTurn<Effects>(n, depth);
+			break;
+		}
+		case CombatAction::Run:
+			v = odds.fleeChance * config.fleeValue + (1 - odds.fleeChance) * enemyTurn<Effects>(s, depth);
+			break;
+	}
+	return v;
+}
+
+template <bool Effects>
+double CombatAI::bestAction(const CombatSnapshot& s, int depth, CombatAction& best) {
+	double bestValue = -1;
+	best = CombatAction::Attack;
+	for (int i = 0; i < COMBAT_ACTION_COUNT; i++) {
+		CombatAction a = (CombatAction)i;
+		// A failed mana check still costs the turn, so it is never worth trying
+		if (a == CombatAction::Ability && (!s.hasAbility || s.playerMana < ABILITY_MANA_COST)) continue;
+		double v = actionValue<Effects>(s, a, depth);
+		if (aborted) return 0;
+		if (v > bestValue + 1e-9) { bestValue = v; best = a; }
+	}
+	return bestValue;
+}
+
+template <bool Effects>
+double CombatAI::playerTurn(const CombatSnapshot& s, int depth, CombatAction* best) {
+	if ((++nodes & 1023) == 0 && config.budgetMs > 0 && std::chrono::steady_clock::now() >= deadline)
+		aborted = true;
+	if (aborted) return 0;
+	if (depth == 0) return evaluate(s);
+
+	uint64_t key = stateKey<Effects>(s);
+	Entry& e = table[hashKey(key) & mask];
+	if (!best && e.key == key + 1 && e.depth >= depth) return e.value;
+
+	double bestValue;
+	CombatAction bestMove;
+	if (Effects && s.playerEffects.any()) {
+		// Every action starts with the tick, so a lost turn is the same whatever was chosen
+		CombatSnapshot t = s;
+		if (beginTurn(t.playerHp, t.playerEffects)) {
+			bestValue = bestAction<Effects>(t, depth, bestMove);
+		} else {
+			bestMove = CombatAction::Attack;
+			bestValue = t.playerHp <= 0 ? LOSS : enemyTurn<Effects>(t, depth);
+		}
+	} else {
+		bestValue = bestAction<Effects>(s, depth, bestMove);
+	}
+	if (aborted) return 0;
+
+	e.key = key + 1;
+	e.value = (float)bestValue;
+	e.depth = (int16_t)depth;
+	e.action = (uint8_t)bestMove;
+	if (best) *best = bestMove;
+	return bestValue;
+}
+
+CombatDecision CombatAI::decide(const CombatSnapshot& s) {
+	PROFILE_SCOPE("CombatAI::decide");
+	auto start = std::chrono::steady_clock::now();
+	deadline = start + std::chrono::microseconds((long long)(config.budgetMs * 1000));
+	prepare(s);
+	nodes = 0;
+	bool effects = s.playerEffects.any() || s.enemyEffects.any();
+
+	CombatDecision d;
+	for (int depth = 1; depth <= config.maxDepth; depth++) {
+		aborted = false;
+		CombatAction a;
+		// The search never adds effects, so without any at the root the copy
+		// with their handling compiled out does.
+		double v = effects ? playerTurn<true>(s, depth, &a) : playerTurn<false>(s, depth, &a);
+		if (aborted) break;
+		d.action = a;
+		d.value = v;
+		d.depth = depth;
+		if (config.budgetMs > 0 && std::chrono::steady_clock::now() >= deadline) break;
+	}
+	d.nodes = nodes;
+	d.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return d;
+}
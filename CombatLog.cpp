@@ -0,0 +1,128 @@
+#include "include/CombatLog.h"
+#include "include/Player.h"
+
+#include <algorithm>
+
+static const std::string& actorName(const CombatEvent& e, const Player& player, const Entity& enemy) {
+	return e.actor == SIDE_PLAYER ? player.name : enemy.name;
+}
+
+static const std::string& targetName(const CombatEvent& e, const Player& player, const Entity& enemy) {
+	return e.actor == SIDE_PLAYER ? enemy.name : player.name;
+}
+
+static std::string abilityName(const CombatEvent& e, const Player& player) {
+	if (e.aux < player.abilityCount()) return player.ability(e.aux).name;
+	return "Ability";
+}
+
+void formatCombatEvent(std::string& out, const CombatEvent& e, const Player& player, const Entity& enemy) {
+	using std::to_string;
+	bool byPlayer = e.actor == SIDE_PLAYER;
+
+	switch (e.type) {
+		case CombatEventType::BattleStart:
+			out += "--- Battle start ---\n" + player.name + " vs " + enemy.name;
+			break;
+		case CombatEventType::Roll:
+			if ((RollKind)e.aux == RollKind::Ability)
+				out += "[Dice] Ability d20 = " + to_string(e.a) + " (Required: >=" + to_string(e.b) + ")\n";
+			else if ((RollKind)e.aux == RollKind::Run)
+				out += "[Dice] Run d20 = " + to_string(e.a) + "\n";
+			else
+				out += std::string("[Dice] ") + (byPlayer ? "Player" : "Enemy") + " d20 = " + to_string(e.a)
+				       + " (" + actorName(e, player, enemy) + " ATK: " + to_string(e.b) + ")\n";
+			break;
+		case CombatEventType::Crit:
+			out += byPlayer ? "CRITICAL! extra d6\n" : "Enemy CRITICAL!\n";
+			break;
+		case CombatEventType::Hit:
+			if (byPlayer) out += player.name + " hits " + enemy.name + " for " + to_string(e.a) + " damage.\n";
+			else out += enemy.name + " deals " + to_string(e.a) + " damage. \n";
+			break;
+		case CombatEventType::Miss:
+			if (byPlayer) out += player.name + "'s attack missed (Target: " + to_string(e.a) + ").\n";
+			else out += enemy.name + " missed (Target: " + to_string(e.a) + ").\n";
+			break;
+		case CombatEventType::Defended:
+			out += actorName(e, player, enemy) + " defended; damage halved to " + to_string(e.a) + "\n";
+			break;
+		case CombatEventType::NoMana:
+			out += "Not enough Mana (" + to_string(e.a) + ")! Cost is " + to_string(e.b) + ".\n";
+			break;
+		case CombatEventType::AbilityHit:
+			if (e.aux < player.abilityCount() && !player.ability(e.aux).dealsDamage)
+				out += abilityName(e, player) + " success! Mana left: " + to_string(e.b) + "\n";
+			else
+				out += abilityName(e, player) + " success! You deal " + to_string(e.a) + " damage. Mana left: " + to_string(e.b) + "\n";
+			break;
+		case CombatEventType::AbilityFail:
+			out += abilityName(e, player) + " failed (roll too low).\n";
+			break;
+		case CombatEventType::Defend:
+			out += actorName(e, player, enemy) + " braces for the next attack (defend).\n";
+			break;
+		case CombatEventType::Fled:
+			out += "You fled the battle!\n";
+			break;
+		case CombatEventType::RunFailed:
+			out += "Run failed!\n";
+			break;
+		case CombatEventType::EnemyTurn:
+			out += "\n--- [Enemy Turn] " + enemy.name + " attacks ---\n";
+			break;
+		case CombatEventType::Victory:
+			out += "\n" + targetName(e, player, enemy) + " defeated! +" + to_string(e.a) + " HP.";
+			break;
+		case CombatEventType::BossDefeated:
+			out += "\n>>> BOSS DEFEATED! Exit UNLOCKED! <<<";
+			break;
+		case CombatEventType::PlayerDied:
+			out += "\n" + player.name + " died.";
+			break;
+		case CombatEventType::EffectApplied:
+			switch ((EffectKind)e.aux) {
+				case EffectKind::Poison:
+					out += actorName(e, player, enemy) + " is poisoned: " + to_string(e.b) + " damage a turn for " + to_string(e.a) + " turns.\n";
+					break;
+				case EffectKind::Stun:
+					out += actorName(e, player, enemy) + " is stunned for " + to_string(e.a) + " turn(s).\n";
+					break;
+				case EffectKind::Shield:
+					out += actorName(e, player, enemy) + " is shielded: absorbs " + to_string(e.b) + " damage for " + to_string(e.a) + " turns.\n";
+					break;
+				default:
+					out += actorName(e, player, enemy) + " stands guard: damage halved for " + to_string(e.a) + " turns.\n";
+					break;
+			}
+			break;
+		case CombatEventType::EffectDamage:
+			out += actorName(e, player, enemy) + " takes " + to_string(e.a) + " " + effectName((EffectKind)e.aux) + " damage (HP " + to_string(e.b) + ").\n";
+			break;
+		case CombatEventType::Stunned:
+			out += actorName(e, player, enemy) + " is stunned and loses the turn.\n";
+			break;
+		case CombatEventType::Absorbed:
+			out += actorName(e, player, enemy) + "'s shield absorbs " + to_string(e.a) + " damage.\n";
+			break;
+		case CombatEventType::EffectEnded:
+			out += actorName(e, player, enemy) + "'s " + effectName((EffectKind)e.aux) + (e.a ? " breaks.\n" : " wears off.\n");
+			break;
+		case CombatEventType::Initiative:
+			out += "#" + to_string(e.b) + (byPlayer ? " (party)" : " (foe)") + " rolls initiative " + to_string(e.a) + "\n";
+			break;
+		case CombatEventType::PartyTurn:
+			out += "\n--- #" + to_string(e.a) + " acts against #" + to_string(e.b) + " ---\n";
+			break;
+		case CombatEventType::Downed:
+			out += "#" + to_string(e.a) + (byPlayer ? " (party)" : " (foe)") + " is down.\n";
+			break;
+	}
+}
+
+std::string formatCombatLog(const CombatLog& log, uint64_t from, const Player& player, const Entity& enemy) {
+	std::string out;
+	for (uint64_t seq = std::max(from, log.begin()); seq < log.end(); seq++)
+		formatCombatEvent(out, log.at(seq), player, enemy);
+	return out;
+}
@@ -0,0 +1,105 @@
+#include "include/CombatOdds.h"
+
+#include <algorithm>
+
+const char* combatActionName(CombatAction a) {
+	switch (a) {
+		case CombatAction::Attack:  return "Attack";
+		case CombatAction::Defend:  return "Defend";
+		case CombatAction::Ability: return "Ability";
+		case CombatAction::Run:     return "Run";
+	}
+	return "?";
+}
+
+CombatSnapshot makeCombatSnapshot(const Player& player, const Enemy& enemy) {
+	CombatSnapshot s = {};
+	s.playerHp = (int16_t)player.hp;
+	s.playerMaxHp = (int16_t)player.maxHp;
+	s.playerAttack = (int16_t)player.attack;
+	s.playerDefense = (int16_t)player.defense;
+	s.playerMana = (int16_t)player.mana;
+	s.playerDefending = player.defending;
+	s.enemyHp = (int16_t)enemy.hp;
+	s.enemyMaxHp = (int16_t)enemy.maxHp;
+	s.enemyAttack = (int16_t)enemy.attack;
+	s.enemyDefense = (int16_t)enemy.defense;
+	s.enemyDefending = enemy.defending;
+	s.playerEffects = player.effects;
+	s.enemyEffects = enemy.effects;
+	s.enemyDamageDice = dynamic_cast<const Boss*>(&enemy) ? 2 : 1;
+	if (player.abilityCount() > 0) {
+		s.hasAbility = 1;
+		s.abilityMinRoll = (int8_t)std::max(-100, std::min(100, player.ability(0).minRolls));
+		s.abilityBonus = (int16_t)player.ability(0).atkPowerBonus;
+	}
+	return s;
+}
+
+// Number of ways `dice` d6 sum to each total (index = total).
+static std::vector<int> diceSums(int dice) {
+	std::vector<int> ways(1, 1);
+	for (int d = 0; d < dice; d++) {
+		std::vector<int> next(ways.size() + 6, 0);
+		for (size_t t = 0; t < ways.size(); t++)
+			for (int face = 1; face <= 6; face++) next[t + face] += ways[t];
+		ways.swap(next);
+	}
+	return ways;
+}
+
+// Adds `weight` x (dice d6 + bonus) to the outcome list, merging equal damage.
+static void addDice(std::vector<CombatOdds::Outcome>& out, double weight, int dice, int bonus) {
+	std::vector<int> ways = diceSums(dice);
+	double total = 1;
+	for (int d = 0; d < dice; d++) total *= 6;
+	for (size_t t = 0; t < ways.size(); t++) {
+		if (!ways[t]) continue;
+		int dmg = (int)t + bonus;
+		float p = (float)(weight * ways[t] / total);
+		auto it = std::find_if(out.begin(), out.end(), [&](const CombatOdds::Outcome& o) { return o.dmg == dmg; });
+		if (it != out.end()) it->p += p;
+		else out.push_back({ (int16_t)dmg, p });
+	}
+}
+
+// d20 attack as in CombatSystem::attack / enemyTurn: hits on roll + attack
+// >= 10 + defense or a natural 20, which adds one more d6.
+static void attackOutcomes(std::vector<CombatOdds::Outcome>& out, int attack, int defense, int dice) {
+	out.clear();
+	int hits = 0;
+	for (int roll = 1; roll <= 19; roll++)
+		if (roll + attack >= 10 + defense) hits++;
+	if (hits < 19) out.push_back({ 0, (19 - hits) / 20.f });
+	if (hits) addDice(out, hits / 20.0, dice, attack);
+	addDice(out, 1 / 20.0, dice + 1, attack);
+}
+
+static double meanDamage(const std::vector<CombatOdds::Outcome>& dist) {
+	double m = 0;
+	for (const auto& o : dist) m += o.p * o.dmg;
+	return m;
+}
+
+CombatStatsKey combatStatsKey(const CombatSnapshot& s) {
+	CombatStatsKey k = { s.playerMaxHp, s.playerAttack, s.playerDefense,
+	                     s.enemyMaxHp, s.enemyAttack, s.enemyDefense,
+	                     s.abilityBonus, s.abilityMinRoll, s.hasAbility, s.enemyDamageDice };
+	return k;
+}
+
+void CombatOdds::build(const CombatSnapshot& s) {
+	attackOutcomes(attack, s.playerAttack, s.enemyDefense, 1);
+	attackOutcomes(enemy, s.enemyAttack, s.playerDefense, s.enemyDamageDice);
+
+	int successes = 0;
+	for (int roll = 1; roll <= 20; roll++)
+		if (roll >= s.abilityMinRoll) successes++;
+	ability.clear();
+	if (s.hasAbility && successes) addDice(ability, successes / 20.0, 2, s.playerAttack + s.abilityBonus);
+	abilityFail = s.hasAbility ? (20 - successes) / 20.f : 1.f;
+	fleeChance = (21 - RUN_ROLL) / 20.f;
+
+	playerMeanDmg = (float)meanDamage(attack);
+	enemyMeanDmg = (float)meanDamage(enemy);
+}
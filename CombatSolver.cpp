@@ -0,0 +1,165 @@
+#include "include/CombatSolver.h"
+
+#include <algorithm>
+
+namespace {
+
+// Probability mass of one action from one state, split by where it lands.
+// Losses are whatever is left: every battle ends with probability 1.
+struct Sums {
+	double win = 0, flee = 0;
+	double turns = 0;	// sum of p * expected turns of the non-terminal successors
+	double stay = 0;	// back to the same state
+};
+
+}
+
+CombatSolver::CombatSolver(double fleeValue) : fleeValue(fleeValue) {}
+
+void CombatSolver::solveTable(Table& t, const CombatSnapshot& s, SolverPolicy policy) {
+	CombatOdds odds;
+	odds.build(s);
+
+	t.maxPlayerHp = std::max<int>(1, s.playerMaxHp);
+	t.maxEnemyHp = std::max<int>(1, s.enemyMaxHp);
+	t.startMana = std::max<int>(0, s.playerMana);
+	t.abilityUses = s.hasAbility ? t.startMana / ABILITY_MANA_COST : 0;
+	t.states.assign((size_t)(t.abilityUses + 1) * t.maxEnemyHp * t.maxPlayerHp, State());
+
+	// after[def][i]: the enemy's attack on state i (player to move next),
+	// i.e. the value of ending the player's action there. Filled one row
+	// (enemyHp, uses) at a time once the row's states are solved, and read
+	// by every state above that row; only an action that leaves the enemy
+	// untouched lands in its own row and walks the enemy's odds directly.
+	std::vector<Sums> after[2];
+	after[0].assign(t.states.size(), Sums());
+	after[1].assign(t.states.size(), Sums());
+
+	// The enemy's attack on the state being solved, by defending flag.
+	// Shared by every action that leaves the enemy untouched.
+	Sums here[2];
+	auto enemyTurnHere = [&](Sums& out, int playerHp, int enemyHp, int uses, bool defending) {
+		out = Sums();
+		for (const CombatOdds::Outcome& o : odds.enemy) {
+			int hp = playerHp - (defending ? o.dmg / 2 : o.dmg);	// Entity::takeDamage
+			if (hp <= 0) continue;
+			if (hp == playerHp) { out.stay += o.p; continue; }
+			const State& n = t.states[t.index(hp, enemyHp, uses)];
+			out.win += o.p * n.win;
+			out.flee += o.p * n.flee;
+			out.turns += o.p * n.turns;
+		}
+	};
+
+	auto enemyTurn = [&](Sums& out, double p, int playerHp, int enemyHp, int uses, bool defending, bool sameRow) {
+		const Sums& a = sameRow ? here[defending] : after[defending][t.index(playerHp, enemyHp, uses)];
+		out.win += p * a.win;
+		out.flee += p * a.flee;
+		out.turns += p * a.turns;
+		out.stay += p * a.stay;
+	};
+
+	auto actionSums = [&](CombatAction a, int playerHp, int enemyHp, int uses) {
+		Sums sum;
+		switch (a) {
+			case CombatAction::Attack:
+				for (const CombatOdds::Outcome& o : odds.attack) {
+					int hp = enemyHp - o.dmg;
+					if (hp <= 0) sum.win += o.p;
+					else enemyTurn(sum, o.p, playerHp, hp, uses, false, hp == enemyHp);
+				}
+				break;
+			case CombatAction::Ability:
+				if (odds.abilityFail > 0)
+					enemyTurn(sum, odds.abilityFail, playerHp, enemyHp, uses, false, true);
+				for (const CombatOdds::Outcome& o : odds.ability) {
+					int hp = enemyHp - o.dmg;
+					if (hp <= 0) sum.win += o.p;
+					else enemyTurn(sum, o.p, playerHp, hp, uses + 1, false, false);
+				}
+				break;
+			case CombatAction::Defend:
+				enemyTurn(sum, 1.0, playerHp, enemyHp, uses, true, true);
+				break;
+			case CombatAction::Run:
+				sum.flee += odds.fleeChance;
+				enemyTurn(sum, 1 - odds.fleeChance, playerHp, enemyHp, uses, false, true);
+				break;
+		}
+		return sum;
+	};
+
+	// Spending mana, losing HP and hurting the enemy only ever move to
+	// states with more uses or less HP, so solve those first.
+	for (int uses = t.abilityUses; uses >= 0; uses--) {
+		bool canAbility = uses < t.abilityUses;
+		for (int enemyHp = 1; enemyHp <= t.maxEnemyHp; enemyHp++) {
+			for (int playerHp = 1; playerHp <= t.maxPlayerHp; playerHp++) {
+				enemyTurnHere(here[0], playerHp, enemyHp, uses, false);
+				if (policy == SolverPolicy::Best) enemyTurnHere(here[1], playerHp, enemyHp, uses, true);
+
+				State best = {};
+				double bestScore = -1;
+				for (int i = 0; i < COMBAT_ACTION_COUNT; i++) {
+					CombatAction a = (CombatAction)i;
+					if (a == CombatAction::Ability && !canAbility) continue;
+					if (policy == SolverPolicy::Attack && a != CombatAction::Attack) continue;
+					if (policy == SolverPolicy::Ability && a != (canAbility ? CombatAction::Ability : CombatAction::Attack)) continue;
+
+					Sums sum = actionSums(a, playerHp, enemyHp, uses);
+					if (sum.stay >= 1 - 1e-12) continue;	// nothing can ever change
+					double keep = 1 / (1 - sum.stay);
+					State st;
+					st.win = (float)(sum.win * keep);
+					st.flee = (float)(sum.flee * keep);
+					st.turns = (float)((1 + sum.turns) * keep);
+					st.action = a;
+					// Equal odds (to float precision): prefer the shorter fight
+					double score = st.win + fleeValue * st.flee;
+					if (score > bestScore + 1e-6 || (score > bestScore - 1e-6 && st.turns < best.turns)) {
+						bestScore = std::max(bestScore, score);
+						best = st;
+					}
+				}
+				t.states[t.index(playerHp, enemyHp, uses)] = best;
+			}
+
+			for (int def = 0; def < (policy == SolverPolicy::Best ? 2 : 1); def++) {
+				for (int playerHp = 1; playerHp <= t.maxPlayerHp; playerHp++) {
+					Sums a;
+					for (const CombatOdds::Outcome& o : odds.enemy) {
+						int hp = playerHp - (def ? o.dmg / 2 : o.dmg);
+						if (hp <= 0) continue;
+						const State& n = t.states[t.index(hp, enemyHp, uses)];
+						a.win += o.p * n.win;
+						a.flee += o.p * n.flee;
+						a.turns += o.p * n.turns;
+					}
+					after[def][t.index(playerHp, enemyHp, uses)] = a;
+				}
+			}
+		}
+	}
+	statesSolved += (long long)t.states.size();
+}
+
+CombatOutcome CombatSolver::solve(const CombatSnapshot& s, SolverPolicy policy) {
+	CombatOutcome out;
+	if (s.enemyHp <= 0) { out.win = 1; return out; }
+	if (s.playerHp <= 0) { out.loss = 1; return out; }
+
+	TableKey key(combatStatsKey(s), s.playerMana, (int)policy);
+	auto it = tables.find(key);
+	if (it == tables.end()) {
+		it = tables.emplace(key, Table()).first;
+		solveTable(it->second, s, policy);
+	}
+	const Table& t = it->second;
+	const State& st = t.states[t.index(std::min<int>(s.playerHp, t.maxPlayerHp), std::min<int>(s.enemyHp, t.maxEnemyHp), 0)];
+	out.win = st.win;
+	out.flee = st.flee;
+	out.loss = std::max(0.0, 1.0 - out.win - out.flee);
+	out.expectedTurns = st.turns;
+	out.firstAction = st.action;
+	return out;
+}
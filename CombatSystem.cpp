@@ -1,13 +1,50 @@
 #include "include/CombatSystem.h"
 
-CombatSystem::CombatSystem(Player* p, Enemy* e, std::ostream& l) 
+#include <algorithm>
+
+CombatLog& scratchLog() {
+	static thread_local CombatLog log;
+	return log;
+}
+
+CombatSystem::CombatSystem(Player* p, Enemy* e, CombatLog& l) 
 	: player(p), enemy(e), log(l) {}
 
+CombatSystem::CombatSystem(Player* p, Enemy* e) 
+	: player(p), enemy(e), log(scratchLog()) {}
+
+void CombatSystem::applyDamage(Entity* target, uint8_t targetSide, int dmg) {
+	bool halved = target->defending || target->effects.has(EffectKind::Guard);
+	int reduced = halved ? dmg / 2 : dmg;
+	int taken = target->takeDamage(dmg);
+	if (halved) log.push(CombatEventType::Defended, targetSide, reduced);
+	if (taken < reduced) {
+		bool holds = target->effects.has(EffectKind::Shield);
+		log.push(CombatEventType::Absorbed, targetSide, reduced - taken, holds ? target->effects.get(EffectKind::Shield).power : 0);
+		// absorb() drops a shield it used up, as tick() drops one that ran out
+		if (!holds) log.push(CombatEventType::EffectEnded, targetSide, 1, 0, (uint8_t)EffectKind::Shield);
+	}
+}
+
+bool CombatSystem::beginTurn(Entity* e, uint8_t side) {
+	if (!e->effects.any()) return true;
+	EffectTick t = e->effects.tick();
+	if (t.poison > 0) {
+		e->hp = std::max(e->hp - t.poison, 0);
+		log.push(CombatEventType::EffectDamage, side, t.poison, e->hp, (uint8_t)EffectKind::Poison);
+	}
+	if (t.stunned && e->hp > 0) log.push(CombatEventType::Stunned, side);
+	for (int k = 1; k < EFFECT_KIND_COUNT; k++)
+		if ((t.expired >> k) & 1) log.push(CombatEventType::EffectEnded, side, 0, 0, (uint8_t)k);
+	return !t.stunned && e->hp > 0;
+}
+
 void CombatSystem::attack() {
 	if (!player || !enemy) return;
+	if (!beginTurn(player, SIDE_PLAYER)) return;
 
 	int hitRoll = d20.roll();
-	log << "[Dice] Player d20 = " << hitRoll << " (" << player->name << " ATK: " << player->attack << ")\n";
+	log.push(CombatEventType::Roll, SIDE_PLAYER, hitRoll, player->attack, (uint8_t)RollKind::Attack);
 
 	int attackCheck = hitRoll + player->attack;
 	int defenseTarget = 10 + enemy->defense;
@@ -16,55 +53,67 @@ void CombatSystem::attack() {
 	
 	if (attackCheck >= defenseTarget || crit) {
 		int dmg = player->calculateDamage();
-		if (crit) { dmg += D6().roll(); log << "CRITICAL! extra d6\n"; }
+		if (crit) { dmg += D6().roll(); log.push(CombatEventType::Crit, SIDE_PLAYER); }
 		
-		enemy->takeDamage(dmg);
-		log << player->name << " hits " << enemy->name << " for " << dmg << " damage.\n";
+		applyDamage(enemy, SIDE_ENEMY, dmg);
+		log.push(CombatEventType::Hit, SIDE_PLAYER, dmg);
 	} else {
-		log << player->name << "'s attack missed (Target: " << defenseTarget << ").\n";
+		log.push(CombatEventType::Miss, SIDE_PLAYER, defenseTarget);
 	}
 }
 
-void CombatSystem::ability() {
-	if (!player || !enemy || player->specialAbilities.empty()) return;
+void CombatSystem::ability(int index) {
+	if (!player || !enemy || index < 0 || index >= player->abilityCount()) return;
+	if (!beginTurn(player, SIDE_PLAYER)) return;
 	
-	const SpecialAttributes& ability = player->specialAbilities[0];
-	const int MANA_COST = 5;
+	const SpecialAttributes& ability = player->ability(index);
 	
-	if (player->mana < MANA_COST) {
-		log << "Not enough Mana (" << player->mana << ")! Cost is " << MANA_COST << ".\n";
+	if (player->mana < ability.manaCost) {
+		log.push(CombatEventType::NoMana, SIDE_PLAYER, player->mana, ability.manaCost);
 		return;
 	}
 	
 	int abilityRoll = d20.roll();
-	log << "[Dice] Ability d20 = " << abilityRoll << " (Required: >=" << ability.minRolls << ")\n";
+	log.push(CombatEventType::Roll, SIDE_PLAYER, abilityRoll, ability.minRolls, (uint8_t)RollKind::Ability);
 	
 	if (abilityRoll >= ability.minRolls) {
-		D6 d6;
-		int dmg = d6.roll() + d6.roll() + player->attack + ability.atkPowerBonus;
-		player->mana -= MANA_COST;
+		int dmg = 0;
+		if (ability.dealsDamage) {
+			D6 d6;
+			dmg = d6.roll() + d6.roll() + player->attack + ability.atkPowerBonus;
+		}
+		player->mana -= ability.manaCost;
 		
-		enemy->takeDamage(dmg);
-		log << ability.name << " success! You deal " << dmg << " damage. Mana left: " << player->mana << "\n";
+		if (ability.dealsDamage) applyDamage(enemy, SIDE_ENEMY, dmg);
+		log.push(CombatEventType::AbilityHit, SIDE_PLAYER, dmg, player->mana, (uint8_t)index);
+
+		const StatusEffect& fx = ability.effect;
+		if (fx.kind != EffectKind::None) {
+			bool self = effectOnSelf(fx.kind);
+			(self ? (Entity*)player : enemy)->effects.apply(fx);
+			log.push(CombatEventType::EffectApplied, self ? SIDE_PLAYER : SIDE_ENEMY, fx.turns, fx.power, (uint8_t)fx.kind);
+		}
 	} else {
-		log << ability.name << " failed (roll too low).\n";
+		log.push(CombatEventType::AbilityFail, SIDE_PLAYER, 0, 0, (uint8_t)index);
 	}
 }
 
 void CombatSystem::defend() {
 	if (!player) return;
+	if (!beginTurn(player, SIDE_PLAYER)) return;
 	player->defending = true;
-	log << player->name << " braces for the next attack (defend).\n";
+	log.push(CombatEventType::Defend, SIDE_PLAYER);
 }
 
 bool CombatSystem::run() {
+	if (player && !beginTurn(player, SIDE_PLAYER)) return false;
 	int d20Roll = d20.roll();
-	log << "[Dice] Run d20 = " << d20Roll << "\n";
+	log.push(CombatEventType::Roll, SIDE_PLAYER, d20Roll, 0, (uint8_t)RollKind::Run);
 	if (d20Roll >= 12) {
-		log << "You fled the battle!\n";
+		log.push(CombatEventType::Fled, SIDE_PLAYER);
 		return true;
 	} else {
-		log << "Run failed!\n";
+		log.push(CombatEventType::RunFailed, SIDE_PLAYER);
 		return false;
 	}
 }
@@ -72,10 +121,14 @@ bool CombatSystem::run() {
 void CombatSystem::enemyTurn() {
 	if (!enemy || player->hp <= 0) return;
 	
-	log << "--- [Enemy Turn] " << enemy->name << " attacks ---\n";
+	log.push(CombatEventType::EnemyTurn, SIDE_ENEMY);
+	if (!beginTurn(enemy, SIDE_ENEMY)) {
+		player->resetDefend();
+		return;
+	}
 	
 	int d20Roll = d20.roll();
-	log << "[Dice] Enemy d20 = " << d20Roll << " (" << enemy->name << " ATK: " << enemy->attack << ")\n";
+	log.push(CombatEventType::Roll, SIDE_ENEMY, d20Roll, enemy->attack, (uint8_t)RollKind::Attack);
 	
 	int attackCheck = d20Roll + enemy->attack;
 	int defenseTarget = 10 + player->defense;
@@ -84,12 +137,12 @@ void CombatSystem::enemyTurn() {
 	
 	if (attackCheck >= defenseTarget || crit) {
 		int dmg = enemy->calculateDamage();
-		if (crit) { dmg += D6().roll(); log << "Enemy CRITICAL!\n"; }
+		if (crit) { dmg += D6().roll(); log.push(CombatEventType::Crit, SIDE_ENEMY); }
 		
-		player->takeDamage(dmg);
-		log << enemy->name << " deals " << dmg << " damage. \n";
+		applyDamage(player, SIDE_PLAYER, dmg);
+		log.push(CombatEventType::Hit, SIDE_ENEMY, dmg);
 	} else {
-		log << enemy->name << " missed (Target: " << defenseTarget << ").\n";
+		log.push(CombatEventType::Miss, SIDE_ENEMY, defenseTarget);
 	}
 	
 	player->resetDefend();
@@ -101,4 +154,4 @@ bool CombatSystem::isEnemyDefeated() const {
 
 bool CombatSystem::isPlayerDefeated() const {
 	return player && player->hp <= 0;
-}
\ No newline at end of file
+}
@@ -1,9 +1,96 @@
 #include "include/Dice.h"
 
-std::mt19937 rng((unsigned)std::chrono::high_resolution_clock::now().time_since_epoch().count());
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+
+static uint64_t splitmix64(uint64_t& x) {
+	uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+Rng::Rng(uint64_t seed, uint64_t stream) {
+	// Mix the stream id separately so neighbouring ids land far apart.
+	uint64_t sm = stream;
+	uint64_t x = seed ^ splitmix64(sm);
+	uint64_t a = splitmix64(x), b = splitmix64(x);
+	s[0] = (uint32_t)a; s[1] = (uint32_t)(a >> 32);
+	s[2] = (uint32_t)b; s[3] = (uint32_t)(b >> 32);
+	if ((s[0] | s[1] | s[2] | s[3]) == 0) s[0] = 1;	// all-zero state is a fixed point
+}
+
+// Only reached when the low word lands in the (tiny) biased zone.
+uint32_t Rng::boundedSlow(uint32_t n, uint64_t m) {
+	const uint32_t threshold = (0u - n) % n;
+	while ((uint32_t)m < threshold) m = (uint64_t)next() * n;
+	return (uint32_t)(m >> 32);
+}
+
+void Rng::rollN(int sides, int* out, std::size_t n) {
+	const uint32_t range = (uint32_t)sides;
+	const uint32_t threshold = (0u - range) % range;
+	// Work on a local copy: `out` may alias our state as far as the compiler
+	// knows (int vs uint32_t), which would force a reload after every store.
+	Rng g = *this;
+	for (std::size_t i = 0; i < n; i++) {
+		uint64_t m = (uint64_t)g.next() * range;
+		while ((uint32_t)m < threshold) m = (uint64_t)g.next() * range;
+		out[i] = (int)(m >> 32) + 1;
+	}
+	*this = g;
+}
+
+void Rng::setState(const uint32_t st[4]) {
+	for (int i = 0; i < 4; i++) s[i] = st[i];
+	if ((s[0] | s[1] | s[2] | s[3]) == 0) s[0] = 1;	// as in the constructor
+}
+
+static uint64_t clockSeed() {
+	return (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count()
+	       ^ (uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+static thread_local Rng defaultRng(clockSeed());
+static thread_local Rng* currentRng = &defaultRng;
+
+Rng& threadRng() {
+	return *currentRng;
+}
+
+void seedThreadRng(uint64_t seed, uint64_t stream) {
+	defaultRng = Rng(seed, stream);
+	currentRng = &defaultRng;
+}
+
+RngScope::RngScope(Rng& r) : prev(currentRng) {
+	currentRng = &r;
+}
+
+RngScope::~RngScope() {
+	currentRng = prev;
+}
 
 int Dice::roll() {
-	std::uniform_int_distribution<int> dist(1, sides);
-	lastRoll = dist(rng);
+	lastRoll = threadRng().roll(sides);
 	return lastRoll;
-}
\ No newline at end of file
+}
+
+void Dice::rollN(int* out, std::size_t n) {
+	if (n == 0) return;
+	threadRng().rollN(sides, out, n);
+	lastRoll = out[n - 1];
+}
+
+bool parseSeed(const char* text, unsigned long long& out) {
+	if (text[0] < '0' || text[0] > '9') return false;	// strtoull would skip spaces and take a sign
+	char* end = nullptr;
+	errno = 0;
+	unsigned long long v = std::strtoull(text, &end, 10);
+	if (errno == ERANGE || *end != '\0') return false;
+	out = v;
+	return true;
+}
@@ -0,0 +1,33 @@
+#include "include/Encounter.h"
+
+EncounterSlots::EncounterSlots()
+	: monster(makeGoblin(0)), boss(makeLevelBoss(0)) {
+	prepareLevels(1);
+}
+
+void EncounterSlots::prepareLevels(int count) {
+	for (int i = (int)bosses.size(); i < count; i++) {
+		goblins.push_back(makeGoblin(i));
+		ogres.push_back(makeOgre(i));
+		bosses.push_back(makeLevelBoss(i));
+	}
+}
+
+Enemy* EncounterSlots::begin(EnemyKind kind, int levelIndex, Player* player, CombatLog& log) {
+	end();
+	if (levelIndex >= (int)bosses.size()) prepareLevels(levelIndex + 1);
+
+	// Copy-assignment keeps the slot's string buffers when the names fit
+	switch (kind) {
+		case EnemyKind::Goblin: monster = goblins[levelIndex]; enemy = &monster; break;
+		case EnemyKind::Ogre:   monster = ogres[levelIndex];   enemy = &monster; break;
+		case EnemyKind::Boss:   boss = bosses[levelIndex];     enemy = &boss;    break;
+	}
+	combat.emplace(player, enemy, log);
+	return enemy;
+}
+
+void EncounterSlots::end() {
+	combat.reset();
+	enemy = nullptr;
+}
@@ -17,4 +17,22 @@ Boss::Boss(std::string n, int l, int m, int a, int d)
 
 int Boss::calculateDamage() {
 	return d6.roll() + d6.roll() + attack;
+}
+
+Monster makeGoblin(int levelIndex) {
+	int hpBonus = levelIndex * 5;
+	int atkBonus = levelIndex * 2;
+	return Monster("Goblin", 18, 5 + hpBonus, 2 + atkBonus);
+}
+
+Monster makeOgre(int levelIndex) {
+	int hpBonus = levelIndex * 5;
+	int atkBonus = levelIndex * 2;
+	return Monster("Ogre", 1, 35 + hpBonus, 6 + atkBonus);
+}
+
+Boss makeLevelBoss(int levelIndex) {
+	int hpBonus = levelIndex * 3;
+	int atkBonus = levelIndex * 2;
+	return Boss("Dungeon Lord", 3, 30 + hpBonus, 6 + atkBonus, 8);
 }
\ No newline at end of file
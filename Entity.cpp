@@ -3,11 +3,10 @@
 Entity::Entity(std::string n, int m, int a, int d) 
 	: name(n), hp(m), maxHp(m), attack(a), defense(d) {}
 
-void Entity::takeDamage(int dmg) {
-	if (defending) {
-		dmg = dmg / 2;
-		std::cout << name << " defended; damage halved to " << dmg << "\n";
-	}
+int Entity::takeDamage(int dmg) {
+	if (defending || effects.has(EffectKind::Guard)) dmg = dmg / 2;
+	dmg -= effects.absorb(dmg);
 	hp -= dmg;
 	if (hp < 0) hp = 0;
+	return dmg;
 }
\ No newline at end of file
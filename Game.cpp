@@ -0,0 +1,327 @@
+#include "include/Game.h"
+#include "include/AllocStats.h"
+#include "include/CombatSystem.h"
+#include "include/Profiler.h"
+
+#include <algorithm>
+#include <ostream>
+
+Game::Game(const LevelPack& levels, uint64_t seed, std::ostream& log)
+	: levels(levels), out(log), rng(seed), seed(seed), board(1, 1) {
+	encounters.prepareLevels(levels.count());
+	loadLevel(0);
+}
+
+void Game::restart(uint64_t newSeed) {
+	encounters.end();
+	currentEnemy = nullptr;
+	combatSystem = nullptr;
+	rng = Rng(newSeed);
+	seed = newSeed;
+	inputs.clear();
+	player.reset();
+	playerClass = PlayerClass::Soldier;
+	state = GameState::MainMenu;
+	movePoints = 0;
+	levelBossDefeated = false;
+	checkpoint = 0;
+
+	battleLog.clear();
+	battleMessageStart = 0;
+	battleDelayTimer = 0.f;
+	enemyTurnPending = false;
+	battleOver = false;
+	isFightingLevelBoss = false;
+	enemyKind = EnemyKind::Goblin;
+	enemyRow = enemyCol = -1;
+	loadLevel(0);
+}
+
+void Game::loadLevel(int index) {
+	PROFILE_SCOPE("Game::loadLevel");
+	if (index >= levels.count()) return;
+	const LevelView& lvl = levels.level(index);
+	uint64_t allocsBefore = heapAllocations();
+
+	// Pack levels are validated on load, so tiles go straight into the board
+	levelIndex = index;
+	clearedTiles.clear();
+	board.load(lvl.rows, lvl.cols, lvl.tiles);
+	startR = lvl.startR; startC = lvl.startC;
+	reach.build(board, startR, startC);
+	uint64_t allocs = heapAllocations() - allocsBefore;
+	out << "Loaded Level " << index + 1 << " (" << allocs << " heap allocations)\n";
+}
+
+void Game::startBattle(int r, int c, bool isBoss) {
+	uint64_t allocsBefore = heapAllocations();
+	battleMessageStart = battleLog.end();
+
+	EnemyKind kind = EnemyKind::Boss;
+	if (!isBoss) kind = D20().roll() > 15 ? EnemyKind::Ogre : EnemyKind::Goblin;
+	enemyKind = kind;
+	currentEnemy = encounters.begin(kind, levelIndex, &*player, battleLog);
+	combatSystem = encounters.getCombat();
+
+	enemyRow = r;
+	enemyCol = c;
+	isFightingLevelBoss = isBoss;
+	state = GameState::InBattle;
+	enemyTurnPending = false;
+	battleOver = false;
+	battleDelayTimer = 0.f;
+
+	player->resetStatus();
+
+	battleLog.push(CombatEventType::BattleStart, SIDE_PLAYER);
+	out << "[Alloc] battle start: " << heapAllocations() - allocsBefore << " heap allocations\n";
+}
+
+// The allocation count starts at `allocsBefore`, so the caller's work on the
+// way out (clearing the defeated enemy's tile) is included.
+void Game::endBattle(uint64_t allocsBefore) {
+	encounters.end();
+	currentEnemy = nullptr;
+	combatSystem = nullptr;
+	if (player) player->resetStatus();
+	out << "[Alloc] battle end: " << heapAllocations() - allocsBefore << " heap allocations\n";
+}
+
+// Detects the end of the battle and logs it; the battle screen stays up
+// until BATTLE_END_DELAY has passed.
+void Game::checkBattleStatus() {
+	if (!currentEnemy || !combatSystem) return;
+
+	if (combatSystem->isEnemyDefeated()) {
+		battleLog.push(CombatEventType::Victory, SIDE_PLAYER, 5);
+		player->hp = std::min(player->hp + 5, player->maxHp);
+
+		if (isFightingLevelBoss) {
+			levelBossDefeated = true;
+			battleLog.push(CombatEventType::BossDefeated, SIDE_PLAYER);
+			out << ">>> DUNGEON BOSS DEFEATED! The Exit is now UNLOCKED! <<<\n";
+		}
+		battleOver = true;
+		battleDelayTimer = 0.f;
+	} else if (combatSystem->isPlayerDefeated()) {
+		battleLog.push(CombatEventType::PlayerDied, SIDE_ENEMY);
+		out << player->name << " died. Game Over.\n";
+		battleOver = true;
+		battleDelayTimer = 0.f;
+	}
+}
+
+bool Game::chooseClass(PlayerClass cls) {
+	if (state != GameState::MainMenu) return false;
+	player.emplace(cls, startR, startC);
+	playerClass = cls;
+	state = GameState::Exploring;
+	return true;
+}
+
+bool Game::roll() {
+	if (state != GameState::Exploring || !player) return false;
+	if (movePoints > 0) {
+		out << "you have movepoints\n";
+		return false;
+	}
+	movePoints = D6().roll();
+	out << "[Movement] Rolled d6 = " << movePoints << " move points\n";
+	return true;
+}
+
+bool Game::move(MoveDir dir) {
+	if (state != GameState::Exploring || !player || movePoints <= 0) return false;
+	static const int DR[4] = { -1, 1, 0, 0 };
+	static const int DC[4] = { 0, 0, -1, 1 };
+	int nr = player->posR + DR[(int)dir];
+	int nc = player->posC + DC[(int)dir];
+
+	if (!board.inBounds(nr, nc)) { out << "Cannot move out of bounds\n"; return false; }
+	if (board.isBlocked(nr, nc)) { out << "Blocked tile\n"; return false; }
+
+	player->posR = nr; player->posC = nc;
+	movePoints--;
+	TileKind kind = board.getTile(nr, nc);
+	bool triggered = board.enter(nr, nc);
+
+	if (triggered && kind == TileKind::Monster) {
+		out << "[Event] Monster encountered (board)\n";
+		startBattle(nr, nc, false);
+	} else if (triggered && kind == TileKind::Boss) {
+		out << "[Event] BOSS encountered (board)\n";
+		startBattle(nr, nc, true);
+	} else if (kind == TileKind::Exit) {
+		out << "[Event] Exit reached\n";
+		if (!levelBossDefeated) {
+			out << "[LOCKED] The exit is locked! You must defeat the Boss ('T') first.\n";
+		} else if (levelIndex < levels.count() - 1) {
+			out << "Level " << levelIndex + 1 << " Cleared! Proceeding...\n";
+			levelBossDefeated = false;
+			loadLevel(levelIndex + 1);
+			player->posR = startR; player->posC = startC;
+			movePoints = 0;
+			checkpoint++;
+		} else {
+			out << "Victory!\n";
+			state = GameState::Victory;
+		}
+	}
+	return true;
+}
+
+bool Game::battleAction(CombatAction action, int ability) {
+	if (!awaitingBattleAction()) return false;
+	if (ability > 0 && ability >= player->abilityCount()) return false;
+	battleMessageStart = battleLog.end();
+
+	switch (action) {
+		case CombatAction::Attack:
+			combatSystem->attack();
+			break;
+		case CombatAction::Ability:
+			combatSystem->ability(ability);
+			break;
+		case CombatAction::Defend:
+			combatSystem->defend();
+			break;
+		case CombatAction::Run:
+			if (combatSystem->run()) {
+				uint64_t allocsBefore = heapAllocations();
+				board.resetCombatTrigger(player->posR, player->posC);
+				endBattle(allocsBefore);
+				state = GameState::Exploring;
+				checkpoint++;
+				return true;
+			}
+			break;
+	}
+	// Any turn can end the battle now that effects tick at its start
+	checkBattleStatus();
+	// Unless the battle just ended, the enemy strikes back after a delay
+	if (!battleOver) {
+		enemyTurnPending = true;
+		battleDelayTimer = 0.f;
+	}
+	return true;
+}
+
+bool Game::apply(const GameInput& input) {
+	PROFILE_SCOPE("Game::apply");
+	RngScope scope(rng);
+	bool accepted = false;
+	switch (input.kind) {
+		case GameInputKind::ChooseClass:
+			if (input.value < PLAYER_CLASS_COUNT) accepted = chooseClass((PlayerClass)input.value);
+			break;
+		case GameInputKind::Roll:
+			accepted = roll();
+			break;
+		case GameInputKind::Move:
+			if (input.value <= (uint8_t)MoveDir::Right) accepted = move((MoveDir)input.value);
+			break;
+		case GameInputKind::BattleAction: {
+			int action = input.value & 0x0F, ability = input.value >> 4;
+			if (action < COMBAT_ACTION_COUNT && (ability == 0 || (CombatAction)action == CombatAction::Ability))
+				accepted = battleAction((CombatAction)action, ability);
+			break;
+		}
+	}
+	if (accepted) inputs.push_back(input);
+	return accepted;
+}
+
+bool Game::step(float dt) {
+	battleDelayTimer += dt;
+	bool changed = false;
+
+	if (state == GameState::InBattle && enemyTurnPending && !battleOver && battleDelayTimer > ENEMY_TURN_DELAY) {
+		combatSystem->enemyTurn();
+		checkBattleStatus();
+		enemyTurnPending = false;
+		changed = true;
+	}
+
+	if (state == GameState::InBattle && battleOver && battleDelayTimer > BATTLE_END_DELAY) {
+		uint64_t allocsBefore = heapAllocations();	// the tile clear and its reachability repair count too
+		if (combatSystem->isPlayerDefeated()) {
+			state = GameState::GameOver;
+		} else {
+			board.replaceWithEmpty(enemyRow, enemyCol);
+			reach.tileChanged(board, enemyRow, enemyCol);
+			clearedTiles.push_back((uint32_t)(enemyRow * board.getCols() + enemyCol));
+			state = GameState::Exploring;
+			checkpoint++;
+		}
+		endBattle(allocsBefore);
+		battleOver = false;
+		enemyTurnPending = false;
+		changed = true;
+	}
+	return changed;
+}
+
+bool Game::update(float dt) {
+	PROFILE_SCOPE("Game::update");
+	RngScope scope(rng);
+	return step(dt);
+}
+
+void Game::settle() {
+	RngScope scope(rng);
+	// Each pass fires at most one event: the enemy's turn, then the battle's end
+	while (state == GameState::InBattle && isBattleBusy())
+		step(BATTLE_END_DELAY + 1.f);
+}
+
+static void mix(uint64_t& h, uint64_t v) {
+	for (int i = 0; i < 8; i++) { h ^= (uint8_t)(v >> (8 * i)); h *= 1099511628211ull; }
+}
+
+// Mixes nothing when there are no effects, so runs without any keep the
+// hashes they were recorded with.
+static void mixEffects(uint64_t& h, const StatusEffects& fx) {
+	if (!fx.any()) return;
+	mix(h, fx.activeMask());
+	for (int k = 1; k < EFFECT_KIND_COUNT; k++) {
+		if (!fx.has((EffectKind)k)) continue;
+		const StatusEffect& e = fx.get((EffectKind)k);
+		mix(h, (uint64_t)e.turns << 16 | (uint16_t)e.power);
+	}
+}
+
+uint64_t Game::stateHash() const {
+	return hashState(false);
+}
+
+uint64_t Game::stateHashV1() const {
+	return hashState(true);
+}
+
+uint64_t Game::hashState(bool logPosition) const {
+	uint64_t h = 14695981039346656037ull;	// FNV-1a
+	mix(h, (uint64_t)state);
+	mix(h, (uint64_t)levelIndex);
+	mix(h, (uint64_t)movePoints);
+	mix(h, levelBossDefeated);
+	if (player) {
+		mix(h, (uint64_t)player->hp); mix(h, (uint64_t)player->maxHp); mix(h, (uint64_t)player->mana);
+		mix(h, (uint64_t)player->attack); mix(h, (uint64_t)player->defense);
+		mix(h, (uint64_t)player->posR); mix(h, (uint64_t)player->posC);
+		mixEffects(h, player->effects);
+	}
+	if (currentEnemy) {
+		mix(h, (uint64_t)currentEnemy->hp); mix(h, (uint64_t)currentEnemy->maxHp);
+		mixEffects(h, currentEnemy->effects);
+		mix(h, (uint64_t)enemyRow); mix(h, (uint64_t)enemyCol);
+		mix(h, enemyTurnPending); mix(h, battleOver);
+	}
+	for (int r = 0; r < board.getRows(); r++)
+		for (int c = 0; c < board.getCols(); c++) {
+			h ^= (uint8_t)board.getTile(r, c);
+			h *= 1099511628211ull;
+		}
+	if (logPosition) mix(h, battleLog.end());
+	for (int i = 0; i < 4; i++) mix(h, rng.state()[i]);
+	return h;
+}
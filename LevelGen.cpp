@@ -0,0 +1,99 @@
+#include "include/LevelGen.h"
+#include "include/TileBitboard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+// Density as a cut-off for the top 16 bits of an Rng draw.
+static uint32_t densityCut(double density) {
+	return (uint32_t)(std::min(std::max(density, 0.0), 1.0) * 65536.0);
+}
+
+// A random cell that is not the start and not already a boss or exit.
+static int freeGoalCell(const LevelData& lvl, Rng& rng) {
+	int start = lvl.startR * lvl.cols + lvl.startC;
+	for (;;) {
+		int cell = (int)rng.bounded((uint32_t)lvl.tiles.size());
+		TileKind k = lvl.tiles[cell];
+		if (cell != start && k != TileKind::Boss && k != TileKind::Exit) return cell;
+	}
+}
+
+bool generateLevel(const LevelGenParams& params, Rng& rng, LevelData& out, long long* attempts) {
+	if (params.rows <= 0 || params.cols <= 0 || params.rows > 65535 || params.cols > 65535 ||
+	    params.bosses <= 0 || params.exits <= 0)
+		return false;
+	// 65535 x 65535 still does not fit an int (nor a pack's u32 offsets)
+	if ((long long)params.rows * params.cols > INT_MAX) return false;
+	int cells = params.rows * params.cols;
+	if (cells < 1 + params.bosses + params.exits) return false;
+
+	uint32_t blockCut = densityCut(params.blockDensity);
+	uint32_t monsterCut = blockCut + densityCut(params.monsterDensity);
+	out.rows = params.rows;
+	out.cols = params.cols;
+	out.tiles.resize(cells);
+
+	for (int attempt = 0; attempt < params.maxAttempts; attempt++) {
+		if (attempts) (*attempts)++;
+		for (TileKind& k : out.tiles) {
+			uint32_t u = rng.next() >> 16;
+			k = u < blockCut ? TileKind::Blocked : u < monsterCut ? TileKind::Monster : TileKind::Empty;
+		}
+		int start = (int)rng.bounded((uint32_t)cells);
+		out.startR = start / params.cols;
+		out.startC = start % params.cols;
+		out.tiles[start] = TileKind::Empty;
+		for (int i = 0; i < params.bosses; i++) out.tiles[freeGoalCell(out, rng)] = TileKind::Boss;
+		for (int i = 0; i < params.exits; i++) out.tiles[freeGoalCell(out, rng)] = TileKind::Exit;
+
+		if (levelIsConnected(out.rows, out.cols, out.tiles.data(), out.startR, out.startC)) return true;
+	}
+	return false;
+}
+
+bool generateLevels(const std::function<LevelGenParams(int)>& paramsFor, int count, uint64_t seed,
+                    WorkStealingPool& pool, std::vector<LevelData>& out, std::string& error,
+                    long long* attempts) {
+	out.resize(std::max(count, 0));
+	std::vector<long long> tried(pool.size(), 0);
+	std::atomic<int> failed(-1);
+
+	pool.parallelFor(count, 8, [&](int worker, long long begin, long long end) {
+		long long n = 0;
+		for (long long i = begin; i < end; i++) {
+			Rng rng(seed, (uint64_t)i);
+			if (!generateLevel(paramsFor((int)i), rng, out[i], &n)) {
+				int none = -1;
+				failed.compare_exchange_strong(none, (int)i);
+			}
+		}
+		tried[worker] += n;
+	});
+
+	if (attempts)
+		for (long long t : tried) *attempts += t;
+	if (failed >= 0) {
+		error = "no valid layout for level " + std::to_string(failed + 1) + " (densities too high?)";
+		return false;
+	}
+	return true;
+}
+
+LevelGenParams endlessLevelParams(int index) {
+	LevelGenParams p;
+	int depth = std::min(index, 50);
+	p.rows = p.cols = std::min(10 + index / 4, 64);
+	p.blockDensity = 0.25 + depth * 0.002;
+	p.monsterDensity = 0.05 + depth * 0.001;
+	return p;
+}
+
+bool generateEndlessPack(int count, uint64_t seed, WorkStealingPool& pool, LevelPack& pack, std::string& error) {
+	std::vector<LevelData> levels;
+	if (!generateLevels(endlessLevelParams, count, seed, pool, levels, error)) return false;
+	std::vector<uint8_t> bytes;
+	packLevels(levels, bytes);
+	return pack.loadFromBytes(std::move(bytes), error);
+}
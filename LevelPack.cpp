@@ -0,0 +1,279 @@
+#include "include/LevelPack.h"
+#include "include/TileBitboard.h"
+
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const size_t HEADER_SIZE = 12;
+static const size_t ENTRY_SIZE = 12;
+
+static uint32_t fnv1a(const uint8_t* p, size_t n) {
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < n; i++) { h ^= p[i]; h *= 16777619u; }
+	return h;
+}
+
+static void put16(std::vector<uint8_t>& out, size_t at, uint16_t v) {
+	out[at] = (uint8_t)v; out[at + 1] = (uint8_t)(v >> 8);
+}
+
+static void put32(std::vector<uint8_t>& out, size_t at, uint32_t v) {
+	for (int i = 0; i < 4; i++) out[at + i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+struct TextLevel {
+	std::vector<std::string> rows;
+	int firstLine = 0;
+};
+
+static bool validateLevel(const TextLevel& lvl, int index, int& startR, int& startC, std::string& error) {
+	std::ostringstream msg;
+	int width = (int)lvl.rows[0].size();
+	int players = 0, bosses = 0, exits = 0;
+
+	if (lvl.rows.size() > 65535 || width > 65535) {
+		msg << "level " << index + 1 << " (line " << lvl.firstLine << "): too large";
+		error = msg.str();
+		return false;
+	}
+	for (size_t r = 0; r < lvl.rows.size(); r++) {
+		const std::string& row = lvl.rows[r];
+		int line = lvl.firstLine + (int)r;
+		if ((int)row.size() != width) {
+			msg << "line " << line << ": row has " << row.size() << " tiles, expected " << width;
+			error = msg.str();
+			return false;
+		}
+		for (size_t c = 0; c < row.size(); c++) {
+			switch (row[c]) {
+				case 'N': case 'B': case 'M': break;
+				case 'T': bosses++; break;
+				case 'E': exits++; break;
+				case 'P': players++; startR = (int)r; startC = (int)c; break;
+				default:
+					msg << "line " << line << ": unknown tile '" << row[c] << "' in column " << c + 1;
+					error = msg.str();
+					return false;
+			}
+		}
+	}
+	if (players != 1 || bosses == 0 || exits == 0) {
+		msg << "level " << index + 1 << " (line " << lvl.firstLine << "): needs exactly one 'P' and at least one 'T' and 'E'"
+		    << " (found " << players << " P, " << bosses << " T, " << exits << " E)";
+		error = msg.str();
+		return false;
+	}
+	return true;
+}
+
+static bool validateConnected(const LevelData& lvl, const TextLevel& text, int index, std::string& error) {
+	if (levelIsConnected(lvl.rows, lvl.cols, lvl.tiles.data(), lvl.startR, lvl.startC)) return true;
+	std::ostringstream msg;
+	msg << "level " << index + 1 << " (line " << text.firstLine << "): 'P' cannot reach every 'T' and 'E'";
+	error = msg.str();
+	return false;
+}
+
+bool compileLevels(const std::string& text, std::vector<uint8_t>& out, std::string& error) {
+	std::vector<TextLevel> parsed;
+	std::istringstream in(text);
+	std::string line;
+	int lineNo = 0;
+	bool inLevel = false;
+
+	while (std::getline(in, line)) {
+		lineNo++;
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (!line.empty() && line[0] == '#') continue;
+		if (line.empty()) { inLevel = false; continue; }
+		if (!inLevel) {
+			parsed.push_back(TextLevel());
+			parsed.back().firstLine = lineNo;
+			inLevel = true;
+		}
+		parsed.back().rows.push_back(line);
+	}
+
+	if (parsed.empty()) { error = "no levels found"; return false; }
+	if (parsed.size() > 65535) { error = "too many levels"; return false; }
+
+	std::vector<LevelData> levels(parsed.size());
+	for (size_t i = 0; i < parsed.size(); i++) {
+		const TextLevel& text = parsed[i];
+		LevelData& lvl = levels[i];
+		if (!validateLevel(text, (int)i, lvl.startR, lvl.startC, error)) return false;
+
+		lvl.rows = (int)text.rows.size();
+		lvl.cols = (int)text.rows[0].size();
+		for (const std::string& row : text.rows)
+			for (char ch : row) lvl.tiles.push_back(tileKindFromChar(ch));
+		if (!validateConnected(lvl, text, (int)i, error)) return false;
+	}
+	packLevels(levels, out);
+	return true;
+}
+
+void packLevels(const std::vector<LevelData>& levels, std::vector<uint8_t>& out) {
+	size_t tableEnd = HEADER_SIZE + levels.size() * ENTRY_SIZE;
+	size_t cells = 0;
+	for (const LevelData& lvl : levels) cells += lvl.tiles.size();
+	out.assign(tableEnd, 0);
+	out.reserve(tableEnd + cells);
+
+	for (size_t i = 0; i < levels.size(); i++) {
+		const LevelData& lvl = levels[i];
+		size_t entry = HEADER_SIZE + i * ENTRY_SIZE;
+		put16(out, entry, (uint16_t)lvl.rows);
+		put16(out, entry + 2, (uint16_t)lvl.cols);
+		put16(out, entry + 4, (uint16_t)lvl.startR);
+		put16(out, entry + 6, (uint16_t)lvl.startC);
+		put32(out, entry + 8, (uint32_t)out.size());
+		for (TileKind k : lvl.tiles) out.push_back((uint8_t)k);
+	}
+
+	std::memcpy(out.data(), "RLVL", 4);
+	put16(out, 4, LEVEL_PACK_VERSION);
+	put16(out, 6, (uint16_t)levels.size());
+	put32(out, 8, fnv1a(out.data() + HEADER_SIZE, out.size() - HEADER_SIZE));
+}
+
+std::string levelToText(const LevelData& level) {
+	static const char CHARS[TILE_KIND_COUNT] = { 'N', 'B', 'M', 'T', 'E' };
+	std::string text;
+	text.reserve((size_t)level.rows * (level.cols + 1));
+	for (int r = 0; r < level.rows; r++) {
+		for (int c = 0; c < level.cols; c++) {
+			bool start = r == level.startR && c == level.startC;
+			text += start ? 'P' : CHARS[(int)level.tiles[(size_t)r * level.cols + c]];
+		}
+		text += '\n';
+	}
+	return text;
+}
+
+LevelPack::~LevelPack() {
+	close();
+}
+
+void LevelPack::close() {
+#ifndef _WIN32
+	if (mapping) munmap(mapping, size);
+#endif
+	mapping = nullptr;
+	data = nullptr;
+	size = 0;
+	owned.clear();
+	levels.clear();
+	packChecksum = 0;
+}
+
+bool LevelPack::parse(std::string& error) {
+	if (size < HEADER_SIZE || std::memcmp(data, "RLVL", 4) != 0) { error = "not a level pack"; return false; }
+	if (get16(data + 4) != LEVEL_PACK_VERSION) { error = "unsupported level pack version"; return false; }
+	if (get32(data + 8) != fnv1a(data + HEADER_SIZE, size - HEADER_SIZE)) { error = "checksum mismatch"; return false; }
+
+	int n = get16(data + 6);
+	if (HEADER_SIZE + (size_t)n * ENTRY_SIZE > size) { error = "truncated level table"; return false; }
+
+	levels.resize(n);
+	for (int i = 0; i < n; i++) {
+		const uint8_t* e = data + HEADER_SIZE + i * ENTRY_SIZE;
+		LevelView& v = levels[i];
+		v.rows = get16(e);
+		v.cols = get16(e + 2);
+		v.startR = get16(e + 4);
+		v.startC = get16(e + 6);
+		size_t offset = get32(e + 8);
+		size_t cells = (size_t)v.rows * v.cols;
+
+		// Board and Reachability index cells with an int
+		if (cells == 0 || cells > INT_MAX || offset + cells > size || v.startR >= v.rows || v.startC >= v.cols) {
+			error = "level " + std::to_string(i + 1) + " is out of range";
+			levels.clear();
+			return false;
+		}
+		int bosses = 0, exits = 0;
+		for (size_t k = 0; k < cells; k++) {
+			if (data[offset + k] >= TILE_KIND_COUNT) {
+				error = "level " + std::to_string(i + 1) + " has an invalid tile";
+				levels.clear();
+				return false;
+			}
+			bosses += data[offset + k] == (uint8_t)TileKind::Boss;
+			exits += data[offset + k] == (uint8_t)TileKind::Exit;
+		}
+		v.tiles = reinterpret_cast<const TileKind*>(data + offset);
+
+		// The rest of what compileLevels checks: an empty start that walks to
+		// at least one boss and exit, and to every one of them
+		const char* problem = nullptr;
+		if (v.tiles[(size_t)v.startR * v.cols + v.startC] != TileKind::Empty) problem = " starts on a tile that is not empty";
+		else if (bosses == 0 || exits == 0) problem = " needs at least one boss and one exit";
+		else if (!levelIsConnected(v.rows, v.cols, v.tiles, v.startR, v.startC)) problem = "'s start cannot reach every boss and exit";
+		if (problem) {
+			error = "level " + std::to_string(i + 1) + problem;
+			levels.clear();
+			return false;
+		}
+	}
+	packChecksum = get32(data + 8);
+	return true;
+}
+
+bool LevelPack::open(const std::string& path, std::string& error) {
+	close();
+#ifndef _WIN32
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) { error = "cannot open " + path; return false; }
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); error = "cannot read " + path; return false; }
+
+	void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED) { error = "cannot map " + path; return false; }
+
+	mapping = p;
+	data = static_cast<const uint8_t*>(p);
+	size = (size_t)st.st_size;
+	if (!parse(error)) { close(); return false; }
+	return true;
+#else
+	std::ifstream f(path, std::ios::binary);
+	if (!f) { error = "cannot open " + path; return false; }
+	std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	return loadFromBytes(std::move(bytes), error);
+#endif
+}
+
+bool LevelPack::loadFromBytes(std::vector<uint8_t> bytes, std::string& error) {
+	close();
+	owned = std::move(bytes);
+	data = owned.data();
+	size = owned.size();
+	if (!parse(error)) { close(); return false; }
+	return true;
+}
+
+bool LevelPack::compileFromFile(const std::string& path, std::string& error) {
+	std::ifstream f(path);
+	if (!f) { error = "cannot open " + path; return false; }
+	std::stringstream text;
+	text << f.rdbuf();
+
+	std::vector<uint8_t> bytes;
+	if (!compileLevels(text.str(), bytes, error)) { error = path + ": " + error; return false; }
+	return loadFromBytes(std::move(bytes), error);
+}
@@ -0,0 +1,204 @@
+#include "include/PartyBattle.h"
+#include "include/CombatSystem.h"
+
+#include <algorithm>
+
+const char* targetRuleName(TargetRule rule) {
+	switch (rule) {
+		case TargetRule::Front:   return "front";
+		case TargetRule::Random:  return "random";
+		case TargetRule::Weakest: return "weakest";
+	}
+	return "?";
+}
+
+bool PartyBattle::laterTurn(const Turn& a, const Turn& b) {
+	if (a.round != b.round) return a.round > b.round;
+	if (a.initiative != b.initiative) return a.initiative < b.initiative;
+	return a.member > b.member;
+}
+
+bool PartyBattle::higherHp(const HpReading& a, const HpReading& b) {
+	if (a.hp != b.hp) return a.hp > b.hp;
+	return a.member > b.member;
+}
+
+PartyBattle::PartyBattle(CombatLog& l) : log(l) {}
+
+PartyBattle::PartyBattle() : log(scratchLog()) {}
+
+void PartyBattle::reset() {
+	members.clear();
+	for (Side& s : sides) {
+		s.members.clear();
+		s.alive.clear();
+		s.front = 0;
+		s.weakest.clear();
+	}
+	queue.clear();
+	started = false;
+	round = 0;
+	turns = 0;
+}
+
+int PartyBattle::join(Entity* e, Player* p, Enemy* en, uint8_t side, TargetRule rule, SimPolicy policy, int initiativeBonus) {
+	int i = (int)members.size();
+	Member m;
+	m.entity = e;
+	m.player = p;
+	m.enemy = en;
+	m.side = side;
+	m.rule = rule;
+	m.policy = policy == SimPolicy::Search ? SimPolicy::Ability : policy;
+	m.initiativeBonus = initiativeBonus;
+	members.push_back(m);
+
+	Side& s = sides[side];
+	s.members.push_back(i);
+	if (e->hp > 0) {
+		members[i].alivePos = (int)s.alive.size();
+		members[i].lastHp = e->hp;
+		s.alive.push_back(i);
+		s.weakest.push_back({ e->hp, i });
+		std::push_heap(s.weakest.begin(), s.weakest.end(), higherHp);
+	}
+
+	if (started) {
+		e->resetStatus();
+		rollInitiative(i);
+		queue.push_back({ round + 1, members[i].initiative, i });
+		std::push_heap(queue.begin(), queue.end(), laterTurn);
+	}
+	return i;
+}
+
+int PartyBattle::addPlayer(Player* p, SimPolicy policy, TargetRule rule, int initiativeBonus) {
+	return join(p, p, nullptr, SIDE_PLAYER, rule, policy, initiativeBonus);
+}
+
+int PartyBattle::addEnemy(Enemy* e, TargetRule rule, int initiativeBonus) {
+	return join(e, nullptr, e, SIDE_ENEMY, rule, SimPolicy::Attack, initiativeBonus);
+}
+
+void PartyBattle::rollInitiative(int i) {
+	Member& m = members[i];
+	m.initiative = D20().roll() + m.initiativeBonus;
+	log.push(CombatEventType::Initiative, m.side, m.initiative, i);
+}
+
+void PartyBattle::start() {
+	queue.clear();
+	round = 0;
+	turns = 0;
+	started = true;
+	for (int i = 0; i < (int)members.size(); i++) {
+		members[i].entity->resetStatus();
+		rollInitiative(i);
+		queue.push_back({ 1, members[i].initiative, i });
+	}
+	std::make_heap(queue.begin(), queue.end(), laterTurn);
+}
+
+int PartyBattle::pickTarget(const Member& m) {
+	Side& foes = sides[m.side == SIDE_PLAYER ? SIDE_ENEMY : SIDE_PLAYER];
+	if (foes.alive.empty()) return -1;
+
+	switch (m.rule) {
+		case TargetRule::Front:
+			while (members[foes.members[foes.front]].alivePos < 0) foes.front++;
+			return foes.members[foes.front];
+		case TargetRule::Random:
+			return foes.alive[threadRng().bounded((uint32_t)foes.alive.size())];
+		case TargetRule::Weakest:
+			// A reading is current if its member still stands at that HP
+			for (;;) {
+				const HpReading& top = foes.weakest.front();
+				const Member& t = members[top.member];
+				if (t.alivePos >= 0 && t.entity->hp == top.hp) return top.member;
+				std::pop_heap(foes.weakest.begin(), foes.weakest.end(), higherHp);
+				foes.weakest.pop_back();
+			}
+	}
+	return foes.alive.front();
+}
+
+void PartyBattle::takeTurn(int actor, int target) {
+	const Member& m = members[actor];
+	const Member& t = members[target];
+	log.push(CombatEventType::PartyTurn, m.side, actor, target);
+
+	if (m.player) {
+		CombatSystem combat(m.player, t.enemy, log);
+		int ability = simPolicyAbility(*m.player, *t.enemy, m.policy);
+		if (ability >= 0) combat.ability(ability);
+		else combat.attack();
+	} else {
+		CombatSystem combat(t.player, m.enemy, log);
+		combat.enemyTurn();
+	}
+}
+
+void PartyBattle::touch(int i) {
+	Member& m = members[i];
+	if (m.alivePos < 0 || m.entity->hp == m.lastHp) return;
+	Side& s = sides[m.side];
+
+	if (m.entity->hp <= 0) {
+		int last = s.alive.back();
+		s.alive[m.alivePos] = last;
+		members[last].alivePos = m.alivePos;
+		s.alive.pop_back();
+		m.alivePos = -1;
+		log.push(CombatEventType::Downed, m.side, i);
+		return;
+	}
+	m.lastHp = m.entity->hp;
+	s.weakest.push_back({ m.lastHp, i });
+	std::push_heap(s.weakest.begin(), s.weakest.end(), higherHp);
+
+	// Stale readings only leave the heap when a Weakest pick reaches them,
+	// so without such picks it would grow with every hit. Past two readings
+	// per living member it is rebuilt from their current ones.
+	if (s.weakest.size() > 2 * s.alive.size()) {
+		s.weakest.clear();
+		for (int j : s.alive) s.weakest.push_back({ members[j].lastHp, j });
+		std::make_heap(s.weakest.begin(), s.weakest.end(), higherHp);
+	}
+}
+
+bool PartyBattle::step() {
+	if (!started) start();
+	while (!isOver() && !queue.empty()) {
+		std::pop_heap(queue.begin(), queue.end(), laterTurn);
+		Turn next = queue.back();
+		queue.pop_back();
+		if (members[next.member].alivePos < 0) continue;	// fell since it was queued
+
+		round = next.round;
+		int target = pickTarget(members[next.member]);
+		takeTurn(next.member, target);
+		turns++;
+		touch(next.member);
+		touch(target);
+
+		if (members[next.member].alivePos >= 0) {
+			next.round++;
+			queue.push_back(next);
+			std::push_heap(queue.begin(), queue.end(), laterTurn);
+		}
+		return !isOver();
+	}
+	return false;
+}
+
+long long PartyBattle::run(long long maxTurns) {
+	long long first = turns;
+	while (turns - first < maxTurns && step()) {}
+	return turns - first;
+}
+
+int PartyBattle::winner() const {
+	bool players = !sides[SIDE_PLAYER].alive.empty(), enemies = !sides[SIDE_ENEMY].alive.empty();
+	if (players == enemies) return -1;
+	return players ? SIDE_PLAYER : SIDE_ENEMY;
+}
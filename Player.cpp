@@ -1,45 +1,12 @@
 #include "include/Player.h"
 #include "include/Dice.h"
 
-Player::Player(std::string n, int m, int a, int d, int r, int c)
-    : Entity(n, m, a, d), posR(r), posC(c) {}
-
-int Player::calculateDamage() {
-    D6 d6;
-    return d6.roll() + attack;
-}
-
-// --- SOLDIER ---
-Soldier::Soldier(int r, int c) 
-    : Player("Soldier", 100, 15, 10, r, c) { 
-    setStats(); 
-}
-
-void Soldier::setStats() {
-    maxHp = 120; hp = 120; attack = 15; defense = 8; mana = 10;
-    specialAbilities.push_back({"Power Strike", 5, 15});
-}
-
-
-// --- ARCHER ---
-Archer::Archer(int r, int c) 
-    : Player("Archer", 80, 18, 5, r, c) { 
-    setStats(); 
-}
-
-void Archer::setStats() {
-    maxHp = 80; hp = 80; attack = 18; defense = 4; mana = 20;
-    specialAbilities.push_back({"Piercing Shot", 3, 12});
+Player::Player(PlayerClass cls, int r, int c)
+    : Entity(classDef(cls).name, classDef(cls).maxHp, classDef(cls).attack, classDef(cls).defense),
+      def(&classDef(cls)), posR(r), posC(c) {
+    mana = def->mana;
 }
 
-
-// --- MAGE ---
-Mage::Mage(int r, int c) 
-    : Player("Mage", 70, 8, 3, r, c) { 
-    setStats(); 
+int Player::calculateDamage() {
+    return Dice(def->damageDie).roll() + attack;
 }
-
-void Mage::setStats() {
-    maxHp = 70; hp = 70; attack = 8; defense = 3; mana = 40;
-    specialAbilities.push_back({"Fireball", 10, 10});
-}
\ No newline at end of file
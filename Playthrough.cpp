@@ -0,0 +1,179 @@
+#include "include/Playthrough.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+
+void ClassRunStats::merge(const ClassRunStats& o) {
+	runs += o.runs;
+	clears += o.clears;
+	deaths += o.deaths;
+	timeouts += o.timeouts;
+	turns += o.turns;
+	for (int i = 0; i < PLAYTHROUGH_MAX_LEVELS; i++) {
+		LevelRunStats& l = levels[i];
+		const LevelRunStats& ol = o.levels[i];
+		l.entered += ol.entered;
+		l.cleared += ol.cleared;
+		l.deaths += ol.deaths;
+		l.timeouts += ol.timeouts;
+		l.turns += ol.turns;
+		l.battles += ol.battles;
+		l.battleRounds += ol.battleRounds;
+	}
+}
+
+void PlaythroughStats::merge(const PlaythroughStats& o) {
+	levelCount = std::max(levelCount, o.levelCount);
+	for (int c = 0; c < PLAYER_CLASS_COUNT; c++) classes[c].merge(o.classes[c]);
+}
+
+static LevelRunStats& levelStats(ClassRunStats& stats, int levelIndex) {
+	return stats.levels[std::min(levelIndex, PLAYTHROUGH_MAX_LEVELS - 1)];
+}
+
+// Step along `field` from the player's tile, or any open direction when the
+// goal cannot be reached (the run then times out rather than hanging).
+static MoveDir scriptedStep(Game& game, const DistanceField& field) {
+	const Player& p = *game.getPlayer();
+	int nr, nc;
+	if (field.nextStep(p.posR, p.posC, nr, nc)) {
+		if (nr < p.posR) return MoveDir::Up;
+		if (nr > p.posR) return MoveDir::Down;
+		if (nc < p.posC) return MoveDir::Left;
+		return MoveDir::Right;
+	}
+	const Board& board = game.getBoard();
+	static const int DR[4] = { -1, 1, 0, 0 };
+	static const int DC[4] = { 0, 0, -1, 1 };
+	int d = (int)(game.getInputs().size() % 4);
+	for (int k = 0; k < 4; k++, d = (d + 1) % 4)
+		if (board.inBounds(p.posR + DR[d], p.posC + DC[d]) && !board.isBlocked(p.posR + DR[d], p.posC + DC[d]))
+			break;
+	return (MoveDir)d;
+}
+
+void playScriptedRun(Game& game, PlayerClass cls, SimPolicy policy, ClassRunStats& stats) {
+	stats.runs++;
+	game.apply({ GameInputKind::ChooseClass, (uint8_t)cls });
+	int level = game.getLevelIndex();
+	levelStats(stats, level).entered++;
+	long long turns = 0;
+
+	while ((int)game.getInputs().size() < PLAYTHROUGH_MAX_INPUTS) {
+		game.settle();
+		GameState state = game.getState();
+		if (state == GameState::GameOver || state == GameState::Victory) break;
+
+		if (state == GameState::InBattle) {
+			const Player& p = *game.getPlayer();
+			const Enemy& e = *game.getEnemy();
+			int ability = 0;
+			CombatAction a = simPolicyAction(p, e, policy, &ability);
+			if (game.apply({ GameInputKind::BattleAction, battleInputValue(a, ability) })) levelStats(stats, level).battleRounds++;
+			continue;
+		}
+
+		if (game.getMovePoints() == 0) {
+			game.apply({ GameInputKind::Roll });
+			levelStats(stats, level).turns++;
+			turns++;
+			continue;
+		}
+
+		Reachability& reach = game.getReach();
+		const DistanceField& goal = game.isLevelBossDefeated() ? reach.distanceToExit() : reach.distanceToBoss();
+		game.apply({ GameInputKind::Move, (uint8_t)scriptedStep(game, goal) });
+		if (game.getState() == GameState::InBattle) {
+			levelStats(stats, level).battles++;
+		} else if (game.getLevelIndex() != level) {
+			levelStats(stats, level).cleared++;
+			level = game.getLevelIndex();
+			levelStats(stats, level).entered++;
+		}
+	}
+	game.settle();
+
+	stats.turns += turns;
+	LevelRunStats& last = levelStats(stats, level);
+	switch (game.getState()) {
+		case GameState::Victory:
+			last.cleared++;
+			stats.clears++;
+			break;
+		case GameState::GameOver:
+			last.deaths++;
+			stats.deaths++;
+			break;
+		default:
+			last.timeouts++;
+			stats.timeouts++;
+			break;
+	}
+}
+
+PlaythroughStats runPlaythroughs(const LevelPack& levels, long long runs, SimPolicy policy,
+                                 WorkStealingPool& pool, uint64_t seed) {
+	std::vector<PlaythroughStats> partial(pool.size());
+	// One game (and log sink) per worker, restarted for each run: a fresh
+	// Game costs dozens of allocations, and every one bumps the counter all
+	// threads share
+	std::vector<std::unique_ptr<std::ostream>> silent;
+	std::vector<std::unique_ptr<Game>> games;
+	for (int w = 0; w < pool.size(); w++) {
+		silent.emplace_back(new std::ostream(nullptr));
+		games.emplace_back(new Game(levels, 0, *silent.back()));
+	}
+
+	// A handful of runs per grab: one run is tens of microseconds, and a
+	// grab is one uncontended lock
+	pool.parallelFor(runs, 16, [&](int worker, long long begin, long long end) {
+		PlaythroughStats& stats = partial[worker];
+		Game& game = *games[worker];
+		for (long long i = begin; i < end; i++) {
+			Rng seeder(seed, (uint64_t)i);
+			game.restart(((uint64_t)seeder.next() << 32) | seeder.next());
+			PlayerClass cls = (PlayerClass)(i % PLAYER_CLASS_COUNT);
+			playScriptedRun(game, cls, policy, stats.classes[(int)cls]);
+		}
+	});
+
+	PlaythroughStats total;
+	total.levelCount = std::min(levels.count(), PLAYTHROUGH_MAX_LEVELS);
+	for (const auto& s : partial) total.merge(s);
+	return total;
+}
+
+static double ratio(long long a, long long b) {
+	return b ? double(a) / b : 0.0;
+}
+
+static void writeRow(std::ostream& out, const char* cls, const char* level, long long runs, long long cleared,
+                     long long deaths, long long timeouts, long long turns, long long battles, long long rounds) {
+	char line[256];
+	std::snprintf(line, sizeof(line), "%s,%s,%lld,%lld,%.4f,%lld,%.4f,%lld,%.2f,%.2f,%.2f\n",
+	              cls, level, runs, cleared, ratio(cleared, runs), deaths, ratio(deaths, runs), timeouts,
+	              ratio(turns, runs), ratio(battles, runs), ratio(rounds, runs));
+	out << line;
+}
+
+void writePlaythroughCsv(const PlaythroughStats& stats, std::ostream& out) {
+	out << "class,level,runs,cleared,clear_rate,deaths,death_rate,timeouts,turns,battles,battle_rounds\n";
+	for (int c = 0; c < PLAYER_CLASS_COUNT; c++) {
+		const ClassRunStats& cs = stats.classes[c];
+		const char* name = playerClassName((PlayerClass)c);
+		long long battles = 0, rounds = 0;
+		for (const LevelRunStats& l : cs.levels) {
+			battles += l.battles;
+			rounds += l.battleRounds;
+		}
+		writeRow(out, name, "all", cs.runs, cs.clears, cs.deaths, cs.timeouts, cs.turns, battles, rounds);
+		for (int i = 0; i < stats.levelCount; i++) {
+			const LevelRunStats& l = cs.levels[i];
+			char level[16];
+			std::snprintf(level, sizeof(level), "%d", i + 1);
+			writeRow(out, name, level, l.entered, l.cleared, l.deaths, l.timeouts, l.turns, l.battles, l.battleRounds);
+		}
+	}
+}
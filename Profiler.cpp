@@ -0,0 +1,203 @@
+#include "include/Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+static uint64_t nowNs() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// --- Per-frame statistics (frame thread only, no locking) ---
+
+struct ZoneSlot {
+	const char* name;
+	int depth;
+	double frameMs;					// accumulated in the current frame
+	double history[PROFILE_HISTORY];
+};
+
+static const int MAX_ZONES = 64;
+static ZoneSlot zones[MAX_ZONES];
+static int zoneCount = 0;
+static double frameHistory[PROFILE_HISTORY];
+static int historyPos = 0, historyCount = 0;
+static uint64_t lastFrameNs = 0;
+
+static std::atomic<bool> haveFrameThread(false);
+static std::thread::id frameThread;		// written once, before haveFrameThread
+static uint32_t frameThreadTid = 0;		// its trace thread index
+
+static thread_local int zoneDepth = 0;
+
+static bool onFrameThread() {
+	return haveFrameThread.load(std::memory_order_acquire) && std::this_thread::get_id() == frameThread;
+}
+
+static ZoneSlot* findZone(const char* name, int depth) {
+	for (int i = 0; i < zoneCount; i++)
+		if (zones[i].name == name) return &zones[i];
+	if (zoneCount == MAX_ZONES) return nullptr;
+	ZoneSlot& z = zones[zoneCount++];
+	z.name = name;
+	z.depth = depth;
+	z.frameMs = 0;
+	std::fill(z.history, z.history + PROFILE_HISTORY, 0.0);
+	return &z;
+}
+
+// --- Trace capture (any thread) ---
+
+struct TraceEvent {
+	const char* name;
+	uint64_t startNs, durNs;
+	uint32_t tid;
+};
+
+static std::atomic<bool> tracing(false);
+static std::mutex traceMutex;
+static std::vector<TraceEvent> traceEvents;
+static size_t traceLimit = 0, traceDropped = 0;
+static uint64_t traceStartNs = 0;
+static std::atomic<uint32_t> nextThreadIndex(0);
+static thread_local uint32_t threadIndex = nextThreadIndex++;
+
+static void traceEvent(const char* name, uint64_t start, uint64_t end) {
+	std::lock_guard<std::mutex> lock(traceMutex);
+	if (!tracing.load(std::memory_order_relaxed) || start < traceStartNs) return;
+	if (traceEvents.size() >= traceLimit) { traceDropped++; return; }
+	traceEvents.push_back(TraceEvent{ name, start, end - start, threadIndex });
+}
+
+ProfileZone::ProfileZone(const char* n) : name(n), start(nowNs()) {
+	zoneDepth++;
+}
+
+ProfileZone::~ProfileZone() {
+	uint64_t end = nowNs();
+	zoneDepth--;
+	if (onFrameThread()) {
+		ZoneSlot* z = findZone(name, zoneDepth);
+		if (z) z->frameMs += (end - start) / 1e6;
+	}
+	if (tracing.load(std::memory_order_relaxed)) traceEvent(name, start, end);
+}
+
+void profileFrame() {
+	uint64_t now = nowNs();
+	if (!haveFrameThread.load(std::memory_order_relaxed)) {
+		frameThread = std::this_thread::get_id();
+		frameThreadTid = threadIndex;
+		haveFrameThread.store(true, std::memory_order_release);
+		lastFrameNs = now;
+		return;
+	}
+
+	for (int i = 0; i < zoneCount; i++) {
+		zones[i].history[historyPos] = zones[i].frameMs;
+		zones[i].frameMs = 0;
+	}
+	frameHistory[historyPos] = (now - lastFrameNs) / 1e6;
+	historyPos = (historyPos + 1) % PROFILE_HISTORY;
+	historyCount = std::min(historyCount + 1, PROFILE_HISTORY);
+
+	if (tracing.load(std::memory_order_relaxed)) traceEvent("frame", lastFrameNs, now);
+	lastFrameNs = now;
+}
+
+void profileZoneStats(std::vector<ProfileZoneStats>& out) {
+	out.clear();
+	int last = (historyPos + PROFILE_HISTORY - 1) % PROFILE_HISTORY;
+	for (int i = 0; i < zoneCount; i++) {
+		const ZoneSlot& z = zones[i];
+		ProfileZoneStats s = { z.name, z.depth, historyCount ? z.history[last] : 0.0, 0.0, 0.0 };
+		for (int k = 0; k < historyCount; k++) {
+			s.avgMs += z.history[k];
+			s.maxMs = std::max(s.maxMs, z.history[k]);
+		}
+		if (historyCount) s.avgMs /= historyCount;
+		out.push_back(s);
+	}
+}
+
+void profileSkipFrame() {
+	if (!onFrameThread()) return;
+	for (int i = 0; i < zoneCount; i++) zones[i].frameMs = 0;
+	lastFrameNs = nowNs();
+}
+
+ProfileFrameStats profileFrameStats() {
+	ProfileFrameStats s;
+	s.frames = historyCount;
+	if (!historyCount) return s;
+
+	double sorted[PROFILE_HISTORY];
+	std::copy(frameHistory, frameHistory + historyCount, sorted);
+	std::sort(sorted, sorted + historyCount);
+	for (int i = 0; i < historyCount; i++) s.avgMs += sorted[i];
+	s.avgMs /= historyCount;
+	s.p50Ms = sorted[historyCount / 2];
+	s.p95Ms = sorted[std::min(historyCount - 1, historyCount * 95 / 100)];
+	s.p99Ms = sorted[std::min(historyCount - 1, historyCount * 99 / 100)];
+	s.maxMs = sorted[historyCount - 1];
+	return s;
+}
+
+void startProfileTrace(size_t maxEvents) {
+	std::lock_guard<std::mutex> lock(traceMutex);
+	traceEvents.clear();
+	traceEvents.reserve(std::min<size_t>(maxEvents, 1 << 16));
+	traceLimit = maxEvents;
+	traceDropped = 0;
+	traceStartNs = nowNs();
+	tracing.store(true, std::memory_order_relaxed);
+}
+
+bool isProfileTracing() {
+	return tracing.load(std::memory_order_relaxed);
+}
+
+// Zone names are literals and function names; only quotes and backslashes
+// need escaping.
+static void writeJsonString(std::ostream& out, const char* s) {
+	out << '"';
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\') out << '\\';
+		out << *s;
+	}
+	out << '"';
+}
+
+bool stopProfileTrace(const std::string& path, std::string& error) {
+	std::vector<TraceEvent> events;
+	size_t dropped;
+	uint64_t start;
+	{
+		std::lock_guard<std::mutex> lock(traceMutex);
+		tracing.store(false, std::memory_order_relaxed);
+		events.swap(traceEvents);
+		dropped = traceDropped;
+		start = traceStartNs;
+	}
+
+	std::ofstream out(path);
+	if (!out) { error = "cannot write " + path; return false; }
+	char num[64];
+	out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << dropped << "},\"traceEvents\":[\n";
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << frameThreadTid
+	    << ",\"args\":{\"name\":\"main loop\"}}";
+	for (const TraceEvent& e : events) {
+		out << ",\n{\"name\":";
+		writeJsonString(out, e.name);
+		std::snprintf(num, sizeof(num), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", (e.startNs - start) / 1e3, e.durNs / 1e3);
+		out << num << ",\"pid\":1,\"tid\":" << e.tid << "}";
+	}
+	out << "\n]}\n";
+	if (!out) { error = "cannot write " + path; return false; }
+	return true;
+}
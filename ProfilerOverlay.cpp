@@ -0,0 +1,51 @@
+#include "include/ProfilerOverlay.h"
+
+#include <cstdio>
+
+void ProfilerOverlay::setFont(const sf::Font& font) {
+	text.setFont(font);
+	text.setCharacterSize(14);
+	text.setFillColor(sf::Color::White);
+	text.setPosition(8.f, 6.f);
+	background.setFillColor(sf::Color(0, 0, 0, 170));
+	background.setPosition(4.f, 4.f);
+}
+
+void ProfilerOverlay::refresh() {
+	char line[160];
+	buffer.clear();
+	if (!profilerCompiledIn()) {
+		buffer = "Profiler not built in (cmake -DROGUE_PROFILE=ON)";
+	} else {
+		ProfileFrameStats f = profileFrameStats();
+		std::snprintf(line, sizeof(line), "frame ms  avg %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f\n",
+		              f.avgMs, f.p50Ms, f.p95Ms, f.p99Ms, f.maxMs);
+		buffer += line;
+		std::snprintf(line, sizeof(line), "FPS  p50 %.0f  p95 %.0f  p99 %.0f   (%d frames%s)\n",
+		              f.p50Ms > 0 ? 1000.0 / f.p50Ms : 0.0, f.p95Ms > 0 ? 1000.0 / f.p95Ms : 0.0,
+		              f.p99Ms > 0 ? 1000.0 / f.p99Ms : 0.0, f.frames, isProfileTracing() ? ", tracing" : "");
+		buffer += line;
+
+		profileZoneStats(zones);
+		for (const ProfileZoneStats& z : zones) {
+			std::snprintf(line, sizeof(line), "%*s%-*s %7.3f %7.3f %7.3f\n", z.depth * 2, "", 28 - z.depth * 2, z.name,
+			              z.lastMs, z.avgMs, z.maxMs);
+			buffer += line;
+		}
+		buffer += "zone (ms: last / avg / max)";
+	}
+	text.setString(buffer);
+	sf::FloatRect bounds = text.getLocalBounds();
+	background.setSize(sf::Vector2f(bounds.left + bounds.width + 12.f, bounds.top + bounds.height + 12.f));
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target) {
+	if (!visible) return;
+	PROFILE_SCOPE("ProfilerOverlay::draw");
+	if (++framesSinceRefresh >= REFRESH_FRAMES) {
+		refresh();
+		framesSinceRefresh = 0;
+	}
+	target.draw(background);
+	target.draw(text);
+}
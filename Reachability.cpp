@@ -0,0 +1,239 @@
+#include "include/Reachability.h"
+#include "include/Board.h"
+#include "include/Profiler.h"
+
+#include <algorithm>
+#include <functional>
+
+static const int DR[4] = { -1, 1, 0, 0 };
+static const int DC[4] = { 0, 0, -1, 1 };
+
+void DistanceField::build(int r, int c, const uint8_t* walkable, const std::vector<int>& sources) {
+	rows = r; cols = c;
+	dist.assign(rows * cols, UNREACHABLE);
+	source.assign(rows * cols, 0);
+	invalidStamp.assign(rows * cols, 0);
+	stamp = 0;
+	// Sized once per level so updates do not allocate
+	queue.reserve(rows * cols);
+	open.reserve(rows * cols);
+
+	queue.clear();
+	for (int i : sources) {
+		source[i] = 1;
+		if (walkable[i] && dist[i] != 0) { dist[i] = 0; queue.push_back(i); }
+	}
+	for (size_t head = 0; head < queue.size(); head++) {
+		int i = queue[head];
+		int ir = i / cols, ic = i % cols;
+		for (int d = 0; d < 4; d++) {
+			int nr = ir + DR[d], nc = ic + DC[d];
+			if (nr < 0 || nc < 0 || nr >= rows || nc >= cols) continue;
+			int n = nr * cols + nc;
+			if (!walkable[n] || dist[n] != UNREACHABLE) continue;
+			dist[n] = dist[i] + 1;
+			queue.push_back(n);
+		}
+	}
+}
+
+// Whether tile i still has a valid neighbour one step closer to a source.
+bool DistanceField::supported(const uint8_t* walkable, int i) const {
+	int ir = i / cols, ic = i % cols;
+	for (int d = 0; d < 4; d++) {
+		int nr = ir + DR[d], nc = ic + DC[d];
+		if (nr < 0 || nc < 0 || nr >= rows || nc >= cols) continue;
+		int n = nr * cols + nc;
+		if (walkable[n] && invalidStamp[n] != stamp && dist[n] == dist[i] - 1) return true;
+	}
+	return false;
+}
+
+// BFS outward from i, lowering every neighbour that gets closer through it.
+void DistanceField::relaxFrom(const uint8_t* walkable, int i) {
+	queue.clear();
+	queue.push_back(i);
+	for (size_t head = 0; head < queue.size(); head++) {
+		int cur = queue[head];
+		int cr = cur / cols, cc = cur % cols;
+		for (int d = 0; d < 4; d++) {
+			int nr = cr + DR[d], nc = cc + DC[d];
+			if (nr < 0 || nc < 0 || nr >= rows || nc >= cols) continue;
+			int n = nr * cols + nc;
+			if (!walkable[n] || dist[n] <= dist[cur] + 1) continue;
+			dist[n] = dist[cur] + 1;
+			queue.push_back(n);
+		}
+	}
+	lastUpdateCells += (int)queue.size();
+}
+
+// Tile i lost its old distance. Collect the tiles whose only shortest path
+// went through it (level by level, so a tile's support is final when it is
+// checked), forget their distances, then re-solve just that region seeded
+// from its valid border.
+void DistanceField::increase(const uint8_t* walkable, int i) {
+	if (++stamp == 0) { invalidStamp.assign(invalidStamp.size(), 0); stamp = 1; }
+
+	queue.clear();
+	queue.push_back(i);
+	invalidStamp[i] = stamp;
+	for (size_t head = 0; head < queue.size(); head++) {
+		int cur = queue[head];
+		int cr = cur / cols, cc = cur % cols;
+		for (int d = 0; d < 4; d++) {
+			int nr = cr + DR[d], nc = cc + DC[d];
+			if (nr < 0 || nc < 0 || nr >= rows || nc >= cols) continue;
+			int n = nr * cols + nc;
+			if (invalidStamp[n] == stamp || source[n] || dist[n] == UNREACHABLE || dist[n] != dist[cur] + 1) continue;
+			if (supported(walkable, n)) continue;
+			invalidStamp[n] = stamp;
+			queue.push_back(n);
+		}
+	}
+	lastUpdateCells += (int)queue.size();
+
+	open.clear();
+	auto push = [&](int32_t d, int v) {
+		open.push_back(Entry(d, v));
+		std::push_heap(open.begin(), open.end(), std::greater<Entry>());
+	};
+	for (int v : queue) {
+		dist[v] = UNREACHABLE;
+		if (!walkable[v]) continue;
+		if (source[v]) { dist[v] = 0; push(0, v); continue; }
+
+		int vr = v / cols, vc = v % cols;
+		int32_t best = UNREACHABLE;
+		for (int d = 0; d < 4; d++) {
+			int nr = vr + DR[d], nc = vc + DC[d];
+			if (nr < 0 || nc < 0 || nr >= rows || nc >= cols) continue;
+			int n = nr * cols + nc;
+			if (!walkable[n] || invalidStamp[n] == stamp || dist[n] == UNREACHABLE) continue;
+			if (dist[n] + 1 < best) best = dist[n] + 1;
+		}
+		if (best != UNREACHABLE) { dist[v] = best; push(best, v); }
+	}
+
+	while (!open.empty()) {
+		std::pop_heap(open.begin(), open.end(), std::greater<Entry>());
+		Entry e = open.back();
+		open.pop_back();
+		if (e.first != dist[e.second]) continue;
+		int vr = e.second / cols, vc = e.second % cols;
+		for (int d = 0; d < 4; d++) {
+			int nr = vr + DR[d], nc = vc + DC[d];
+			if (nr < 0 || nc < 0 || nr >= rows || nc >= cols) continue;
+			int n = nr * cols + nc;
+			if (!walkable[n] || dist[n] <= e.first + 1) continue;
+			dist[n] = e.first + 1;
+			push(dist[n], n);
+		}
+	}
+}
+
+void DistanceField::update(const uint8_t* walkable, int i, bool isSource) {
+	lastUpdateCells = 0;
+	source[i] = isSource ? 1 : 0;
+
+	int32_t local = UNREACHABLE;
+	if (walkable[i]) {
+		if (isSource) local = 0;
+		else {
+			int ir = i / cols, ic = i % cols;
+			for (int d = 0; d < 4; d++) {
+				int nr = ir + DR[d], nc = ic + DC[d];
+				if (nr < 0 || nc < 0 || nr >= rows || nc >= cols) continue;
+				int n = nr * cols + nc;
+				if (walkable[n] && dist[n] != UNREACHABLE && dist[n] + 1 < local) local = dist[n] + 1;
+			}
+		}
+	}
+
+	if (local < dist[i]) {
+		dist[i] = local;
+		relaxFrom(walkable, i);
+	} else if (local > dist[i]) {
+		increase(walkable, i);
+	}
+}
+
+bool DistanceField::nextStep(int r, int c, int& nr, int& nc) const {
+	int32_t here = at(r, c);
+	if (here == 0 || here == UNREACHABLE) return false;
+	for (int d = 0; d < 4; d++) {
+		int tr = r + DR[d], tc = c + DC[d];
+		if (tr < 0 || tc < 0 || tr >= rows || tc >= cols) continue;
+		if (at(tr, tc) == here - 1) { nr = tr; nc = tc; return true; }
+	}
+	return false;
+}
+
+void Reachability::build(const Board& board, int startR, int startC) {
+	PROFILE_SCOPE("Reachability::build");
+	rows = board.getRows();
+	cols = board.getCols();
+	startIndex = startR * cols + startC;
+	kinds.resize(rows * cols);
+	walkable.resize(rows * cols);
+
+	startTiles.assign(1, startIndex);
+	bossTiles.clear();
+	exitTiles.clear();
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			int i = r * cols + c;
+			kinds[i] = board.getTile(r, c);
+			walkable[i] = !isBlockedKind(kinds[i]);
+			if (kinds[i] == TileKind::Boss) bossTiles.push_back(i);
+			else if (kinds[i] == TileKind::Exit) exitTiles.push_back(i);
+		}
+	}
+
+	fromStart.build(rows, cols, walkable.data(), startTiles);
+	toBoss.build(rows, cols, walkable.data(), bossTiles);
+	toExit.build(rows, cols, walkable.data(), exitTiles);
+	seenStamp.assign(rows * cols, 0);
+	stamp = 0;
+	revision++;
+}
+
+void Reachability::tileChanged(const Board& board, int r, int c) {
+	PROFILE_SCOPE("Reachability::tileChanged");
+	int i = r * cols + c;
+	TileKind kind = board.getTile(r, c);
+	if (kind == kinds[i]) return;
+	kinds[i] = kind;
+	walkable[i] = !isBlockedKind(kind);
+
+	fromStart.update(walkable.data(), i, i == startIndex);
+	toBoss.update(walkable.data(), i, kind == TileKind::Boss);
+	toExit.update(walkable.data(), i, kind == TileKind::Exit);
+	revision++;
+}
+
+const std::vector<Reachability::Move>& Reachability::movesFrom(int r, int c, int movePoints) {
+	PROFILE_SCOPE("Reachability::movesFrom");
+	moves.clear();
+	if (movePoints <= 0 || r < 0 || c < 0 || r >= rows || c >= cols) return moves;
+	if (++stamp == 0) { seenStamp.assign(seenStamp.size(), 0); stamp = 1; }
+
+	// The move list doubles as the BFS queue; the start tile is only a seed
+	seenStamp[r * cols + c] = stamp;
+	auto expand = [&](Move cur) {
+		if (cur.battle || cur.steps == movePoints) return;
+		for (int d = 0; d < 4; d++) {
+			int nr = cur.r + DR[d], nc = cur.c + DC[d];
+			if (nr < 0 || nc < 0 || nr >= rows || nc >= cols) continue;
+			int n = nr * cols + nc;
+			if (!walkable[n] || seenStamp[n] == stamp) continue;
+			seenStamp[n] = stamp;
+			Move m = { nr, nc, cur.steps + 1, isCombatKind(kinds[n]) };
+			moves.push_back(m);
+		}
+	};
+	Move origin = { r, c, 0, false };
+	expand(origin);
+	for (size_t head = 0; head < moves.size(); head++) expand(moves[head]);
+	return moves;
+}
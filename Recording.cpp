@@ -0,0 +1,119 @@
+#include "include/Recording.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+
+static const size_t HEADER_SIZE = 28;
+
+static void put16(std::vector<uint8_t>& out, uint16_t v) {
+	for (int i = 0; i < 2; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t v) {
+	for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put64(std::vector<uint8_t>& out, uint64_t v) {
+	for (int i = 0; i < 8; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static uint16_t get16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint64_t get64(const uint8_t* p) { return get32(p) | ((uint64_t)get32(p + 4) << 32); }
+
+uint64_t recordingHash(const Game& game, uint16_t version) {
+	return version < 2 ? game.stateHashV1() : game.stateHash();
+}
+
+GameRecording GameRecording::capture(const Game& game) {
+	GameRecording rec;
+	rec.seed = game.getSeed();
+	rec.finalHash = game.stateHash();
+	rec.inputs = game.getInputs();
+	return rec;
+}
+
+bool GameRecording::save(const std::string& path, std::string& error) const {
+	std::vector<uint8_t> bytes;
+	bytes.reserve(HEADER_SIZE + inputs.size() * 2);
+	bytes.insert(bytes.end(), { 'R', 'R', 'E', 'C' });
+	put16(bytes, version);
+	put16(bytes, 0);
+	put64(bytes, seed);
+	put64(bytes, finalHash);
+	put32(bytes, (uint32_t)inputs.size());
+	for (const GameInput& in : inputs) {
+		bytes.push_back((uint8_t)in.kind);
+		bytes.push_back(in.value);
+	}
+
+	std::ofstream out(path, std::ios::binary);
+	if (!out.write((const char*)bytes.data(), bytes.size())) {
+		error = "cannot write " + path + ": " + std::strerror(errno);
+		return false;
+	}
+	return true;
+}
+
+bool GameRecording::fromBytes(const uint8_t* data, size_t size, std::string& error) {
+	if (size < HEADER_SIZE || data[0] != 'R' || data[1] != 'R' || data[2] != 'E' || data[3] != 'C') {
+		error = "not a recording";
+		return false;
+	}
+	uint16_t v = get16(data + 4);
+	if (v < 1 || v > RECORDING_VERSION) {
+		error = "unsupported recording version " + std::to_string(v);
+		return false;
+	}
+	version = v;
+	seed = get64(data + 8);
+	finalHash = get64(data + 16);
+	uint32_t count = get32(data + 24);
+	if (size != HEADER_SIZE + (size_t)count * 2) {
+		error = "truncated recording";
+		return false;
+	}
+	inputs.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		inputs[i].kind = (GameInputKind)data[HEADER_SIZE + i * 2];
+		inputs[i].value = data[HEADER_SIZE + i * 2 + 1];
+	}
+	return true;
+}
+
+bool GameRecording::load(const std::string& path, std::string& error) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) { error = "cannot open " + path; return false; }
+	std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	return fromBytes(bytes.data(), bytes.size(), error);
+}
+
+bool replayRecording(const GameRecording& rec, const LevelPack& levels, std::string& error) {
+	std::ostream silent(nullptr);
+	Game game(levels, rec.seed, silent);
+
+	for (size_t i = 0; i < rec.inputs.size(); i++) {
+		game.settle();
+		if (!game.apply(rec.inputs[i])) {
+			std::ostringstream msg;
+			msg << "input " << i << " of " << rec.inputs.size() << " (kind " << (int)rec.inputs[i].kind
+			    << ", value " << (int)rec.inputs[i].value << ") rejected";
+			error = msg.str();
+			return false;
+		}
+	}
+	game.settle();
+
+	uint64_t hash = recordingHash(game, rec.version);
+	if (hash != rec.finalHash) {
+		std::ostringstream msg;
+		msg << "final state differs (hash " << std::hex << hash << ", recorded " << rec.finalHash << ")";
+		error = msg.str();
+		return false;
+	}
+	return true;
+}
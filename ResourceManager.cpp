@@ -0,0 +1,147 @@
+#include "include/ResourceManager.h"
+#include "include/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+ResourceManager::ResourceManager(int workerCount) {
+	if (workerCount <= 0) workerCount = (int)std::min(4u, std::max(1u, std::thread::hardware_concurrency()));
+	for (int i = 0; i < workerCount; i++)
+		workers.emplace_back(&ResourceManager::workerLoop, this);
+}
+
+ResourceManager::~ResourceManager() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		jobs.clear();
+	}
+	jobReady.notify_all();
+	for (auto& w : workers) w.join();
+}
+
+void ResourceManager::workerLoop() {
+	for (;;) {
+		Asset* a = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobReady.wait(lock, [this]() { return stopping || !jobs.empty(); });
+			if (stopping) return;
+			a = jobs.front();
+			jobs.pop_front();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		if (a->isFont) {
+			std::ifstream f(a->path, std::ios::binary);
+			if (f) a->bytes.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+			a->ok = !a->bytes.empty();
+		} else {
+			a->ok = a->image.loadFromFile(a->path);
+		}
+		a->decodeMs = msSince(start);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			decoded.push_back(a);
+		}
+		decodedReady.notify_all();
+	}
+}
+
+void ResourceManager::enqueue(Asset* a) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(a);
+	}
+	jobReady.notify_one();
+}
+
+ResourceManager::TextureHandle ResourceManager::requestTexture(const std::string& path, const std::string& group) {
+	assets.emplace_back(new Asset());
+	Asset* a = assets.back().get();
+	a->path = path;
+	a->group = group;
+	a->texture = std::make_shared<sf::Texture>();
+	enqueue(a);
+	return a->texture;
+}
+
+ResourceManager::FontHandle ResourceManager::requestFont(const std::string& path, const std::string& group) {
+	assets.emplace_back(new Asset());
+	Asset* a = assets.back().get();
+	a->path = path;
+	a->group = group;
+	a->isFont = true;
+	a->font = std::make_shared<sf::Font>();
+	enqueue(a);
+	return a->font;
+}
+
+void ResourceManager::upload(Asset& a) {
+	auto start = std::chrono::steady_clock::now();
+	if (a.ok) {
+		if (a.isFont) a.ok = a.font->loadFromMemory(a.bytes.data(), a.bytes.size());
+		else a.ok = a.texture->loadFromImage(a.image);
+	}
+	a.image = sf::Image();
+	a.uploadMs = msSince(start);
+	a.ready = true;
+	if (!a.ok) std::cerr << "Warn: missing " << a.path << "\n";
+}
+
+void ResourceManager::pump() {
+	PROFILE_SCOPE("ResourceManager::pump");
+	std::vector<Asset*> done;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		done.swap(decoded);
+	}
+	for (Asset* a : done) upload(*a);
+}
+
+bool ResourceManager::isGroupReady(const std::string& group) const {
+	for (const auto& a : assets)
+		if (a->group == group && !a->ready) return false;
+	return true;
+}
+
+void ResourceManager::waitGroup(const std::string& group) {
+	for (;;) {
+		pump();
+		if (isGroupReady(group)) return;
+		std::unique_lock<std::mutex> lock(mutex);
+		decodedReady.wait(lock, [this]() { return !decoded.empty(); });
+	}
+}
+
+bool ResourceManager::isLoaded(const std::string& path) const {
+	for (const auto& a : assets)
+		if (a->path == path) return a->ready && a->ok;
+	return false;
+}
+
+void ResourceManager::printReport(std::ostream& out) const {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+	double decodeTotal = 0, uploadTotal = 0;
+	out << "[Assets] " << assets.size() << " assets on " << workers.size() << " worker threads\n";
+	for (const auto& a : assets) {
+		out << "[Assets]   " << std::left << std::setw(28) << a->path << std::right << std::fixed << std::setprecision(2)
+		    << " decode " << std::setw(7) << a->decodeMs << " ms  upload " << std::setw(6) << a->uploadMs << " ms"
+		    << (a->ready ? (a->ok ? "" : "  (missing)") : "  (pending)") << "\n";
+		decodeTotal += a->decodeMs;
+		uploadTotal += a->uploadMs;
+	}
+	out << "[Assets] decode total " << decodeTotal << " ms (spread over workers), upload total " << uploadTotal << " ms\n";
+	out.flags(flags);
+	out.precision(precision);
+}
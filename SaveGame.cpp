@@ -0,0 +1,393 @@
+#include "include/SaveGame.h"
+#include "include/Game.h"
+#include "include/CombatSystem.h"
+#include "include/Profiler.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const size_t HEADER_SIZE = 20;
+static const size_t OLD_HEADER_SIZE = 16;	// versions 1 and 2: no pack checksum
+static const uint8_t NO_CLASS = 0xFF;
+
+static void put8(std::vector<uint8_t>& out, uint8_t v) { out.push_back(v); }
+
+static void put16(std::vector<uint8_t>& out, uint16_t v) {
+	for (int i = 0; i < 2; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t v) {
+	for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put64(std::vector<uint8_t>& out, uint64_t v) {
+	for (int i = 0; i < 8; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static uint32_t fnv1a(const uint8_t* p, size_t n) {
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < n; i++) { h ^= p[i]; h *= 16777619u; }
+	return h;
+}
+
+// Bounds-checked little-endian cursor: reading past the end yields zeros
+// and clears `ok`, so the parser only needs to check once, at the end.
+struct SaveReader {
+	const uint8_t* p;
+	size_t left;
+	bool ok = true;
+
+	SaveReader(const uint8_t* data, size_t size) : p(data), left(size) {}
+
+	bool take(size_t n) {
+		if (n > left) { ok = false; left = 0; return false; }
+		return true;
+	}
+	uint8_t get8() {
+		if (!take(1)) return 0;
+		left -= 1;
+		return *p++;
+	}
+	uint16_t get16() {
+		if (!take(2)) return 0;
+		uint16_t v = (uint16_t)(p[0] | (p[1] << 8));
+		p += 2; left -= 2;
+		return v;
+	}
+	uint32_t get32() {
+		if (!take(4)) return 0;
+		uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+		p += 4; left -= 4;
+		return v;
+	}
+	uint64_t get64() {
+		uint64_t lo = get32();
+		return lo | ((uint64_t)get32() << 32);
+	}
+};
+
+struct SavedEntity {
+	int32_t hp = 0, maxHp = 0, attack = 0, defense = 0, mana = 0;
+	bool defending = false;
+	StatusEffects effects;
+	bool effectsOk = true;
+};
+
+static void putEntity(std::vector<uint8_t>& out, const Entity& e) {
+	put32(out, (uint32_t)e.hp);
+	put32(out, (uint32_t)e.maxHp);
+	put32(out, (uint32_t)e.attack);
+	put32(out, (uint32_t)e.defense);
+	put32(out, (uint32_t)e.mana);
+	put8(out, e.defending);
+	put8(out, e.effects.activeMask());
+	for (int k = 1; k < EFFECT_KIND_COUNT; k++) {
+		if (!e.effects.has((EffectKind)k)) continue;
+		const StatusEffect& fx = e.effects.get((EffectKind)k);
+		put8(out, fx.turns);
+		put16(out, (uint16_t)fx.power);
+	}
+}
+
+static SavedEntity getEntity(SaveReader& in, uint16_t version) {
+	SavedEntity e;
+	e.hp = (int32_t)in.get32();
+	e.maxHp = (int32_t)in.get32();
+	e.attack = (int32_t)in.get32();
+	e.defense = (int32_t)in.get32();
+	e.mana = (int32_t)in.get32();
+	e.defending = in.get8() != 0;
+	if (version < 2) return e;
+	uint8_t mask = in.get8();
+	if ((mask & 1) || (mask >> EFFECT_KIND_COUNT)) e.effectsOk = false;	// no None, no unknown kinds
+	for (int k = 1; k < EFFECT_KIND_COUNT; k++) {
+		if (!((mask >> k) & 1)) continue;
+		StatusEffect fx;
+		fx.kind = (EffectKind)k;
+		fx.turns = in.get8();
+		fx.power = (int16_t)in.get16();
+		if (fx.turns == 0) e.effectsOk = false;
+		e.effects.apply(fx);
+	}
+	return e;
+}
+
+static void applyEntity(Entity& e, const SavedEntity& s) {
+	e.hp = s.hp; e.maxHp = s.maxHp;
+	e.attack = s.attack; e.defense = s.defense;
+	e.mana = s.mana; e.defending = s.defending;
+	e.effects = s.effects;
+}
+
+void Game::saveSnapshot(std::vector<uint8_t>& out) const {
+	PROFILE_SCOPE("Game::saveSnapshot");
+	out.clear();
+	out.reserve(HEADER_SIZE + 160 + inputs.size() * 2 + clearedTiles.size() * 4 + CombatLog::CAPACITY * 11);
+	for (char ch : { 'R', 'S', 'A', 'V' }) put8(out, (uint8_t)ch);
+	put16(out, SAVE_VERSION);
+	put16(out, 0);
+	put32(out, 0);	// payload size and checksum, filled in below
+	put32(out, 0);
+	put32(out, levels.checksum());
+
+	// Run
+	put64(out, seed);
+	for (int i = 0; i < 4; i++) put32(out, rng.state()[i]);
+	put8(out, (uint8_t)state);
+	put16(out, (uint16_t)levelIndex);
+	put8(out, (uint8_t)movePoints);
+	put8(out, levelBossDefeated);
+	put32(out, (uint32_t)inputs.size());
+	for (const GameInput& in : inputs) {
+		put8(out, (uint8_t)in.kind);
+		put8(out, in.value);
+	}
+
+	// Level: only what differs from the pack
+	put16(out, (uint16_t)board.getRows());
+	put16(out, (uint16_t)board.getCols());
+	put32(out, (uint32_t)clearedTiles.size());
+	for (uint32_t cell : clearedTiles) put32(out, cell);
+
+	// Player
+	put8(out, player ? (uint8_t)playerClass : NO_CLASS);
+	if (player) {
+		putEntity(out, *player);
+		put16(out, (uint16_t)player->posR);
+		put16(out, (uint16_t)player->posC);
+	}
+
+	// Battle in progress
+	put8(out, currentEnemy != nullptr);
+	if (currentEnemy) {
+		put8(out, (uint8_t)enemyKind);
+		put8(out, isFightingLevelBoss);
+		putEntity(out, *currentEnemy);
+		put16(out, (uint16_t)enemyRow);
+		put16(out, (uint16_t)enemyCol);
+		put8(out, enemyTurnPending);
+		put8(out, battleOver);
+		uint32_t delayBits;
+		std::memcpy(&delayBits, &battleDelayTimer, 4);
+		put32(out, delayBits);
+		put64(out, battleMessageStart);
+	}
+
+	// Log: every event the ring still holds, for the battle screen
+	put64(out, battleLog.end());
+	put16(out, (uint16_t)(battleLog.end() - battleLog.begin()));
+	for (uint64_t seq = battleLog.begin(); seq < battleLog.end(); seq++) {
+		const CombatEvent& e = battleLog.at(seq);
+		put8(out, (uint8_t)e.type);
+		put8(out, e.actor);
+		put8(out, e.aux);
+		put32(out, (uint32_t)e.a);
+		put32(out, (uint32_t)e.b);
+	}
+
+	uint32_t payload = (uint32_t)(out.size() - HEADER_SIZE);
+	uint32_t checksum = fnv1a(out.data() + HEADER_SIZE, payload);
+	for (int i = 0; i < 4; i++) {
+		out[8 + i] = (uint8_t)(payload >> (8 * i));
+		out[12 + i] = (uint8_t)(checksum >> (8 * i));
+	}
+}
+
+bool Game::loadSnapshot(const uint8_t* data, size_t size, std::string& error) {
+	PROFILE_SCOPE("Game::loadSnapshot");
+	if (size < OLD_HEADER_SIZE || std::memcmp(data, "RSAV", 4) != 0) {
+		error = "not a save file";
+		return false;
+	}
+	SaveReader header(data + 4, size - 4);
+	uint16_t version = header.get16();
+	header.get16();
+	uint32_t payload = header.get32();
+	uint32_t checksum = header.get32();
+	if (version < 1 || version > SAVE_VERSION) {
+		error = "unsupported save version " + std::to_string(version);
+		return false;
+	}
+	// Before version 3 there is no pack checksum: those saves only get the
+	// level size checks below
+	size_t headerSize = version < 3 ? OLD_HEADER_SIZE : HEADER_SIZE;
+	uint32_t packChecksum = version < 3 ? levels.checksum() : header.get32();
+	if (size < headerSize || payload != size - headerSize) {
+		error = "truncated save";
+		return false;
+	}
+	if (fnv1a(data + headerSize, payload) != checksum) {
+		error = "save checksum mismatch";
+		return false;
+	}
+	if (packChecksum != levels.checksum()) {
+		error = "save is for a different level pack";
+		return false;
+	}
+
+	// Parse and validate everything before touching the game
+	SaveReader in(data + headerSize, payload);
+	uint64_t savedSeed = in.get64();
+	uint32_t rngState[4];
+	for (int i = 0; i < 4; i++) rngState[i] = in.get32();
+	uint8_t savedState = in.get8();
+	int savedLevel = in.get16();
+	int savedMovePoints = in.get8();
+	bool savedBossDefeated = in.get8() != 0;
+	uint32_t inputCount = in.get32();
+	if (!in.take((size_t)inputCount * 2)) { error = "truncated save"; return false; }
+	std::vector<GameInput> savedInputs(inputCount);
+	for (GameInput& gi : savedInputs) {
+		gi.kind = (GameInputKind)in.get8();
+		gi.value = in.get8();
+	}
+
+	if (savedState > (uint8_t)GameState::Victory) { error = "invalid game state"; return false; }
+	if ((rngState[0] | rngState[1] | rngState[2] | rngState[3]) == 0) { error = "invalid dice state"; return false; }
+	if (savedLevel >= levels.count()) { error = "save is for a level this pack does not have"; return false; }
+	const LevelView& lvl = levels.level(savedLevel);
+
+	int rows = in.get16(), cols = in.get16();
+	if (rows != lvl.rows || cols != lvl.cols) { error = "save does not match this level pack"; return false; }
+	uint32_t clearedCount = in.get32();
+	if (!in.take((size_t)clearedCount * 4)) { error = "truncated save"; return false; }
+	std::vector<uint32_t> savedCleared(clearedCount);
+	for (uint32_t& cell : savedCleared) {
+		cell = in.get32();
+		if (cell >= (uint32_t)(rows * cols)) { error = "cleared tile out of bounds"; return false; }
+	}
+
+	uint8_t cls = in.get8();
+	SavedEntity savedPlayer;
+	int posR = 0, posC = 0;
+	if (cls != NO_CLASS) {
+		if (cls >= PLAYER_CLASS_COUNT) { error = "invalid player class"; return false; }
+		savedPlayer = getEntity(in, version);
+		if (!savedPlayer.effectsOk) { error = "invalid status effects"; return false; }
+		posR = in.get16(); posC = in.get16();
+		if (posR >= rows || posC >= cols) { error = "player out of bounds"; return false; }
+	} else if (savedState != (uint8_t)GameState::MainMenu) {
+		error = "save has no player";
+		return false;
+	}
+
+	bool inBattle = in.get8() != 0;
+	if (inBattle != (savedState == (uint8_t)GameState::InBattle)) { error = "inconsistent battle state"; return false; }
+	uint8_t kind = 0;
+	bool savedIsBoss = false, savedTurnPending = false, savedBattleOver = false;
+	SavedEntity savedEnemy;
+	int row = -1, col = -1;
+	float delay = 0.f;
+	uint64_t messageStart = 0;
+	if (inBattle) {
+		kind = in.get8();
+		savedIsBoss = in.get8() != 0;
+		savedEnemy = getEntity(in, version);
+		if (!savedEnemy.effectsOk) { error = "invalid status effects"; return false; }
+		row = in.get16(); col = in.get16();
+		savedTurnPending = in.get8() != 0;
+		savedBattleOver = in.get8() != 0;
+		uint32_t delayBits = in.get32();
+		std::memcpy(&delay, &delayBits, 4);
+		messageStart = in.get64();
+		if (kind > (uint8_t)EnemyKind::Boss) { error = "invalid enemy kind"; return false; }
+		if (row >= rows || col >= cols) { error = "enemy out of bounds"; return false; }
+	}
+
+	uint64_t logEnd = in.get64();
+	int held = in.get16();
+	if (held > CombatLog::CAPACITY || (uint64_t)held > logEnd) { error = "invalid battle log"; return false; }
+	CombatEvent events[CombatLog::CAPACITY];
+	for (int i = 0; i < held; i++) {
+		events[i].type = (CombatEventType)in.get8();
+		events[i].actor = in.get8();
+		events[i].aux = in.get8();
+		events[i].a = (int32_t)in.get32();
+		events[i].b = (int32_t)in.get32();
+	}
+	if (!in.ok || in.left != 0) { error = "malformed save"; return false; }
+
+	// Apply
+	encounters.end();
+	currentEnemy = nullptr;
+	combatSystem = nullptr;
+	seed = savedSeed;
+	rng.setState(rngState);
+	inputs = std::move(savedInputs);
+	loadLevel(savedLevel);
+	clearedTiles = std::move(savedCleared);
+	for (uint32_t cell : clearedTiles) {
+		board.replaceWithEmpty(cell / cols, cell % cols);
+		reach.tileChanged(board, cell / cols, cell % cols);
+	}
+	movePoints = savedMovePoints;
+	levelBossDefeated = savedBossDefeated;
+
+	player.reset();
+	if (cls != NO_CLASS) {
+		playerClass = (PlayerClass)cls;
+		player.emplace(playerClass, posR, posC);
+		applyEntity(*player, savedPlayer);
+	}
+
+	battleLog.clear(logEnd - held);
+	for (int i = 0; i < held; i++) {
+		const CombatEvent& e = events[i];
+		battleLog.push(e.type, e.actor, e.a, e.b, e.aux);
+	}
+
+	state = (GameState)savedState;
+	enemyTurnPending = savedTurnPending;
+	battleOver = savedBattleOver;
+	battleDelayTimer = delay;
+	battleMessageStart = messageStart;
+	isFightingLevelBoss = savedIsBoss;
+	enemyRow = row; enemyCol = col;
+	if (inBattle) {
+		enemyKind = (EnemyKind)kind;
+		currentEnemy = encounters.begin(enemyKind, levelIndex, &*player, battleLog);
+		combatSystem = encounters.getCombat();
+		applyEntity(*currentEnemy, savedEnemy);
+		board.enter(row, col);
+	}
+	return true;
+}
+
+bool readSaveFile(const std::string& path, std::vector<uint8_t>& out, std::string& error) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) { error = "cannot open " + path; return false; }
+	out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	return true;
+}
+
+bool writeSaveFile(const std::string& path, const std::vector<uint8_t>& bytes, std::string& error) {
+	std::string tmp = path + ".tmp";
+	std::FILE* f = std::fopen(tmp.c_str(), "wb");
+	if (!f) { error = "cannot write " + tmp; return false; }
+	// The data must be on disk before the rename is, or a crash can leave
+	// the new name pointing at an empty file
+	bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size() && std::fflush(f) == 0;
+#ifdef _WIN32
+	ok = ok && _commit(_fileno(f)) == 0;
+#else
+	ok = ok && fsync(fileno(f)) == 0;
+#endif
+	if (std::fclose(f) != 0 || !ok) {
+		error = "cannot write " + tmp;
+		std::remove(tmp.c_str());
+		return false;
+	}
+	if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+		error = "cannot replace " + path;
+		return false;
+	}
+	return true;
+}
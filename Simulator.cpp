@@ -0,0 +1,239 @@
+#include "include/Simulator.h"
+#include "include/CombatSystem.h"
+#include "include/CombatAI.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static int hpBucket(int hp, int maxHp) {
+	if (maxHp <= 0) return 0;
+	int b = hp * 10 / maxHp;
+	return std::min(std::max(b, 0), MatchupStats::HP_BUCKETS - 1);
+}
+
+void MatchupStats::add(const BattleResult& r, int playerMaxHp, int enemyMaxHp) {
+	battles++;
+	totalTurns += r.turns;
+	playerRolls += r.playerRolls;
+	playerHits += r.playerHits;
+	playerCrits += r.playerCrits;
+	enemyHits += r.enemyHits;
+	turnHist[std::min(r.turns, TURN_BUCKETS - 1)]++;
+	if (r.playerWon) {
+		wins++;
+		playerHpHist[hpBucket(r.playerHp, playerMaxHp)]++;
+	} else if (r.fled) {
+		flees++;
+	} else if (r.playerHp > 0) {
+		timeouts++;
+	} else {
+		enemyHpHist[hpBucket(r.enemyHp, enemyMaxHp)]++;
+	}
+}
+
+void MatchupStats::merge(const MatchupStats& o) {
+	battles += o.battles;
+	wins += o.wins;
+	timeouts += o.timeouts;
+	flees += o.flees;
+	totalTurns += o.totalTurns;
+	playerRolls += o.playerRolls;
+	playerHits += o.playerHits;
+	playerCrits += o.playerCrits;
+	enemyHits += o.enemyHits;
+	for (int i = 0; i < TURN_BUCKETS; i++) turnHist[i] += o.turnHist[i];
+	for (int i = 0; i < HP_BUCKETS; i++) {
+		playerHpHist[i] += o.playerHpHist[i];
+		enemyHpHist[i] += o.enemyHpHist[i];
+	}
+}
+
+int MatchupStats::turnPercentile(double p) const {
+	long long target = (long long)(p * battles);
+	long long seen = 0;
+	for (int i = 0; i < TURN_BUCKETS; i++) {
+		seen += turnHist[i];
+		if (seen > target) return i;
+	}
+	return TURN_BUCKETS - 1;
+}
+
+int MatchupStats::hpPercentile(const long long* hist, double p) const {
+	long long total = 0;
+	for (int i = 0; i < HP_BUCKETS; i++) total += hist[i];
+	if (total == 0) return 0;
+	long long target = (long long)(p * total);
+	long long seen = 0;
+	for (int i = 0; i < HP_BUCKETS; i++) {
+		seen += hist[i];
+		if (seen > target) return i * 10;
+	}
+	return 100;
+}
+
+Enemy* makeEnemy(EnemyKind kind, int levelIndex) {
+	switch (kind) {
+		case EnemyKind::Goblin: return new Monster(makeGoblin(levelIndex));
+		case EnemyKind::Ogre:   return new Monster(makeOgre(levelIndex));
+		case EnemyKind::Boss:   return new Boss(makeLevelBoss(levelIndex));
+	}
+	return nullptr;
+}
+
+const char* playerClassName(PlayerClass cls) {
+	return classDef(cls).name;
+}
+
+const char* enemyKindName(EnemyKind kind) {
+	switch (kind) {
+		case EnemyKind::Goblin: return "Goblin";
+		case EnemyKind::Ogre:   return "Ogre";
+		case EnemyKind::Boss:   return "Boss";
+	}
+	return "?";
+}
+
+static void tallyEvents(const CombatLog& log, uint64_t from, BattleResult& r) {
+	for (uint64_t seq = from; seq < log.end(); seq++) {
+		const CombatEvent& e = log.at(seq);
+		bool byPlayer = e.actor == SIDE_PLAYER;
+		switch (e.type) {
+			case CombatEventType::Roll:
+				if (byPlayer && (RollKind)e.aux != RollKind::Run) r.playerRolls++;
+				break;
+			case CombatEventType::Hit:
+			case CombatEventType::AbilityHit:
+				if (byPlayer) r.playerHits++;
+				else r.enemyHits++;
+				break;
+			case CombatEventType::Crit:
+				if (byPlayer) r.playerCrits++;
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+// One search engine per worker thread; its table carries over between
+// battles of the same matchup (or the same run).
+static CombatAI& searchAI() {
+	CombatAIConfig config;
+	config.budgetMs = 0;
+	config.maxDepth = SEARCH_POLICY_DEPTH;
+	config.tableBits = 16;
+	static thread_local CombatAI ai(config);
+	return ai;
+}
+
+int simPolicyAbility(const Player& player, const Enemy& enemy, SimPolicy policy) {
+	if (policy == SimPolicy::Effects) {
+		for (int i = player.abilityCount() - 1; i > 0; i--) {
+			const SpecialAttributes& a = player.ability(i);
+			if (a.effect.kind == EffectKind::None || player.mana < a.manaCost) continue;
+			// Shields and guards only once hurt, or they crowd out the damage
+			bool self = effectOnSelf(a.effect.kind);
+			if (self && player.hp * 2 > player.maxHp) continue;
+			if (!(self ? (const Entity&)player : enemy).effects.has(a.effect.kind)) return i;
+		}
+	}
+	if (policy != SimPolicy::Attack && player.abilityCount() > 0 && player.mana >= player.ability(0).manaCost)
+		return 0;
+	return -1;
+}
+
+CombatAction simPolicyAction(const Player& player, const Enemy& enemy, SimPolicy policy, int* ability) {
+	// CombatAI plans with ability 0 only
+	if (policy == SimPolicy::Search) {
+		if (ability) *ability = 0;
+		return searchAI().decide(makeCombatSnapshot(player, enemy)).action;
+	}
+	int index = simPolicyAbility(player, enemy, policy);
+	if (ability) *ability = std::max(index, 0);
+	return index >= 0 ? CombatAction::Ability : CombatAction::Attack;
+}
+
+const char* simPolicyName(SimPolicy policy) {
+	switch (policy) {
+		case SimPolicy::Attack:  return "attack";
+		case SimPolicy::Ability: return "ability";
+		case SimPolicy::Search:  return "search";
+		case SimPolicy::Effects: return "effects";
+	}
+	return "?";
+}
+
+BattleResult simulateBattle(Player& player, Enemy& enemy, SimPolicy policy, int maxTurns) {
+	CombatSystem combat(&player, &enemy);
+	CombatLog& log = combat.getLog();
+	BattleResult result;
+	player.resetStatus();
+	enemy.resetStatus();
+
+	// A round records at most a dozen events, far below the ring's capacity
+	while (result.turns < maxTurns) {
+		uint64_t roundStart = log.end();
+		result.turns++;
+
+		int ability = 0;
+		switch (simPolicyAction(player, enemy, policy, &ability)) {
+			case CombatAction::Attack:  combat.attack(); break;
+			case CombatAction::Ability: combat.ability(ability); break;
+			case CombatAction::Defend:  combat.defend(); break;
+			case CombatAction::Run:     result.fled = combat.run(); break;
+		}
+		if (result.fled) {
+			tallyEvents(log, roundStart, result);
+			break;
+		}
+
+		if (!combat.isEnemyDefeated()) combat.enemyTurn();
+		tallyEvents(log, roundStart, result);
+		if (combat.isEnemyDefeated() || combat.isPlayerDefeated()) break;
+	}
+
+	result.playerWon = combat.isEnemyDefeated();
+	result.playerHp = player.hp;
+	result.enemyHp = enemy.hp;
+	return result;
+}
+
+MatchupStats runMatchup(PlayerClass cls, EnemyKind kind, int levelIndex,
+                        long long battles, SimPolicy policy, int threads,
+                        uint64_t seed) {
+	if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = (int)std::min<long long>(threads, std::max(1LL, battles));
+
+	std::vector<MatchupStats> partial(threads);
+	std::vector<std::thread> workers;
+
+	long long first = 0;
+	for (int t = 0; t < threads; t++) {
+		long long count = battles / threads + (t < battles % threads ? 1 : 0);
+		workers.emplace_back([&, t, first, count]() {
+			Player player(cls, 0, 0);
+			std::unique_ptr<Enemy> enemy(makeEnemy(kind, levelIndex));
+			MatchupStats& stats = partial[t];
+
+			for (long long i = 0; i < count; i++) {
+				player.hp = player.maxHp;
+				player.mana = player.getClassDef().mana;
+				enemy->hp = enemy->maxHp;
+				enemy->resetStatus();
+
+				Rng battleRng(seed, (uint64_t)(first + i));
+				RngScope scope(battleRng);
+				BattleResult r = simulateBattle(player, *enemy, policy);
+				stats.add(r, player.maxHp, enemy->maxHp);
+			}
+		});
+		first += count;
+	}
+	for (auto& w : workers) w.join();
+
+	MatchupStats total;
+	for (const auto& s : partial) total.merge(s);
+	return total;
+}
@@ -0,0 +1,51 @@
+#include "include/StatusEffects.h"
+
+#include <algorithm>
+
+const char* effectName(EffectKind k) {
+	switch (k) {
+		case EffectKind::Poison: return "Poison";
+		case EffectKind::Stun:   return "Stun";
+		case EffectKind::Shield: return "Shield";
+		case EffectKind::Guard:  return "Guard";
+		default:                 return "None";
+	}
+}
+
+void StatusEffects::apply(const StatusEffect& e) {
+	if (e.kind == EffectKind::None || (int)e.kind >= EFFECT_KIND_COUNT || e.turns == 0) return;
+	StatusEffect& slot = slots[(int)e.kind - 1];
+	if (has(e.kind)) {
+		slot.turns = std::max(slot.turns, e.turns);
+		slot.power = std::max(slot.power, e.power);
+	} else {
+		slot = e;
+		active |= (uint8_t)(1 << (int)e.kind);
+	}
+}
+
+EffectTick StatusEffects::tick() {
+	EffectTick t;
+	if (!active) return t;
+	for (int i = 0; i < CAPACITY; i++) {
+		uint8_t bit = (uint8_t)(2 << i);
+		if (!(active & bit)) continue;
+		StatusEffect& e = slots[i];
+		if (e.kind == EffectKind::Poison) t.poison += e.power;
+		else if (e.kind == EffectKind::Stun) t.stunned = true;
+		if (--e.turns == 0) {
+			active &= (uint8_t)~bit;
+			t.expired |= bit;
+		}
+	}
+	return t;
+}
+
+int StatusEffects::absorb(int dmg) {
+	if (!has(EffectKind::Shield) || dmg <= 0) return 0;
+	StatusEffect& s = slots[(int)EffectKind::Shield - 1];
+	int taken = std::min<int>(dmg, s.power);
+	s.power = (int16_t)(s.power - taken);
+	if (s.power <= 0) active &= (uint8_t)~(1 << (int)EffectKind::Shield);
+	return taken;
+}
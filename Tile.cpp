@@ -1,27 +1,11 @@
 #include "include/Tile.h"
-#include <iostream>
 
-void EmptyTile::onEnter(Player* p) {
-	(void)p;
-}
-
-void MonsterTile::onEnter(Player* p) {
-	(void)p;
-	if (!combatTriggered) {
-		std::cout << "[Event] Monster encountered (board)\n";
-		combatTriggered = true;
-	}
-}
-
-void BossTile::onEnter(Player* p) {
-	(void)p;
-	if (!combatTriggered) {
-		std::cout << "[Event] BOSS encountered (board)\n";
-		combatTriggered = true;
+TileKind tileKindFromChar(char ch) {
+	switch (ch) {
+		case 'B': return TileKind::Blocked;
+		case 'M': return TileKind::Monster;
+		case 'T': return TileKind::Boss;
+		case 'E': return TileKind::Exit;
+		default:  return TileKind::Empty;
 	}
 }
-
-void ExitTile::onEnter(Player* p) {
-	(void)p;
-	std::cout << "[Event] Exit reached\n";
-}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "include/TileBitboard.h"
+
+#include <algorithm>
+
+void TileBitboard::reset(int r, int c) {
+	rows = r;
+	cols = c;
+	words = (c + 63) / 64;
+	bits.assign((size_t)rows * words, 0);
+	scratch.resize((size_t)words * 2);
+}
+
+void TileBitboard::setOpen(int r, int c, const TileKind* tiles) {
+	reset(r, c);
+	for (int y = 0; y < rows; y++) {
+		uint64_t* row = &bits[(size_t)y * words];
+		const TileKind* t = tiles + (size_t)y * cols;
+		for (int x = 0; x < cols; x++)
+			if (!isBlockedKind(t[x])) row[x >> 6] |= 1ull << (x & 63);
+	}
+}
+
+// Multi-word shifts of one row by k < cols cells, towards higher columns
+// (up) or lower ones; bits shifted past either end are dropped.
+static void shiftUp(const uint64_t* src, uint64_t* dst, int words, int k) {
+	int q = k >> 6, s = k & 63;
+	for (int w = words - 1; w >= 0; w--) {
+		uint64_t v = 0;
+		if (w - q >= 0) v = src[w - q] << s;
+		if (s && w - q - 1 >= 0) v |= src[w - q - 1] >> (64 - s);
+		dst[w] = v;
+	}
+}
+
+static void shiftDown(const uint64_t* src, uint64_t* dst, int words, int k) {
+	int q = k >> 6, s = k & 63;
+	for (int w = 0; w < words; w++) {
+		uint64_t v = 0;
+		if (w + q < words) v = src[w + q] >> s;
+		if (s && w + q + 1 < words) v |= src[w + q + 1] << (64 - s);
+		dst[w] = v;
+	}
+}
+
+// Occluded (Kogge-Stone) fill of one row in both directions: after the step
+// with shift k, `row` holds every open cell fewer than 2k moves from a set
+// one along the row, so a row of n cells takes log2(n) steps each way.
+void TileBitboard::fillRow(uint64_t* row, const uint64_t* open) {
+	if (words == 1) {
+		uint64_t gen = *row, pro = *open;
+		for (int k = 1; k < cols; k <<= 1) { gen |= pro & (gen << k); pro &= pro << k; }
+		pro = *open;
+		for (int k = 1; k < cols; k <<= 1) { gen |= pro & (gen >> k); pro &= pro >> k; }
+		*row = gen;
+		return;
+	}
+
+	uint64_t* pro = scratch.data();
+	uint64_t* tmp = pro + words;
+	for (int dir = 0; dir < 2; dir++) {
+		auto shift = dir == 0 ? shiftUp : shiftDown;
+		std::copy(open, open + words, pro);
+		for (int k = 1; k < cols; k <<= 1) {
+			shift(row, tmp, words, k);
+			for (int w = 0; w < words; w++) row[w] |= pro[w] & tmp[w];
+			shift(pro, tmp, words, k);
+			for (int w = 0; w < words; w++) pro[w] &= tmp[w];
+		}
+	}
+}
+
+// One pass over the rows, top to bottom or back: each row takes in the open
+// cells under its (already updated) neighbour and is re-filled if that added
+// anything. Returns whether any row grew.
+bool TileBitboard::sweep(const TileBitboard& open, bool down) {
+	bool grew = false;
+	for (int i = 1; i < rows; i++) {
+		int r = down ? i : rows - 1 - i;
+		uint64_t* row = &bits[(size_t)r * words];
+		const uint64_t* prev = &bits[(size_t)(down ? r - 1 : r + 1) * words];
+		const uint64_t* mask = &open.bits[(size_t)r * words];
+
+		bool added = false;
+		for (int w = 0; w < words; w++) {
+			uint64_t in = prev[w] & mask[w] & ~row[w];
+			if (in) { row[w] |= in; added = true; }
+		}
+		if (added) {
+			fillRow(row, mask);
+			grew = true;
+		}
+	}
+	return grew;
+}
+
+void TileBitboard::floodFill(const TileBitboard& open) {
+	for (int r = 0; r < rows; r++) {
+		uint64_t* row = &bits[(size_t)r * words];
+		const uint64_t* mask = &open.bits[(size_t)r * words];
+		bool any = false;
+		for (int w = 0; w < words; w++) any |= (row[w] &= mask[w]) != 0;
+		if (any) fillRow(row, mask);
+	}
+	// Vertical moves travel a whole sweep at a time; only paths that keep
+	// turning back need more than one round
+	bool grew;
+	do {
+		grew = sweep(open, true);
+		grew = sweep(open, false) || grew;
+	} while (grew);
+}
+
+bool levelIsConnected(int rows, int cols, const TileKind* tiles, int startR, int startC) {
+	static thread_local TileBitboard open, reach;
+	open.setOpen(rows, cols, tiles);
+	reach.reset(rows, cols);
+	reach.set(startR, startC);
+	reach.floodFill(open);
+
+	for (int r = 0; r < rows; r++) {
+		const TileKind* t = tiles + (size_t)r * cols;
+		for (int c = 0; c < cols; c++)
+			if ((t[c] == TileKind::Boss || t[c] == TileKind::Exit) && !reach.test(r, c)) return false;
+	}
+	return true;
+}
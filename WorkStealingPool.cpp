@@ -0,0 +1,102 @@
+#include "include/WorkStealingPool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int count) {
+	if (count <= 0) count = (int)std::max(1u, std::thread::hardware_concurrency());
+	workerCount = count;
+	slots.reset(new Slot[count]);
+	for (int w = 0; w < count; w++)
+		threads.emplace_back([this, w]() { workerLoop(w); });
+}
+
+WorkStealingPool::~WorkStealingPool() {
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = true;
+	}
+	jobStart.notify_all();
+	for (auto& t : threads) t.join();
+}
+
+bool WorkStealingPool::takeOwn(int worker, long long& begin, long long& end) {
+	Slot& own = slots[worker];
+	std::lock_guard<std::mutex> lock(own.mutex);
+	if (own.begin >= own.end) return false;
+	begin = own.begin;
+	end = std::min(own.begin + grain, own.end);
+	own.begin = end;
+	return true;
+}
+
+// Only the owner ever adds work to a slot, and it only steals once its own
+// slot is empty, so the stolen range can simply replace it.
+bool WorkStealingPool::steal(int worker) {
+	for (int k = 1; k < workerCount; k++) {
+		Slot& victim = slots[(worker + k) % workerCount];
+		long long begin, end;
+		{
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			long long left = victim.end - victim.begin;
+			if (left <= 0) continue;
+			begin = victim.begin + left / 2;	// a single index is taken whole
+			end = victim.end;
+			victim.end = begin;
+		}
+		Slot& own = slots[worker];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		own.begin = begin;
+		own.end = end;
+		return true;
+	}
+	return false;
+}
+
+void WorkStealingPool::workerLoop(int worker) {
+	uint64_t seen = 0;
+	for (;;) {
+		const RangeFn* fn;
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobStart.wait(lock, [&]() { return stopping || jobGeneration != seen; });
+			if (stopping) return;
+			seen = jobGeneration;
+			fn = job;
+		}
+
+		long long begin, end, stolen = 0;
+		for (;;) {
+			if (takeOwn(worker, begin, end)) {
+				(*fn)(worker, begin, end);
+				continue;
+			}
+			// A worker that finds nothing anywhere is done: ranges only move
+			// between workers that are still running, never back to it.
+			if (!steal(worker)) break;
+			stolen++;
+		}
+
+		std::lock_guard<std::mutex> lock(jobMutex);
+		steals += stolen;
+		if (--running == 0) jobDone.notify_all();
+	}
+}
+
+void WorkStealingPool::parallelFor(long long count, long long g, const RangeFn& fn) {
+	std::unique_lock<std::mutex> lock(jobMutex);
+	steals = 0;
+	if (count <= 0) return;
+
+	for (int w = 0; w < workerCount; w++) {
+		std::lock_guard<std::mutex> slotLock(slots[w].mutex);
+		slots[w].begin = count * w / workerCount;
+		slots[w].end = count * (w + 1) / workerCount;
+	}
+	job = &fn;
+	grain = std::max(1LL, g);
+	running = workerCount;
+	jobGeneration++;
+	jobStart.notify_all();
+	jobDone.wait(lock, [&]() { return running == 0; });
+	job = nullptr;
+}
@@ -0,0 +1,12 @@
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+#include <cstdint>
+
+// Calls to operator new since startup, across all threads. Only programs
+// that link AllocCounter.cpp (the game with ROGUE_COUNT_ALLOCS, and the
+// allocs tool) replace operator new and get real numbers; everything else
+// gets the fallback in AllocStats.cpp, which always returns 0.
+uint64_t heapAllocations();
+
+#endif
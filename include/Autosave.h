@@ -0,0 +1,51 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes snapshots to one save file on a background thread, so the frame
+// that takes a snapshot only pays for serializing it. Only the newest
+// snapshot matters: one submitted while the previous is still being
+// written replaces any that is still waiting.
+class Autosave {
+private:
+	std::string path;
+	std::vector<uint8_t> pending, writing;
+	bool hasPending = false;
+	bool busy = false;				// worker is writing `writing`
+	bool stopping = false;
+	std::mutex mutex;
+	std::condition_variable wake, idle;
+	std::thread worker;
+
+	// Written by the worker, read under the mutex
+	int saves = 0, failures = 0;
+	double lastWriteMs = 0;
+	std::string lastError;
+
+	void workerLoop();
+public:
+	explicit Autosave(std::string path);
+	// Finishes the pending write before returning.
+	~Autosave();
+	Autosave(const Autosave&) = delete;
+	Autosave& operator=(const Autosave&) = delete;
+
+	// Queues `bytes` for writing. The caller's vector is swapped with a
+	// spare buffer, so keeping one vector for every snapshot reuses memory.
+	void submit(std::vector<uint8_t>& bytes);
+	// Blocks until everything submitted so far is on disk.
+	void flush();
+
+	const std::string& getPath() const { return path; }
+	// Saves written, failures, last write time and last error.
+	void printReport(std::ostream& out);
+};
+
+#endif
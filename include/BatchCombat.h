@@ -0,0 +1,84 @@
+#ifndef BATCHCOMBAT_H
+#define BATCHCOMBAT_H
+
+#include <cstdint>
+#include <vector>
+#include "CombatOdds.h"
+#include "Simulator.h"
+
+enum class BatchKernel {
+	Auto,		// AVX2 when the CPU has it, else Scalar
+	Scalar,
+	AVX2
+};
+
+// Many independent battles stored as parallel arrays (one element per
+// battle), played to the end by a kernel that needs no Entity objects,
+// virtual calls or logging. The AVX2 kernel runs 8 battles per instruction
+// with one xoshiro128** stream per lane; lanes that roll no die this step
+// leave their stream untouched.
+//
+// Each battle rolls its own Rng in exactly the order CombatSystem does, so
+// a battle seeded with Rng(seed, i) ends with the same hp, mana, turns and
+// hit counts as simulateBattle under RngScope(Rng(seed, i)), whichever
+// kernel runs it. The Attack, Ability and Effects policies are supported,
+// and the enemy may roll at most two dice.
+//
+// Status effects are kept as lanes too: an active mask per side (bit k for
+// kind k, as in StatusEffects) and the turns and power of each kind. Only
+// the player's abilities apply effects, so the player can only hold Shield
+// and Guard and the enemy only Poison and Stun; one slot per kind is
+// enough. They tick at the start of their holder's turn, in kind order.
+class BatchCombat {
+public:
+	static const int LANES = 8;
+	static const int EXTRA_ABILITIES = MAX_CLASS_ABILITIES - 1;
+
+	// Per battle; sizes are padded to a multiple of LANES and padding
+	// battles start over (hp 0). The player never defends under these
+	// policies, so only the enemy's stance is kept.
+	std::vector<int32_t> playerHp, playerMaxHp, playerAttack, playerDefense, playerMana;
+	std::vector<int32_t> enemyHp, enemyAttack, enemyDefense, enemyDefending, enemyDice;
+	std::vector<int32_t> hasAbility, abilityMinRoll, abilityBonus;
+	// Abilities 1 and up, which only the Effects policy uses; kind 0 where
+	// the class has none (setAbilities fills them in)
+	std::vector<int32_t> extraCost[EXTRA_ABILITIES], extraMinRoll[EXTRA_ABILITIES], extraBonus[EXTRA_ABILITIES],
+	                     extraDamage[EXTRA_ABILITIES], extraKind[EXTRA_ABILITIES], extraTurns[EXTRA_ABILITIES],
+	                     extraPower[EXTRA_ABILITIES];
+	std::vector<uint32_t> rng[4];		// xoshiro128** state words
+
+	// Filled in by run(); tallies match BattleResult. The effect lanes end
+	// as the battles left them; effectTurns[k - 1] and effectPower[k - 1]
+	// hold kind k, on whichever side holds it.
+	std::vector<int32_t> turns, playerRolls, playerHits, playerCrits, enemyHits;
+	std::vector<int32_t> playerEffects, enemyEffects;
+	std::vector<int32_t> effectTurns[EFFECT_KIND_COUNT - 1], effectPower[EFFECT_KIND_COUNT - 1];
+
+private:
+	int count = 0;
+
+	void runScalar(int first, int last, SimPolicy policy, int maxTurns);
+	void runAVX2(int first, int last, SimPolicy policy, int maxTurns);
+
+public:
+	BatchCombat() {}
+	explicit BatchCombat(int n) { resize(n); }
+
+	void resize(int n);
+	int size() const { return count; }
+	void set(int i, const CombatSnapshot& s, const Rng& r);
+	// Copies the class's abilities past the first, for the Effects policy.
+	// Without it battle i knows only ability 0 and Effects plays as Ability.
+	void setAbilities(int i, const PlayerClassDef& def);
+
+	// Plays every battle to the end (or maxTurns rounds), every battle
+	// starting without effects as simulateBattle does. Returns false,
+	// playing nothing, for Search, whose CombatAI plans need Entity objects.
+	bool run(SimPolicy policy, int maxTurns = 1000, BatchKernel kernel = BatchKernel::Auto);
+
+	BattleResult result(int i) const;
+
+	static bool avx2Available();
+};
+
+#endif
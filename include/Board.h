@@ -1,22 +1,88 @@
 #ifndef BOARD_H
 #define BOARD_H
 
-#include <SFML/Graphics.hpp>
+#include <cstdint>
 #include <vector>
+#include "LevelArena.h"
 #include "Tile.h"
 
+// The tile grid and its per-tile state, with no rendering: BoardRenderer
+// draws it, and headless tools use it as it is.
 class Board {
+public:
+	static constexpr int CHUNK = 32;	// chunk edge in tiles
+
 private:
+	// A CHUNK x CHUNK block of tiles. Chunks are taken from the arena on the
+	// first non-empty write; an unallocated chunk reads as all Empty.
+	struct Chunk {
+		TileKind kinds[CHUNK * CHUNK];
+		uint8_t flags[CHUNK * CHUNK];	// TileFlag bits
+		uint32_t revision = 0;			// bumped by every tile change
+		int lastChanged = -1;			// local index of the latest change
+	};
+
 	int rows, cols;
-	float tileSize;
-	std::vector<std::vector<Tile*>> grid;
+	int chunkRows, chunkCols;
+	std::vector<Chunk*> chunks;		// chunkRows * chunkCols, row-major
+	LevelArena<Chunk> chunkArena;	// emptied by load()
+	uint32_t generation = 0;		// bumped by load()
+
+	Chunk* chunkAt(int r, int c) const { return chunks[(r / CHUNK) * chunkCols + c / CHUNK]; }
+	static int local(int r, int c) { return (r % CHUNK) * CHUNK + c % CHUNK; }
+	Chunk& ensureChunk(int r, int c);
 public:
-	Board(int r, int c, float size);
-	~Board();
-	void setTile(int r, int c, Tile* tile, sf::Texture& tex);
-	Tile* getTile(int r, int c);
-	void draw(sf::RenderWindow& win);
-	void replaceWithEmpty(int r, int c, sf::Texture& texEmpty);
+	Board(int r, int c);
+
+	int getRows() const { return rows; }
+	int getCols() const { return cols; }
+	bool inBounds(int r, int c) const { return r >= 0 && c >= 0 && r < rows && c < cols; }
+
+	// Replaces the whole board with a rows x cols row-major tile array in one
+	// pass. Allocates nothing unless the level needs more chunks than any before.
+	void load(int r, int c, const TileKind* tiles);
+
+	void setTile(int r, int c, TileKind kind);
+	// Unchecked: call inBounds first for coordinates that may be off the board.
+	TileKind getTile(int r, int c) const {
+		const Chunk* ch = chunkAt(r, c);
+		return ch ? ch->kinds[local(r, c)] : TileKind::Empty;
+	}
+	bool isBlocked(int r, int c) const { return !inBounds(r, c) || isBlockedKind(getTile(r, c)); }
+
+	// Stepping onto a Monster/Boss tile arms its combat trigger; returns
+	// whether a battle should start there.
+	bool enter(int r, int c);
+	bool shouldTriggerCombat(int r, int c) const {
+		const Chunk* ch = chunkAt(r, c);
+		return ch && (ch->flags[local(r, c)] & TILE_COMBAT_TRIGGERED);
+	}
+	void resetCombatTrigger(int r, int c);
+	void replaceWithEmpty(int r, int c);
+
+	// Chunk-level access for renderers, which cache one mesh per chunk and
+	// rebuild it only when its revision moves (or the generation, on load).
+	int getChunkRows() const { return chunkRows; }
+	int getChunkCols() const { return chunkCols; }
+	int chunkWidth(int cc) const;
+	int chunkHeight(int cr) const;
+	// CHUNK-strided kinds, or nullptr for an unallocated (all Empty) chunk.
+	const TileKind* chunkTiles(int cr, int cc) const {
+		const Chunk* ch = chunks[cr * chunkCols + cc];
+		return ch ? ch->kinds : nullptr;
+	}
+	uint32_t chunkRevision(int cr, int cc) const {
+		const Chunk* ch = chunks[cr * chunkCols + cc];
+		return ch ? ch->revision : 0;
+	}
+	// Local index (r % CHUNK * CHUNK + c % CHUNK) of the chunk's latest
+	// change, so one revision step can be patched instead of rebuilt.
+	int chunkLastChanged(int cr, int cc) const {
+		const Chunk* ch = chunks[cr * chunkCols + cc];
+		return ch ? ch->lastChanged : -1;
+	}
+	uint32_t getGeneration() const { return generation; }
+	int getAllocatedChunks() const;
 };
 
-#endif
\ No newline at end of file
+#endif
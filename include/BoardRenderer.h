@@ -0,0 +1,51 @@
+#ifndef BOARDRENDERER_H
+#define BOARDRENDERER_H
+
+#include <SFML/Graphics.hpp>
+#include <map>
+#include <vector>
+#include "Board.h"
+
+// Draws a Board with SFML. Every chunk becomes one vertex array textured
+// from an atlas of the tile textures, so a chunk is one draw call, and only
+// chunks that intersect the target's view are drawn. Meshes are cached per
+// chunk and follow the board's revisions: a single changed tile patches its
+// quad, anything more rebuilds the chunk, and a new level reuses the buffers.
+class BoardRenderer {
+private:
+	struct ChunkMesh {
+		sf::VertexArray vertices;	// chunk-local quads
+		uint32_t revision = 0;		// board chunk revision they show, 0 = not built
+	};
+
+	float tileSize;
+	const sf::Texture* textures[TILE_KIND_COUNT] = {};
+
+	// All tile textures packed side by side, one ATLAS_CELL square per kind
+	static const unsigned ATLAS_CELL = 128;
+	sf::RenderTexture atlas;
+	bool atlasStale = true;
+
+	std::vector<ChunkMesh> meshes;	// per board chunk, row-major
+	const Board* meshBoard = nullptr;
+	uint32_t meshGeneration = 0;
+	// Shared quads for unallocated chunks, keyed by (width << 8 | height)
+	std::map<int, sf::VertexArray> emptyChunkVertices;
+	int lastDrawCalls = 0;
+
+	void buildAtlas();
+	// kinds == nullptr builds an all-Empty block
+	void buildQuads(int w, int h, const TileKind* kinds, sf::VertexArray& out);
+	void setQuadTexCoords(sf::Vertex* quad, TileKind kind);
+public:
+	explicit BoardRenderer(float tileSize);
+
+	float getTileSize() const { return tileSize; }
+	void setTexture(TileKind kind, const sf::Texture& tex);
+
+	// Draws only the chunks that intersect the target's current view.
+	void draw(const Board& board, sf::RenderTarget& target);
+	int getLastDrawCalls() const { return lastDrawCalls; }
+};
+
+#endif
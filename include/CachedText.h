@@ -0,0 +1,46 @@
+#ifndef CACHEDTEXT_H
+#define CACHEDTEXT_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+// sf::Text that keeps its glyph layout between frames. The string is only
+// rebuilt (and the geometry redone) when the values it shows change, so
+// drawing an unchanged HUD costs no string building and no allocation.
+//
+// Two ways to drive it:
+//   setString(s)       compares against the last string shown
+//   changed({...}) /   compares the values the string is built from, so the
+//   buffer() / commit() string is only formatted when one of them differs
+class CachedText : public sf::Drawable {
+public:
+	static const int MAX_KEYS = 8;
+
+	sf::Text text;		// font, size, colour and position are set directly
+
+	void setString(const std::string& s);
+
+	// True when `key` differs from the values passed last time (or after
+	// invalidate()). The caller then fills buffer() and calls commit().
+	bool changed(std::initializer_list<int64_t> key);
+	std::string& buffer() { return shown; }
+	void commit();
+
+	// Forces the next changed() to report a change.
+	void invalidate() { valid = false; }
+
+	uint32_t getRebuilds() const { return rebuilds; }
+
+private:
+	std::string shown;			// reused, so rebuilds keep their capacity
+	int64_t key[MAX_KEYS] = {};
+	int keyCount = 0;
+	bool valid = false;
+	uint32_t rebuilds = 0;
+
+	void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+};
+
+#endif
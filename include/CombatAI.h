@@ -0,0 +1,79 @@
+#ifndef COMBATAI_H
+#define COMBATAI_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "CombatOdds.h"
+
+struct CombatAIConfig {
+	double budgetMs = 10.0;		// per decision; 0 searches exactly maxDepth rounds
+	int maxDepth = 32;			// rounds of lookahead
+	double fleeValue = 0.25;	// worth of escaping; a loss is 0, a win 0.8..1 by HP left
+	int tableBits = 18;			// transposition table holds 2^tableBits entries
+};
+
+struct CombatDecision {
+	CombatAction action = CombatAction::Attack;
+	double value = 0;		// expected utility of the action
+	int depth = 0;			// rounds searched to completion
+	uint64_t nodes = 0;
+	double ms = 0;
+};
+
+// Expectimax over whole rounds (player action, then the enemy's attack),
+// with chance nodes weighted by the exact d20/d6 distributions that
+// CombatSystem rolls. Searches by iterative deepening until the time
+// budget runs out and returns the best action of the deepest finished
+// pass. Wins score higher with more HP left and are discounted per round;
+// leaves past the horizon are scored by a damage-race estimate of the win
+// chance.
+//
+// Status effects already on either side play out through StatusEffects
+// itself: they tick at the start of their holder's turn, a stunned side
+// loses it, poison can end the battle, and guards and shields soften hits.
+// The search only weighs ability 0, so it never adds effects of its own.
+//
+// States are keyed on (player hp, enemy hp, mana, defending, effects), so
+// the table is kept between turns of the same battle and cleared when the
+// combatants' stats change.
+class CombatAI {
+private:
+	struct Entry {
+		uint64_t key = 0;		// state key + 1, 0 = empty
+		float value = 0;
+		int16_t depth = 0;
+		uint8_t action = 0;
+	};
+
+	CombatAIConfig config;
+	std::vector<Entry> table;
+	uint64_t mask;
+	CombatStatsKey rules = {};	// stats the table was filled for
+	bool haveRules = false;
+
+	CombatOdds odds;
+
+	uint64_t nodes = 0;
+	bool aborted = false;
+	std::chrono::steady_clock::time_point deadline;
+
+	void prepare(const CombatSnapshot& s);
+	double evaluate(const CombatSnapshot& s) const;
+	// Effects = false leaves status effects out, for searches whose root has none
+	template <bool Effects> double playerTurn(const CombatSnapshot& s, int depth, CombatAction* best);
+	// playerTurn for a player who gets to act (its effects have ticked)
+	template <bool Effects> double bestAction(const CombatSnapshot& s, int depth, CombatAction& best);
+	template <bool Effects> double actionValue(const CombatSnapshot& s, CombatAction a, int depth);
+	template <bool Effects> double enemyTurn(const CombatSnapshot& s, int depth);
+	// enemyTurn for an enemy that gets to attack (its effects have ticked)
+	template <bool Effects> double enemyAttack(const CombatSnapshot& s, int depth);
+public:
+	explicit CombatAI(const CombatAIConfig& cfg = CombatAIConfig());
+
+	CombatDecision decide(const CombatSnapshot& s);
+	void clearTable();
+	const CombatAIConfig& getConfig() const { return config; }
+};
+
+#endif
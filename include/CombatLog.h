@@ -0,0 +1,85 @@
+#ifndef COMBATLOG_H
+#define COMBATLOG_H
+
+#include <cstdint>
+#include <string>
+
+class Player;
+class Entity;
+
+enum class CombatEventType : uint8_t {
+	BattleStart,	// player vs enemy
+	Roll,			// a = d20 result, b = attack bonus or required roll, aux = RollKind
+	Crit,			// extra d6 added to the hit that follows
+	Hit,			// actor deals a damage
+	Miss,			// a = defense target that was not reached
+	Defended,		// actor halved incoming damage to a
+	NoMana,			// a = current mana, b = ability cost
+	AbilityHit,		// a = damage, b = mana left, aux = ability index
+	AbilityFail,	// aux = ability index
+	Defend,			// actor braces for the next attack
+	Fled,
+	RunFailed,
+	EnemyTurn,
+	Victory,		// enemy defeated, a = HP healed
+	BossDefeated,
+	PlayerDied,
+	EffectApplied,	// actor gains effect aux (EffectKind), a = turns, b = power
+	EffectDamage,	// actor loses a HP to effect aux, b = HP left
+	Stunned,		// actor loses its turn
+	Absorbed,		// actor's shield soaks up a damage, b = shield left
+	EffectEnded,	// actor's effect aux wore off, a = 1 if it was used up instead (a broken shield)
+	// Party battles (PartyBattle), where combatants are numbered: the other
+	// events of a turn follow its PartyTurn and name the pair it pits
+	Initiative,		// combatant b of side actor rolled initiative a
+	PartyTurn,		// combatant a of side actor acts against combatant b
+	Downed			// combatant a of side actor is down
+};
+
+enum class RollKind : uint8_t { Attack, Ability, Run };
+
+enum CombatSide : uint8_t { SIDE_PLAYER, SIDE_ENEMY };
+
+// One combat step as plain data. Recording one is a few stores; text is
+// only produced by formatCombatEvent for lines that are actually shown.
+struct CombatEvent {
+	CombatEventType type;
+	uint8_t actor;	// CombatSide
+	uint8_t aux;
+	int32_t a;
+	int32_t b;
+};
+
+// Fixed-capacity ring of the most recent events. Events are addressed by a
+// sequence number that keeps growing, so readers can remember where they
+// stopped and pick up only what is new.
+class CombatLog {
+public:
+	static const int CAPACITY = 256;	// power of two
+
+private:
+	CombatEvent events[CAPACITY];
+	uint64_t total = 0;
+
+public:
+	void push(CombatEventType type, uint8_t actor, int32_t a = 0, int32_t b = 0, uint8_t aux = 0) {
+		events[total & (CAPACITY - 1)] = CombatEvent{ type, actor, aux, a, b };
+		total++;
+	}
+	// Empties the log; the next event gets sequence number `next`. Only for
+	// restoring a saved log, which pushes its held events back right after.
+	void clear(uint64_t next = 0) { total = next; }
+
+	// Sequence number one past the newest event.
+	uint64_t end() const { return total; }
+	// Oldest sequence number still held.
+	uint64_t begin() const { return total > (uint64_t)CAPACITY ? total - CAPACITY : 0; }
+	const CombatEvent& at(uint64_t seq) const { return events[seq & (CAPACITY - 1)]; }
+};
+
+// Appends the battle-screen text for one event.
+void formatCombatEvent(std::string& out, const CombatEvent& e, const Player& player, const Entity& enemy);
+// Text for all events from sequence number `from` (clamped to what the ring still holds).
+std::string formatCombatLog(const CombatLog& log, uint64_t from, const Player& player, const Entity& enemy);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef COMBATODDS_H
+#define COMBATODDS_H
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "Player.h"
+#include "Enemy.h"
+
+// Player actions, in battle button order.
+enum class CombatAction : uint8_t { Attack, Defend, Ability, Run };
+const int COMBAT_ACTION_COUNT = 4;
+const char* combatActionName(CombatAction a);
+
+// Constants of the combat rules, as CombatSystem applies them.
+const int ABILITY_MANA_COST = 5;	// of ability 0, the only one the searches model
+const int RUN_ROLL = 12;			// CombatSystem::run succeeds on d20 >= this
+
+// The fields CombatSystem reads from the two combatants, as plain data so
+// searches can copy states freely. Stats stay fixed during a battle; hp,
+// mana, the defending flags and the status effects change.
+struct CombatSnapshot {
+	int16_t playerHp, playerMaxHp, playerAttack, playerDefense, playerMana;
+	int16_t enemyHp, enemyMaxHp, enemyAttack, enemyDefense;
+	int16_t abilityBonus;
+	int8_t abilityMinRoll;
+	uint8_t hasAbility;
+	uint8_t enemyDamageDice;	// d6s per enemy hit (Boss rolls two)
+	uint8_t playerDefending, enemyDefending;
+	StatusEffects playerEffects, enemyEffects;	// activeMask() is what each side holds
+};
+static_assert(std::is_trivially_copyable<CombatSnapshot>::value, "CombatSnapshot must stay plain data");
+
+constexpr bool firstAbilitiesCost(int cost) {
+	for (const PlayerClassDef& d : PLAYER_CLASSES)
+		if (d.abilityCount > 0 && d.abilities[0].manaCost != cost) return false;
+	return true;
+}
+static_assert(firstAbilitiesCost(ABILITY_MANA_COST), "CombatAI, CombatSolver and BatchCombat assume ability 0 costs ABILITY_MANA_COST");
+
+CombatSnapshot makeCombatSnapshot(const Player& player, const Enemy& enemy);
+
+// The fixed stats of a snapshot (everything but hp, mana, defending and effects).
+// Snapshots with equal keys play by the same odds.
+typedef std::array<int16_t, 10> CombatStatsKey;
+CombatStatsKey combatStatsKey(const CombatSnapshot& s);
+
+// Exact damage distributions of one battle's d20/d6 rolls. Misses are
+// folded in as 0 damage; damage is before halving for a defending target.
+struct CombatOdds {
+	struct Outcome {
+		int16_t dmg;
+		float p;
+	};
+
+	std::vector<Outcome> attack;		// player attack
+	std::vector<Outcome> ability;		// successful ability rolls only
+	std::vector<Outcome> enemy;			// enemy attack
+	float abilityFail = 1;
+	float fleeChance = 0;
+	float playerMeanDmg = 0, enemyMeanDmg = 0;
+
+	void build(const CombatSnapshot& s);
+};
+
+#endif
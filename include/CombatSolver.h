@@ -0,0 +1,63 @@
+#ifndef COMBATSOLVER_H
+#define COMBATSOLVER_H
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include "CombatOdds.h"
+
+// Which player strategy the solver evaluates.
+enum class SolverPolicy {
+	Attack,		// always attack (SimPolicy::Attack)
+	Ability,	// ability whenever mana allows, else attack (SimPolicy::Ability)
+	Best		// the action maximising P(win) + fleeValue * P(flee) in every state
+};
+
+struct CombatOutcome {
+	double win = 0, loss = 0, flee = 0;
+	double expectedTurns = 0;		// rounds until the battle ends
+	CombatAction firstAction = CombatAction::Attack;
+};
+
+// Exact battle outcomes by dynamic programming over (player hp, enemy hp,
+// mana) with the transition odds CombatSystem rolls. HP and mana never go
+// up during a battle, so every state only leads to itself (a round where
+// nothing changed) or to states already solved; the self-loop is folded
+// in by dividing through by (1 - P(stay)).
+//
+// One table solves every starting hp up to the maxima, and tables are
+// cached by stats, starting mana and policy, so repeated matchups (or the
+// same fight entered with less HP) cost a single lookup.
+class CombatSolver {
+private:
+	struct State {
+		float win, flee, turns;		// loss = 1 - win - flee
+		CombatAction action;
+	};
+	struct Table {
+		int maxPlayerHp = 0, maxEnemyHp = 0, startMana = 0, abilityUses = 0;
+		std::vector<State> states;		// [uses][enemyHp][playerHp], hp from 1
+
+		int index(int playerHp, int enemyHp, int uses) const {
+			return (uses * maxEnemyHp + enemyHp - 1) * maxPlayerHp + playerHp - 1;
+		}
+	};
+	typedef std::tuple<CombatStatsKey, int, int> TableKey;	// stats, start mana, policy
+
+	double fleeValue;
+	std::map<TableKey, Table> tables;
+	long long statesSolved = 0;
+
+	void solveTable(Table& t, const CombatSnapshot& s, SolverPolicy policy);
+public:
+	explicit CombatSolver(double fleeValue = 0);
+
+	// Outcome from the snapshot's current hp and mana.
+	CombatOutcome solve(const CombatSnapshot& s, SolverPolicy policy);
+
+	int getTableCount() const { return (int)tables.size(); }
+	long long getStatesSolved() const { return statesSolved; }
+	void clear() { tables.clear(); }
+};
+
+#endif
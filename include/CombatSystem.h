@@ -4,24 +4,35 @@
 #include "Player.h"
 #include "Enemy.h"
 #include "Dice.h"
-#include <iostream>
+#include "CombatLog.h"
+
+// Per-thread log for callers that do not keep the events (headless runs).
+CombatLog& scratchLog();
 
 class CombatSystem {
 private:
 	Player* player;
 	Enemy* enemy;
 	D20 d20;
-	std::ostream& log;
+	CombatLog& log;
+
+	void applyDamage(Entity* target, uint8_t targetSide, int dmg);
+	// Start of `e`'s turn: ticks its effects and logs what they did. Returns
+	// false if the turn is lost (stunned, or the poison finished it).
+	bool beginTurn(Entity* e, uint8_t side);
 
 public:
-	CombatSystem(Player* p, Enemy* e, std::ostream& l);
+	CombatSystem(Player* p, Enemy* e, CombatLog& l);
+	CombatSystem(Player* p, Enemy* e);
 	void attack();
-	void ability();
+	// Uses ability `index` of the player's class.
+	void ability(int index = 0);
 	void defend();
 	bool run();
 	void enemyTurn();
 	bool isEnemyDefeated() const;
 	bool isPlayerDefeated() const;
+	CombatLog& getLog() { return log; }
 };
 
-#endif
\ No newline at end of file
+#endif
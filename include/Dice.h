@@ -1,10 +1,67 @@
 #ifndef DICE_H
 #define DICE_H
 
-#include <random>
-#include <chrono>
+#include <cstddef>
+#include <cstdint>
 
-extern std::mt19937 rng;
+// xoshiro128** generator. 16 bytes of state, no heap, cheap to copy, and a
+// (seed, stream) pair always reproduces the same sequence, so every thread or
+// battle can own an independent, replayable stream.
+class Rng {
+private:
+	uint32_t s[4];
+	static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+public:
+	explicit Rng(uint64_t seed = 0, uint64_t stream = 0);
+
+	uint32_t next() {
+		const uint32_t result = rotl(s[1] * 5, 7) * 9;
+		const uint32_t t = s[1] << 9;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 11);
+		return result;
+	}
+	// Uniform in [0, n) via Lemire's multiply-shift with rejection (unbiased).
+	uint32_t bounded(uint32_t n) {
+		uint64_t m = (uint64_t)next() * n;
+		if ((uint32_t)m < n) return boundedSlow(n, m);
+		return (uint32_t)(m >> 32);
+	}
+	int roll(int sides) { return (int)bounded((uint32_t)sides) + 1; }
+	// Fills out[0..n) with rolls; identical to calling roll(sides) n times.
+	void rollN(int sides, int* out, std::size_t n);
+	const uint32_t* state() const { return s; }
+	// An all-zero state (a fixed point: next() would return 0 forever) is
+	// remapped the way the constructor does.
+	void setState(const uint32_t st[4]);
+
+private:
+	uint32_t boundedSlow(uint32_t n, uint64_t m);
+};
+
+// The stream Dice rolls from on the calling thread. Each thread starts with
+// its own clock-seeded stream; seedThreadRng or RngScope make it deterministic.
+Rng& threadRng();
+void seedThreadRng(uint64_t seed, uint64_t stream = 0);
+
+// Reads a --seed style argument: a whole decimal number that fits 64 bits,
+// digits only (no sign or spaces). Returns false, leaving `out`, otherwise.
+bool parseSeed(const char* text, unsigned long long& out);
+
+// Points threadRng() at `r` for the lifetime of the scope (e.g. one battle).
+class RngScope {
+private:
+	Rng* prev;
+public:
+	explicit RngScope(Rng& r);
+	~RngScope();
+	RngScope(const RngScope&) = delete;
+	RngScope& operator=(const RngScope&) = delete;
+};
 
 class Dice {
 protected:
@@ -14,17 +71,18 @@ public:
 	Dice(int s) : sides(s) {}
 	virtual ~Dice() {}
 	virtual int roll();
+	void rollN(int* out, std::size_t n);
 	int getLastRoll() const { return lastRoll; }
 };
 
-class D6 : public Dice { 
-public: 
-	D6() : Dice(6) {} 
+class D6 : public Dice {
+public:
+	D6() : Dice(6) {}
 };
 
-class D20 : public Dice { 
-public: 
-	D20() : Dice(20) {} 
+class D20 : public Dice {
+public:
+	D20() : Dice(20) {}
 };
 
-#endif
\ No newline at end of file
+#endif
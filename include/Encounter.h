@@ -0,0 +1,39 @@
+#ifndef ENCOUNTER_H
+#define ENCOUNTER_H
+
+#include <optional>
+#include <vector>
+#include "Enemy.h"
+#include "CombatSystem.h"
+
+// The enemy and CombatSystem of the battle in progress, held in slots that
+// every battle reuses. Each level's goblin, ogre and boss are built once
+// by prepareLevels, so starting a battle copies stats into a slot whose
+// strings already have room and ending one only clears it: neither touches
+// the heap.
+class EncounterSlots {
+private:
+	std::vector<Monster> goblins, ogres;	// per level index
+	std::vector<Boss> bosses;
+	Monster monster;
+	Boss boss;
+	std::optional<CombatSystem> combat;
+	Enemy* enemy = nullptr;
+
+public:
+	EncounterSlots();
+
+	// Builds the encounters of level indices [0, count). Levels past these
+	// still work, but build theirs on first use.
+	void prepareLevels(int count);
+
+	// Ends any battle in progress and starts one against `kind` at the
+	// level index's strength.
+	Enemy* begin(EnemyKind kind, int levelIndex, Player* player, CombatLog& log);
+	void end();
+
+	Enemy* getEnemy() const { return enemy; }
+	CombatSystem* getCombat() { return combat ? &*combat : nullptr; }
+};
+
+#endif
@@ -25,4 +25,11 @@ public:
 	int calculateDamage() override;
 };
 
+enum class EnemyKind { Goblin, Ogre, Boss };
+
+// Encounters exactly as startBattle() in main.cpp builds them for a 0-based level index.
+Monster makeGoblin(int levelIndex);
+Monster makeOgre(int levelIndex);
+Boss makeLevelBoss(int levelIndex);
+
 #endif
\ No newline at end of file
@@ -2,7 +2,7 @@
 #define ENTITY_H
 
 #include <string>
-#include <iostream>
+#include "StatusEffects.h"
 
 class Entity {
 public:
@@ -13,13 +13,18 @@ public:
 	int defense;
 	int mana = 0;
 	bool defending = false;
+	StatusEffects effects;
 
 	Entity(std::string n, int m, int a, int d);
 	virtual ~Entity() {}
 
 	virtual int calculateDamage() = 0;
-	void takeDamage(int dmg);
+	// Applies dmg (halved while defending or guarded, then soaked up by any
+	// shield) and returns the amount actually taken.
+	int takeDamage(int dmg);
 	void resetDefend() { defending = false; }
+	// Drops the defending flag and every status effect, for a new battle.
+	void resetStatus() { defending = false; effects.clear(); }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Board.h"
+#include "CombatLog.h"
+#include "CombatOdds.h"
+#include "Dice.h"
+#include "Encounter.h"
+#include "GameState.h"
+#include "LevelPack.h"
+#include "Player.h"
+#include "Reachability.h"
+
+// One player input, as the game logic sees it (the window turns clicks and
+// keys into these).
+enum class GameInputKind : uint8_t {
+	ChooseClass,	// value: PlayerClass
+	Roll,			// SPACE
+	Move,			// value: MoveDir (WASD)
+	BattleAction	// value: battleInputValue (battle buttons, or the auto-battle)
+};
+
+enum class MoveDir : uint8_t { Up, Down, Left, Right };
+
+struct GameInput {
+	GameInputKind kind;
+	uint8_t value = 0;
+};
+
+// A BattleAction value: the CombatAction in the low four bits and, for
+// CombatAction::Ability, the ability index above them. Ability 0 encodes as
+// the bare action, so recordings from before abilities had an index still
+// replay.
+inline uint8_t battleInputValue(CombatAction action, int ability = 0) {
+	return (uint8_t)((uint8_t)action | ability << 4);
+}
+
+// The rules of a run, without a window: menu choice, rolling and walking
+// the board, battles and level progression. The window feeds it inputs and
+// simulation time and draws what the getters report.
+//
+// All dice come from the game's own Rng, so a run is fully determined by
+// its seed and the inputs it accepted; those are recorded as they happen.
+// Inputs are only accepted while no timed event is pending, which is what
+// lets a replay resolve the delays instantly (settle) instead of waiting.
+class Game {
+public:
+	static constexpr float ENEMY_TURN_DELAY = 1.5f;	// before the enemy strikes back
+	static constexpr float BATTLE_END_DELAY = 2.0f;	// result shown before leaving the battle
+
+private:
+	const LevelPack& levels;
+	std::ostream& out;
+	Rng rng;
+	uint64_t seed;
+	std::vector<GameInput> inputs;		// accepted inputs, in order
+
+	Board board;
+	Reachability reach;
+	EncounterSlots encounters;
+	std::optional<Player> player;		// built in place: no allocation per run
+	PlayerClass playerClass = PlayerClass::Soldier;
+	GameState state = GameState::MainMenu;
+	int levelIndex = 0;
+	int startR = 0, startC = 0;
+	int movePoints = 0;
+	bool levelBossDefeated = false;
+	std::vector<uint32_t> clearedTiles;	// r * cols + c of enemies defeated on this level
+	uint32_t checkpoint = 0;
+
+	// Battle
+	CombatLog battleLog;
+	uint64_t battleMessageStart = 0;	// first event of the current message
+	float battleDelayTimer = 0.f;		// simulation time since the last battle step
+	bool enemyTurnPending = false;
+	bool battleOver = false;			// result shown, waiting to leave the battle
+	bool isFightingLevelBoss = false;
+	EnemyKind enemyKind = EnemyKind::Goblin;
+	Enemy* currentEnemy = nullptr;		// point into encounters
+	CombatSystem* combatSystem = nullptr;
+	int enemyRow = -1, enemyCol = -1;
+
+	void loadLevel(int index);
+	void startBattle(int r, int c, bool isBoss);
+	void endBattle(uint64_t allocsBefore);
+	void checkBattleStatus();
+	bool chooseClass(PlayerClass cls);
+	bool roll();
+	bool move(MoveDir dir);
+	bool battleAction(CombatAction action, int ability);
+	bool step(float dt);
+	uint64_t hashState(bool logPosition) const;
+
+public:
+	// Progress messages go to `log` (pass a stream with no buffer to silence them).
+	Game(const LevelPack& levels, uint64_t seed, std::ostream& log);
+	Game(const Game&) = delete;
+	Game& operator=(const Game&) = delete;
+
+	// Starts a new run from the main menu with `seed`, as a freshly
+	// constructed Game would, but on the storage this one already holds.
+	void restart(uint64_t seed);
+
+	// Applies an input; returns false (and records nothing) when the game
+	// ignores it in its current state.
+	bool apply(const GameInput& input);
+	// Advances battle timers by dt seconds of simulation time; returns
+	// whether anything changed.
+	bool update(float dt);
+	// Resolves every pending timed event at once.
+	void settle();
+
+	// Fingerprint of everything the rules depend on: state, level, player,
+	// board tiles, the battle in progress and the dice. What the battle log
+	// holds is left out, so changing what gets logged keeps recordings valid.
+	uint64_t stateHash() const;
+	// The same plus the battle log's position: the hash version 1
+	// recordings were made with.
+	uint64_t stateHashV1() const;
+
+	// Binary snapshot of the whole run, battle in progress included (format
+	// in SaveGame.h). loadSnapshot leaves the game untouched on error; the
+	// levels must be the pack the snapshot was taken with.
+	void saveSnapshot(std::vector<uint8_t>& out) const;
+	bool loadSnapshot(const uint8_t* data, size_t size, std::string& error);
+	// Bumped on every level transition and every battle the player survives:
+	// the points where the window autosaves.
+	uint32_t getCheckpoint() const { return checkpoint; }
+
+	uint64_t getSeed() const { return seed; }
+	const std::vector<GameInput>& getInputs() const { return inputs; }
+
+	GameState getState() const { return state; }
+	Board& getBoard() { return board; }
+	const Board& getBoard() const { return board; }
+	Reachability& getReach() { return reach; }
+	const Player* getPlayer() const { return player ? &*player : nullptr; }
+	PlayerClass getPlayerClass() const { return playerClass; }
+	const Enemy* getEnemy() const { return currentEnemy; }
+	int getLevelIndex() const { return levelIndex; }
+	int getMovePoints() const { return movePoints; }
+	bool isLevelBossDefeated() const { return levelBossDefeated; }
+	const CombatLog& getBattleLog() const { return battleLog; }
+	uint64_t getBattleMessageStart() const { return battleMessageStart; }
+	float getBattleDelay() const { return battleDelayTimer; }
+	// Waiting on the enemy's turn or on the end of the battle
+	bool isBattleBusy() const { return enemyTurnPending || battleOver; }
+	bool awaitingBattleAction() const { return state == GameState::InBattle && combatSystem && !isBattleBusy(); }
+};
+
+#endif
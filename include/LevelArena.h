@@ -0,0 +1,34 @@
+#ifndef LEVELARENA_H
+#define LEVELARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Objects that live for one level. Storage comes in blocks allocated the
+// first time a level needs them and kept for the rest of the run: reset()
+// hands every object back at once without destroying it, so the next level
+// reuses the memory and whatever buffers the objects grew.
+// Only a level larger than any before it allocates.
+template <class T>
+class LevelArena {
+private:
+	static const size_t BLOCK = 16;
+	std::vector<std::unique_ptr<T[]>> blocks;
+	size_t used = 0;
+
+public:
+	// The next free object, as its previous user left it; callers reinitialise it.
+	T* acquire() {
+		if (used == blocks.size() * BLOCK) blocks.emplace_back(new T[BLOCK]);
+		T* t = &blocks[used / BLOCK][used % BLOCK];
+		used++;
+		return t;
+	}
+	void reset() { used = 0; }
+
+	size_t size() const { return used; }
+	size_t capacity() const { return blocks.size() * BLOCK; }
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef LEVELGEN_H
+#define LEVELGEN_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Dice.h"
+#include "LevelPack.h"
+#include "WorkStealingPool.h"
+
+// Procedural layouts: random walls and monsters at the given densities, a
+// start, bosses and exits on random cells, and the candidate is kept only
+// if the start can walk to every boss and exit (levelIsConnected, a
+// bitboard flood fill). Dense boards simply take more candidates.
+struct LevelGenParams {
+	int rows = 10, cols = 10;
+	double blockDensity = 0.25;		// share of cells that are walls
+	double monsterDensity = 0.06;	// share of cells with a monster
+	int bosses = 1;
+	int exits = 1;
+	int maxAttempts = 10000;		// candidates before giving up
+};
+
+// Fills `out` with the first valid candidate drawn from `rng`. Returns false
+// if the parameters are impossible or no candidate in maxAttempts was valid.
+// `attempts` (optional) is increased by the candidates drawn.
+bool generateLevel(const LevelGenParams& params, Rng& rng, LevelData& out, long long* attempts = nullptr);
+
+// Generates `count` levels on the pool; level i uses paramsFor(i) and rolls
+// from Rng(seed, i), so the result does not depend on the worker count.
+// Returns false (and fills `error`) if some level could not be generated.
+bool generateLevels(const std::function<LevelGenParams(int)>& paramsFor, int count, uint64_t seed,
+                    WorkStealingPool& pool, std::vector<LevelData>& out, std::string& error,
+                    long long* attempts = nullptr);
+
+// Endless mode: boards grow and fill up with walls and monsters as the
+// level index climbs (enemy stats already scale with it).
+LevelGenParams endlessLevelParams(int index);
+const int ENDLESS_LEVELS = 1000;
+
+// A pack of `count` endless-mode levels rolled from `seed`.
+bool generateEndlessPack(int count, uint64_t seed, WorkStealingPool& pool, LevelPack& pack, std::string& error);
+
+#endif
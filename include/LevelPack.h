@@ -0,0 +1,73 @@
+#ifndef LEVELPACK_H
+#define LEVELPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Tile.h"
+
+// Compiled campaign file (.rlv), all integers little-endian:
+//
+//   header   "RLVL" | u16 version | u16 levelCount | u32 checksum (FNV-1a of everything after the header)
+//   table    levelCount x { u16 rows | u16 cols | u16 startR | u16 startC | u32 tileOffset }
+//   tiles    rows * cols TileKind bytes per level, row-major
+//
+// Every level is validated when compiled and again when loaded (tiles, an
+// empty start that reaches at least one boss and exit and all of them, a
+// size whose cell count fits an int), so the game can copy tiles straight
+// into the Board without further checks.
+const uint16_t LEVEL_PACK_VERSION = 1;
+
+struct LevelView {
+	int rows = 0, cols = 0;
+	int startR = 0, startC = 0;
+	const TileKind* tiles = nullptr;	// rows * cols, points into the pack
+};
+
+// A level held as its own tiles, for levels built in code (LevelGen).
+struct LevelData {
+	int rows = 0, cols = 0;
+	int startR = 0, startC = 0;
+	std::vector<TileKind> tiles;	// rows * cols, row-major
+};
+
+// Turns the text layout format (see assets/levels.txt) into .rlv bytes.
+// Returns false and fills `error` (with a line number) on invalid input,
+// including a 'P' that cannot walk to every 'T' and 'E'.
+bool compileLevels(const std::string& text, std::vector<uint8_t>& out, std::string& error);
+// Packs levels that are already valid into .rlv bytes.
+void packLevels(const std::vector<LevelData>& levels, std::vector<uint8_t>& out);
+// The text layout of one level, as compileLevels reads it.
+std::string levelToText(const LevelData& level);
+
+class LevelPack {
+private:
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	void* mapping = nullptr;		// mmap'd region, released in close()
+	std::vector<uint8_t> owned;		// used instead when the pack is built in memory
+	std::vector<LevelView> levels;
+	uint32_t packChecksum = 0;
+
+	bool parse(std::string& error);
+public:
+	LevelPack() {}
+	~LevelPack();
+	LevelPack(const LevelPack&) = delete;
+	LevelPack& operator=(const LevelPack&) = delete;
+
+	// Memory-maps a compiled .rlv file.
+	bool open(const std::string& path, std::string& error);
+	// Compiles a text layout file in memory (fallback when no .rlv is shipped).
+	bool compileFromFile(const std::string& path, std::string& error);
+	bool loadFromBytes(std::vector<uint8_t> bytes, std::string& error);
+	void close();
+
+	int count() const { return (int)levels.size(); }
+	const LevelView& level(int i) const { return levels[i]; }
+	// The header's checksum of the levels, which saves use to tell packs apart.
+	uint32_t checksum() const { return packChecksum; }
+};
+
+#endif
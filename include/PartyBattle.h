@@ -0,0 +1,119 @@
+#ifndef PARTYBATTLE_H
+#define PARTYBATTLE_H
+
+#include <cstdint>
+#include <vector>
+#include "CombatLog.h"
+#include "Enemy.h"
+#include "Player.h"
+#include "Simulator.h"
+
+// Who a combatant goes after. None of them scans the other side:
+enum class TargetRule : uint8_t {
+	Front,		// the earliest joiner still standing (a cursor that only moves forward)
+	Random,		// any opponent still standing (a dense list of the living)
+	Weakest		// the one with the least HP (a heap of HP readings, stale ones dropped as they surface)
+};
+const char* targetRuleName(TargetRule rule);
+
+// A party of players against a group of enemies, any number a side.
+//
+// Turn order comes from an initiative queue. Everyone rolls d20 + their
+// bonus at start(), or on joining if they arrive mid-battle (reinforcements
+// act from the next round). Each round runs in descending initiative, and
+// ties go to whoever joined first. The queue is a binary heap keyed by
+// (round, initiative), so taking the next turn and queueing the actor for
+// the next round costs O(log n). A combatant who falls is dropped when its
+// entry comes up rather than searched for.
+//
+// Each turn is a one-on-one exchange resolved by CombatSystem, so rolls,
+// abilities and status effects follow the rules of a normal battle. A
+// player acts by its SimPolicy; Search plays as Ability here, because
+// CombatAI plans one-on-one fights. An enemy takes CombatSystem::enemyTurn
+// against its target.
+//
+// The battle points at entities it does not own. reset() keeps every
+// buffer's capacity, so reusing a PartyBattle for battles of the same size
+// allocates nothing.
+class PartyBattle {
+public:
+	struct Member {
+		Entity* entity;
+		Player* player;			// set on the player side
+		Enemy* enemy;			// set on the enemy side
+		uint8_t side;			// CombatSide
+		TargetRule rule;
+		SimPolicy policy;		// players only
+		int initiativeBonus;
+		int initiative = 0;		// d20 + bonus, once rolled
+		int alivePos = -1;		// slot in its side's list of the living, -1 once down
+		int lastHp = 0;			// HP at its newest reading in the side's weakest heap
+	};
+
+private:
+	struct Turn {
+		uint32_t round;
+		int initiative;
+		int member;
+	};
+	struct HpReading {
+		int hp;
+		int member;
+	};
+	// Heap orders, as "a comes after b": the soonest turn and the lowest HP
+	// sit at the front
+	static bool laterTurn(const Turn& a, const Turn& b);
+	static bool higherHp(const HpReading& a, const HpReading& b);
+
+	struct Side {
+		std::vector<int> members;		// in joining order
+		std::vector<int> alive;			// the living, in no particular order
+		size_t front = 0;				// no one before members[front] still stands
+		std::vector<HpReading> weakest;	// min-heap of HP readings, at most 2 per living member
+	};
+
+	CombatLog& log;
+	std::vector<Member> members;
+	Side sides[2];
+	std::vector<Turn> queue;		// heap, soonest turn at the front
+	bool started = false;
+	uint32_t round = 0;
+	long long turns = 0;
+
+	int join(Entity* e, Player* p, Enemy* en, uint8_t side, TargetRule rule, SimPolicy policy, int initiativeBonus);
+	void rollInitiative(int i);
+	int pickTarget(const Member& m);
+	void takeTurn(int actor, int target);
+	// Brings a member's entry in its side's lists up to date after its HP changed.
+	void touch(int i);
+
+public:
+	explicit PartyBattle(CombatLog& log);
+	PartyBattle();	// logs to scratchLog()
+
+	// Forgets every combatant, keeping capacity.
+	void reset();
+	// Adds a combatant and returns its index. Before start() it simply
+	// joins; afterwards it rolls initiative and acts from the next round.
+	int addPlayer(Player* p, SimPolicy policy = SimPolicy::Ability, TargetRule rule = TargetRule::Front, int initiativeBonus = 0);
+	int addEnemy(Enemy* e, TargetRule rule = TargetRule::Front, int initiativeBonus = 0);
+
+	// Clears everyone's defending flag and status effects and rolls initiative.
+	void start();
+	// Plays the next turn (calling start() first if nobody has). Returns
+	// false once the battle is over, including when this turn ended it.
+	bool step();
+	// Plays up to maxTurns turns; returns how many were played.
+	long long run(long long maxTurns);
+
+	bool isOver() const { return sides[SIDE_PLAYER].alive.empty() || sides[SIDE_ENEMY].alive.empty(); }
+	// The side left standing, or -1 while both (or neither) are.
+	int winner() const;
+	int aliveCount(uint8_t side) const { return (int)sides[side].alive.size(); }
+	int size() const { return (int)members.size(); }
+	const Member& member(int i) const { return members[i]; }
+	uint32_t getRound() const { return round; }
+	long long getTurns() const { return turns; }
+};
+
+#endif
@@ -3,36 +3,23 @@
 
 #include "Entity.h"
 #include "Enemy.h"
-#include "SpecialAttributes.h"
-#include <vector>
-#include <iostream>
+#include "PlayerClass.h"
 
+// One concrete type for every class: what differs lives in PLAYER_CLASSES.
 class Player : public Entity {
+private:
+	const PlayerClassDef* def;
+
 public:
 	int posR, posC;
-	std::vector<SpecialAttributes> specialAbilities;
 
-	Player(std::string n, int m, int a, int d, int r, int c);
-	virtual void setStats() = 0;
+	Player(PlayerClass cls, int r, int c);
 	int calculateDamage() override;
-};
-
-class Soldier : public Player {
-public:
-	Soldier(int r, int c);
-	void setStats() override;
-};
 
-class Archer : public Player {
-public:
-	Archer(int r, int c);
-	void setStats() override;
-};
-
-class Mage : public Player {
-public:
-	Mage(int r, int c);
-	void setStats() override;
+	PlayerClass getClass() const { return (PlayerClass)(def - PLAYER_CLASSES); }
+	const PlayerClassDef& getClassDef() const { return *def; }
+	int abilityCount() const { return def->abilityCount; }
+	const SpecialAttributes& ability(int i) const { return def->abilities[i]; }
 };
 
-#endif
\ No newline at end of file
+#endif
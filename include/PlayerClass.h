@@ -0,0 +1,70 @@
+#ifndef PLAYERCLASS_H
+#define PLAYERCLASS_H
+
+#include "SpecialAttributes.h"
+
+enum class PlayerClass { Soldier, Archer, Mage };
+
+const int PLAYER_CLASS_COUNT = 3;
+const int MAX_CLASS_ABILITIES = 4;
+
+// Everything that sets one class apart, as plain data: the single source of
+// its stats. Player copies the stats when it is built and points at the
+// abilities, so building a player allocates nothing and a new class is a
+// new row in PLAYER_CLASSES rather than a new subclass.
+struct PlayerClassDef {
+	const char* name;
+	int maxHp;
+	int attack;
+	int defense;
+	int mana;
+	int damageDie;		// a basic hit deals 1d(damageDie) + attack
+	int abilityCount;
+	SpecialAttributes abilities[MAX_CLASS_ABILITIES];
+};
+
+// Ability 0 is each class's original attack ability; CombatAI, CombatSolver
+// and BatchCombat model only that one (see ABILITY_MANA_COST).
+constexpr PlayerClassDef PLAYER_CLASSES[PLAYER_CLASS_COUNT] = {
+	//  name       hp   atk def mana die  abilities: name, bonus, min roll, cost, damage, effect { kind, turns, power }
+	{ "Soldier", 120, 15, 8,  10,  6,   2, {
+		{ "Power Strike",  5, 15, 5, true },
+		{ "Shield Wall",   0,  1, 4, false, { EffectKind::Guard, 2, 0 } } } },
+	{ "Archer",   80, 18, 4,  20,  6,   2, {
+		{ "Piercing Shot", 3, 12, 5, true },
+		{ "Poison Arrow",  0, 10, 6, true,  { EffectKind::Poison, 3, 4 } } } },
+	{ "Mage",     70,  8, 3,  40,  6,   3, {
+		{ "Fireball",     10, 10, 5, true },
+		{ "Frost Nova",    0, 12, 8, true,  { EffectKind::Stun, 1, 0 } },
+		{ "Arcane Shield", 0,  1, 6, false, { EffectKind::Shield, 3, 20 } } } },
+};
+
+constexpr const PlayerClassDef& classDef(PlayerClass cls) { return PLAYER_CLASSES[(int)cls]; }
+
+constexpr bool classTableValid() {
+	for (const PlayerClassDef& d : PLAYER_CLASSES) {
+		if (!d.name || d.maxHp <= 0 || d.damageDie < 1) return false;
+		if (d.abilityCount < 0 || d.abilityCount > MAX_CLASS_ABILITIES) return false;
+		for (int i = 0; i < d.abilityCount; i++) {
+			const SpecialAttributes& a = d.abilities[i];
+			if (!a.name || a.manaCost < 0) return false;
+			if (a.effect.kind != EffectKind::None && a.effect.turns == 0) return false;
+			if (!a.dealsDamage && a.effect.kind == EffectKind::None) return false;
+		}
+	}
+	return true;
+}
+static_assert(classTableValid(), "PLAYER_CLASSES: every class needs a name, HP, a damage die and named abilities that do something");
+
+// Only Player::calculateDamage reads damageDie. CombatOdds (and so CombatAI
+// and CombatSolver) weighs a basic hit as 1d6 + attack, and BatchCombat's
+// kernels roll g.roll(6) to stay in step with simulateBattle's Rng stream.
+// A class with another die needs those carried over first.
+constexpr bool damageDiceAreD6() {
+	for (const PlayerClassDef& d : PLAYER_CLASSES)
+		if (d.damageDie != 6) return false;
+	return true;
+}
+static_assert(damageDiceAreD6(), "CombatOdds and BatchCombat assume every class's damage die is a d6");
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef PLAYTHROUGH_H
+#define PLAYTHROUGH_H
+
+#include <cstdint>
+#include <iosfwd>
+#include "Game.h"
+#include "Simulator.h"
+#include "WorkStealingPool.h"
+
+// Whole runs played through Game by a scripted player: pick a class, roll
+// and walk the shortest path to the level's boss, then to the exit, and
+// fight every battle on the way with a SimPolicy. Everything else (enemy
+// rolls, the +5 HP after a won battle, level progression) is the game's own
+// rules, so the numbers are what a player following the script would see.
+
+const int PLAYTHROUGH_MAX_LEVELS = 32;		// later levels are counted in the last slot
+const int PLAYTHROUGH_MAX_INPUTS = 5000;	// a run still going after this many inputs times out
+
+// One level, over every run of one class that reached it.
+struct LevelRunStats {
+	long long entered = 0;
+	long long cleared = 0;		// left through the exit (or won the campaign)
+	long long deaths = 0;
+	long long timeouts = 0;
+	long long turns = 0;		// d6 rolls
+	long long battles = 0;
+	long long battleRounds = 0;	// battle actions the player took
+};
+
+// Fixed size, like MatchupStats, so per-worker copies merge without allocating.
+struct ClassRunStats {
+	long long runs = 0;
+	long long clears = 0;		// won the campaign
+	long long deaths = 0;
+	long long timeouts = 0;
+	long long turns = 0;
+	LevelRunStats levels[PLAYTHROUGH_MAX_LEVELS];
+
+	void merge(const ClassRunStats& o);
+	double clearRate() const { return runs ? double(clears) / runs : 0.0; }
+};
+
+struct PlaythroughStats {
+	int levelCount = 0;
+	ClassRunStats classes[PLAYER_CLASS_COUNT];	// by PlayerClass
+
+	void merge(const PlaythroughStats& o);
+};
+
+// Plays `game` (fresh, at the main menu) as `cls` until it is won, lost or
+// times out, and adds the run to `stats`.
+void playScriptedRun(Game& game, PlayerClass cls, SimPolicy policy, ClassRunStats& stats);
+
+// Plays `runs` runs on the pool, cycling through the classes (run i plays
+// class i % PLAYER_CLASS_COUNT). Run i's game is seeded from (seed, i)
+// alone, so the totals do not depend on the number of workers or on who
+// ran what.
+PlaythroughStats runPlaythroughs(const LevelPack& levels, long long runs, SimPolicy policy,
+                                 WorkStealingPool& pool, uint64_t seed = 1);
+
+// One row per class (level "all") and per class and level:
+//   class,level,runs,cleared,clear_rate,deaths,death_rate,timeouts,turns,battles,battle_rounds
+// rates are out of the runs that reached the level; turns, battles and
+// battle_rounds are means per such run.
+void writePlaythroughCsv(const PlaythroughStats& stats, std::ostream& out);
+
+#endif
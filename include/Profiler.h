@@ -0,0 +1,87 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped frame timers. Build with ROGUE_PROFILE defined (cmake -DROGUE_PROFILE=ON)
+// to turn them on; otherwise every macro below expands to nothing and the
+// timed code is exactly as without them.
+//
+//   PROFILE_SCOPE("render");   times the rest of the enclosing block
+//   PROFILE_FUNCTION();        same, named after the function
+//   PROFILE_FRAME();           ends a drawn frame (main loop only)
+//   PROFILE_SKIP_FRAME();      ends a loop pass that drew nothing
+//
+// Zone names must be string literals: they are kept by pointer. Zones on the
+// thread that calls PROFILE_FRAME feed the per-frame statistics; zones on
+// any thread go into the trace while one is being captured.
+#ifdef ROGUE_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_FRAME() profileFrame()
+#define PROFILE_SKIP_FRAME() profileSkipFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_SKIP_FRAME() ((void)0)
+#endif
+
+class ProfileZone {
+private:
+	const char* name;
+	uint64_t start;
+public:
+	explicit ProfileZone(const char* name);
+	~ProfileZone();
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+// Frames kept for the averages and percentiles
+const int PROFILE_HISTORY = 240;
+
+struct ProfileZoneStats {
+	const char* name;
+	int depth;			// nesting level, 0 for outermost zones
+	double lastMs;		// in the last frame
+	double avgMs;		// per frame, over the history
+	double maxMs;
+};
+
+struct ProfileFrameStats {
+	int frames = 0;		// in the history
+	double avgMs = 0, p50Ms = 0, p95Ms = 0, p99Ms = 0, maxMs = 0;
+};
+
+constexpr bool profilerCompiledIn() {
+#ifdef ROGUE_PROFILE
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Closes the current frame: per-zone totals and the time since the
+// previous call go into the history.
+void profileFrame();
+// Closes a loop pass that drew nothing (e.g. one that slept): its zone
+// times and duration are dropped, so the history only holds drawn frames
+// and the next frame is timed from here.
+void profileSkipFrame();
+// Zones in the order they were first seen.
+void profileZoneStats(std::vector<ProfileZoneStats>& out);
+ProfileFrameStats profileFrameStats();
+
+// Chrome trace capture (chrome://tracing or ui.perfetto.dev). Events are
+// kept in memory, at most maxEvents, until stopProfileTrace writes them out.
+void startProfileTrace(size_t maxEvents = 1 << 20);
+bool isProfileTracing();
+// Writes the captured events as trace-event JSON and stops capturing.
+bool stopProfileTrace(const std::string& path, std::string& error);
+
+#endif
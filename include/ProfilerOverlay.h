@@ -0,0 +1,34 @@
+#ifndef PROFILEROVERLAY_H
+#define PROFILEROVERLAY_H
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include "Profiler.h"
+
+// On-screen table of the profiler's zones (last frame, average and worst
+// ms over the history) and frame-time percentiles. The text is re-laid out
+// a few times a second, not every frame, so showing it barely moves the
+// numbers it shows.
+class ProfilerOverlay {
+private:
+	static const int REFRESH_FRAMES = 15;
+
+	sf::Text text;
+	sf::RectangleShape background;
+	std::vector<ProfileZoneStats> zones;
+	std::string buffer;
+	bool visible = false;
+	int framesSinceRefresh = REFRESH_FRAMES;
+
+	void refresh();
+public:
+	void setFont(const sf::Font& font);
+	void toggle() { visible = !visible; framesSinceRefresh = REFRESH_FRAMES; }
+	bool isVisible() const { return visible; }
+
+	// Draws in the target's current view, at its top-left corner.
+	void draw(sf::RenderTarget& target);
+};
+
+#endif
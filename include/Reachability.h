@@ -0,0 +1,93 @@
+#ifndef REACHABILITY_H
+#define REACHABILITY_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Tile.h"
+
+class Board;
+
+// Shortest walking distance (4-neighbour steps over non-blocked tiles) from
+// a set of source tiles to every tile of a rows x cols grid.
+//
+// update() repairs the field after a single tile changes instead of
+// redoing the whole BFS: a tile that got closer spreads outward from
+// itself, and a tile that got further (blocked, or no longer a source)
+// only invalidates the tiles whose shortest path ran through it and
+// re-solves that region from its still-valid border.
+class DistanceField {
+public:
+	static constexpr int32_t UNREACHABLE = INT32_MAX;
+
+private:
+	int rows = 0, cols = 0;
+	std::vector<int32_t> dist;
+	std::vector<uint8_t> source;
+	// Scratch for updates, kept to avoid reallocating
+	typedef std::pair<int32_t, int> Entry;	// (distance, tile)
+	std::vector<int> queue;
+	std::vector<Entry> open;		// min-heap for increase()
+	std::vector<uint32_t> invalidStamp;
+	uint32_t stamp = 0;
+	int lastUpdateCells = 0;
+
+	bool supported(const uint8_t* walkable, int i) const;
+	void relaxFrom(const uint8_t* walkable, int i);
+	void increase(const uint8_t* walkable, int i);
+public:
+	// walkable: rows * cols flags, row-major; sources: tile indices (r * cols + c).
+	void build(int r, int c, const uint8_t* walkable, const std::vector<int>& sources);
+	// Call after tile i changed walkability or source status.
+	void update(const uint8_t* walkable, int i, bool isSource);
+
+	int32_t at(int r, int c) const { return dist[r * cols + c]; }
+	bool reachable(int r, int c) const { return at(r, c) != UNREACHABLE; }
+	// A neighbour one step closer to the nearest source; false if (r, c) is
+	// a source or cannot reach one.
+	bool nextStep(int r, int c, int& nr, int& nc) const;
+	// Tiles visited by the last update(), for comparing against a rebuild.
+	int getLastUpdateCells() const { return lastUpdateCells; }
+};
+
+// Movement queries for the current level: distance fields from the player
+// start and to the nearest Boss and Exit tile, plus the tiles the player
+// can walk to with the move points of one roll.
+class Reachability {
+public:
+	struct Move {
+		int r, c;
+		int steps;
+		bool battle;	// a Monster/Boss tile: moving there ends the walk in a fight
+	};
+
+private:
+	int rows = 0, cols = 0;
+	int startIndex = 0;
+	std::vector<TileKind> kinds;
+	std::vector<uint8_t> walkable;
+	DistanceField fromStart, toBoss, toExit;
+	std::vector<int> startTiles, bossTiles, exitTiles;	// sources, kept between levels
+	int revision = 0;
+
+	std::vector<Move> moves;
+	std::vector<uint32_t> seenStamp;
+	uint32_t stamp = 0;
+public:
+	// Snapshots the board and builds all fields. Call after every level load.
+	void build(const Board& board, int startR, int startC);
+	// Call after a tile changed on the board (e.g. replaceWithEmpty).
+	void tileChanged(const Board& board, int r, int c);
+
+	const DistanceField& distanceFromStart() const { return fromStart; }
+	const DistanceField& distanceToBoss() const { return toBoss; }
+	const DistanceField& distanceToExit() const { return toExit; }
+	// Bumped whenever a field changes, so cached overlays know to rebuild.
+	int getRevision() const { return revision; }
+
+	// Every tile reachable from (r, c) in 1..movePoints steps, nearest first.
+	// Walks stop at battle tiles. The result is valid until the next call.
+	const std::vector<Move>& movesFrom(int r, int c, int movePoints);
+};
+
+#endif
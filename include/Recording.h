@@ -0,0 +1,41 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Game.h"
+
+// Recorded run (.rrec), all integers little-endian:
+//
+//   header   "RREC" | u16 version | u16 reserved | u64 seed | u64 final state hash | u32 inputCount
+//   inputs   inputCount x { u8 GameInputKind | u8 value }
+//
+// Only inputs the game accepted are stored, and the final hash is taken
+// after settle(), so a replay never needs the original timing. The final
+// hash is Game::stateHash; version 1 stored Game::stateHashV1, which also
+// covers the battle log's position.
+const uint16_t RECORDING_VERSION = 2;
+
+struct GameRecording {
+	uint16_t version = RECORDING_VERSION;
+	uint64_t seed = 0;
+	uint64_t finalHash = 0;
+	std::vector<GameInput> inputs;
+
+	// Captures a game's seed, inputs and current hash (call settle() first).
+	static GameRecording capture(const Game& game);
+
+	bool save(const std::string& path, std::string& error) const;
+	bool load(const std::string& path, std::string& error);
+	bool fromBytes(const uint8_t* data, size_t size, std::string& error);
+};
+
+// The hash a recording of `version` stores for this game.
+uint64_t recordingHash(const Game& game, uint16_t version);
+
+// Replays a recording without a window or delays. Returns false and fills
+// `error` if an input is rejected or the final hash differs.
+bool replayRecording(const GameRecording& rec, const LevelPack& levels, std::string& error);
+
+#endif
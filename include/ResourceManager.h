@@ -0,0 +1,69 @@
+#ifndef RESOURCEMANAGER_H
+#define RESOURCEMANAGER_H
+
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loads textures and fonts in the background. Worker threads do the file
+// I/O and image decoding; the GPU upload happens on the main thread in
+// pump(). Handles are returned immediately and stay valid for the manager's
+// lifetime; they are filled in once their asset is uploaded, so anything
+// that reads a texture's size must wait for its group first.
+class ResourceManager {
+public:
+	typedef std::shared_ptr<sf::Texture> TextureHandle;
+	typedef std::shared_ptr<sf::Font> FontHandle;
+
+private:
+	struct Asset {
+		std::string path;
+		std::string group;
+		bool isFont = false;
+		TextureHandle texture;
+		FontHandle font;
+		sf::Image image;			// decoded pixels, freed after upload
+		std::vector<char> bytes;	// font file, must outlive the sf::Font
+		bool ok = false;
+		bool ready = false;			// uploaded (or failed); main thread only
+		double decodeMs = 0, uploadMs = 0;
+	};
+
+	std::vector<std::unique_ptr<Asset>> assets;
+	std::deque<Asset*> jobs;		// waiting for a worker
+	std::vector<Asset*> decoded;	// waiting for pump()
+	std::mutex mutex;
+	std::condition_variable jobReady, decodedReady;
+	std::vector<std::thread> workers;
+	bool stopping = false;
+
+	void workerLoop();
+	void enqueue(Asset* a);
+	void upload(Asset& a);
+public:
+	explicit ResourceManager(int workerCount = 0);
+	~ResourceManager();
+	ResourceManager(const ResourceManager&) = delete;
+	ResourceManager& operator=(const ResourceManager&) = delete;
+
+	TextureHandle requestTexture(const std::string& path, const std::string& group);
+	FontHandle requestFont(const std::string& path, const std::string& group);
+
+	// Uploads whatever the workers have finished. Call once per frame.
+	void pump();
+	bool isGroupReady(const std::string& group) const;
+	// Pumps until every asset of the group is uploaded.
+	void waitGroup(const std::string& group);
+	bool isLoaded(const std::string& path) const;
+
+	// Per-asset decode/upload times.
+	void printReport(std::ostream& out) const;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SAVEGAME_H
+#define SAVEGAME_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Saved run (.rsav), written by Game::saveSnapshot. All integers little-endian:
+//
+//   header   "RSAV" | u16 version | u16 reserved | u32 payloadSize | u32 checksum (FNV-1a of the payload)
+//            | u32 pack checksum (LevelPack::checksum of the levels the run is on; not in versions 1-2)
+//   run      u64 seed | 4 x u32 Rng state | u8 GameState | u16 levelIndex | u8 movePoints | u8 levelBossDefeated
+//            | u32 inputCount | inputCount x { u8 GameInputKind | u8 value }
+//   level    u16 rows | u16 cols | u32 clearedCount | clearedCount x u32 (r * cols + c)
+//   player   u8 PlayerClass (0xFF before the class is chosen) | entity | u16 posR | u16 posC
+//   battle   u8 inBattle, then if set: u8 EnemyKind | u8 isLevelBoss | entity | u16 row | u16 col
+//            | u8 enemyTurnPending | u8 battleOver | f32 delay | u64 messageStart
+//   log      u64 end | u16 held | held x { u8 type | u8 actor | u8 aux | i32 a | i32 b }
+//
+//   entity   i32 hp | i32 maxHp | i32 attack | i32 defense | i32 mana | u8 defending
+//            | u8 effect mask (bit k: EffectKind k) | per set bit, lowest first: u8 turns | i16 power
+//            (version 1 ends at defending and has no effects)
+//
+// The board is stored as the tiles that differ from the level pack (the
+// enemies already defeated), so a snapshot is a few hundred bytes plus the
+// recorded inputs whatever the board size. The inputs are kept so that a
+// run continued from a save can still be recorded and replayed from its seed.
+// Loading refuses a save made on a different level pack (another campaign
+// build, or endless levels from another level seed).
+const uint16_t SAVE_VERSION = 3;
+
+// Whole-file helpers; both return false and fill `error` on failure.
+// writeSaveFile goes through a temporary file, synced to disk before the
+// rename, so a crash mid-write leaves the previous save intact.
+bool readSaveFile(const std::string& path, std::vector<uint8_t>& out, std::string& error);
+bool writeSaveFile(const std::string& path, const std::vector<uint8_t>& bytes, std::string& error);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "CombatOdds.h"
+#include "Player.h"
+#include "Enemy.h"
+#include <cstdint>
+
+// How the simulated player picks its action each turn.
+enum class SimPolicy {
+	Attack,		// always attack
+	Ability,	// use the special ability whenever mana allows, else attack
+	Search,		// CombatAI expectimax at a fixed depth (deterministic, no time budget)
+	Effects		// an effect ability whose effect is not on yet (self-buffs below half HP), else as Ability
+};
+
+const int SEARCH_POLICY_DEPTH = 4;	// rounds of lookahead for SimPolicy::Search
+
+struct BattleResult {
+	bool playerWon = false;
+	bool fled = false;
+	int turns = 0;
+	int playerHp = 0;
+	int enemyHp = 0;
+	// Tallied from the battle's CombatLog events
+	int playerRolls = 0;	// attack and ability d20 rolls
+	int playerHits = 0;
+	int playerCrits = 0;
+	int enemyHits = 0;
+};
+
+// Aggregated results of many battles of one matchup. Histograms are fixed
+// size so per-thread copies can be merged without allocating.
+struct MatchupStats {
+	static const int TURN_BUCKETS = 64;	// last bucket collects everything longer
+	static const int HP_BUCKETS = 11;	// remaining HP in 10% steps (0%..100%)
+
+	long long battles = 0;
+	long long wins = 0;
+	long long timeouts = 0;
+	long long flees = 0;
+	long long totalTurns = 0;
+	long long playerRolls = 0;
+	long long playerHits = 0;
+	long long playerCrits = 0;
+	long long enemyHits = 0;
+	long long turnHist[TURN_BUCKETS] = {};
+	long long playerHpHist[HP_BUCKETS] = {};	// player HP left on wins
+	long long enemyHpHist[HP_BUCKETS] = {};		// enemy HP left on losses
+
+	void add(const BattleResult& r, int playerMaxHp, int enemyMaxHp);
+	void merge(const MatchupStats& o);
+	double winRate() const { return battles ? double(wins) / battles : 0.0; }
+	double meanTurns() const { return battles ? double(totalTurns) / battles : 0.0; }
+	double playerHitRate() const { return playerRolls ? double(playerHits) / playerRolls : 0.0; }
+	double playerCritRate() const { return playerRolls ? double(playerCrits) / playerRolls : 0.0; }
+	int turnPercentile(double p) const;
+	int hpPercentile(const long long* hist, double p) const;
+};
+
+Enemy* makeEnemy(EnemyKind kind, int levelIndex);
+const char* playerClassName(PlayerClass cls);
+const char* enemyKindName(EnemyKind kind);
+
+// The action `policy` takes this round, and in `ability` (if given) the
+// ability index to use when that action is Ability. Search keeps one
+// CombatAI per thread, whose table carries over between calls.
+CombatAction simPolicyAction(const Player& player, const Enemy& enemy, SimPolicy policy, int* ability = nullptr);
+// The ability index `policy` would use this round, or -1 if it would not
+// use one. Meaningful whenever simPolicyAction says Ability.
+int simPolicyAbility(const Player& player, const Enemy& enemy, SimPolicy policy);
+const char* simPolicyName(SimPolicy policy);
+
+// Plays one battle to the end through CombatSystem. Text is never produced;
+// hit and crit counts are read back from the typed event log.
+// maxTurns guards against the (vanishingly unlikely) endless miss streak.
+BattleResult simulateBattle(Player& player, Enemy& enemy, SimPolicy policy, int maxTurns = 1000);
+
+// Runs `battles` fresh battles of one matchup spread over `threads` workers
+// (0 = hardware concurrency). Each worker owns its entities and stats, and
+// battle i always rolls from Rng(seed, i), so results do not depend on the
+// thread count.
+MatchupStats runMatchup(PlayerClass cls, EnemyKind kind, int levelIndex,
+                        long long battles, SimPolicy policy, int threads = 0,
+                        uint64_t seed = 1);
+
+#endif
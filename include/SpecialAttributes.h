@@ -1,12 +1,19 @@
 #ifndef SPECIALATTRIBUTES_H
 #define SPECIALATTRIBUTES_H
 
-#include <string>
+#include "StatusEffects.h"
 
+// A class ability, as listed in PLAYER_CLASSES (the name is a literal).
+// A use rolls a d20 against minRolls; on success it costs manaCost, deals
+// 2d6 + ATK + atkPowerBonus if dealsDamage, and applies `effect` (to the
+// user or the target, see effectOnSelf). A failed roll costs nothing.
 struct SpecialAttributes {
-	std::string name;
+	const char* name = nullptr;
 	int atkPowerBonus = 0;
 	int minRolls = 0;
+	int manaCost = 5;
+	bool dealsDamage = true;
+	StatusEffect effect = {};
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,62 @@
+#ifndef STATUSEFFECTS_H
+#define STATUSEFFECTS_H
+
+#include <cstdint>
+
+// Timed effects on a combatant, ticked at the start of each of its turns.
+enum class EffectKind : uint8_t {
+	None,
+	Poison,		// loses `power` HP each turn
+	Stun,		// loses its turns
+	Shield,		// absorbs up to `power` damage in total
+	Guard		// every hit is halved, as if defending
+};
+const int EFFECT_KIND_COUNT = 5;
+
+// Shields and guards go on whoever uses the ability, the rest on its target.
+constexpr bool effectOnSelf(EffectKind k) { return k == EffectKind::Shield || k == EffectKind::Guard; }
+const char* effectName(EffectKind k);
+
+struct StatusEffect {
+	EffectKind kind = EffectKind::None;
+	uint8_t turns = 0;		// owner's turns it still lasts
+	int16_t power = 0;		// poison per turn, or shield points left
+};
+
+// What one tick did to the owner.
+struct EffectTick {
+	int poison = 0;			// HP to lose
+	bool stunned = false;	// the owner skips this turn
+	uint8_t expired = 0;	// bit k set: the kind-k effect just ran out
+};
+
+// One slot per kind, so the array never grows: applying an effect the
+// entity already has refreshes it (the longer duration, the higher power)
+// instead of stacking. Plain data, so entities still copy by assignment,
+// and a tick is one pass over the slots with no calls or allocations.
+class StatusEffects {
+public:
+	static const int CAPACITY = EFFECT_KIND_COUNT - 1;
+
+private:
+	StatusEffect slots[CAPACITY];	// slots[k - 1] holds kind k
+	uint8_t active = 0;				// bit k set while slots[k - 1] is in use
+
+public:
+	bool any() const { return active != 0; }
+	bool has(EffectKind k) const { return (active >> (int)k) & 1; }
+	// Only meaningful while has(k)
+	const StatusEffect& get(EffectKind k) const { return slots[(int)k - 1]; }
+	uint8_t activeMask() const { return active; }
+
+	void apply(const StatusEffect& e);
+	void clear() { active = 0; }
+
+	// Counts one of the owner's turns off every effect, dropping those that
+	// run out, and reports what the owner suffers this turn.
+	EffectTick tick();
+	// Takes what it can of `dmg` off the shield; returns the amount absorbed.
+	int absorb(int dmg);
+};
+
+#endif
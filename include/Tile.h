@@ -1,59 +1,30 @@
 #ifndef TILE_H
 #define TILE_H
 
-#include <SFML/Graphics.hpp>
-#include "Player.h"
-
-class Tile {
-protected:
-	sf::Sprite sprite;
-public:
-	virtual ~Tile() {}
-	
-	virtual bool isBlocked() const { return false; }
-	virtual bool isMonster() const { return false; }
-	virtual bool isBoss() const { return false; }
-	virtual bool isExit() const { return false; }
-	
-	virtual void onEnter(Player* p) { (void)p; }
-	
-	sf::Sprite& getSprite() { return sprite; }
-};
-
-class EmptyTile : public Tile {
-public:
-	void onEnter(Player* p) override;
+#include <cstdint>
+
+// What occupies a board cell. Board stores one of these per cell in a flat
+// array, so tile queries are a plain indexed load with no virtual dispatch.
+enum class TileKind : uint8_t {
+	Empty,
+	Blocked,
+	Monster,
+	Boss,
+	Exit
 };
 
-class BlockedTile : public Tile {
-public:
-	bool isBlocked() const override { return true; }
-};
+const int TILE_KIND_COUNT = 5;
 
-class MonsterTile : public Tile {
-private:
-	bool combatTriggered = false;
-public:
-	bool isMonster() const override { return true; }
-	void onEnter(Player* p) override;
-	bool shouldTriggerCombat() const { return combatTriggered; }
-	void resetCombatTrigger() { combatTriggered = false; }
+// Per-cell state bits kept in Board's side table.
+enum TileFlag : uint8_t {
+	TILE_COMBAT_TRIGGERED = 1 << 0
 };
 
-class BossTile : public Tile {
-private:
-	bool combatTriggered = false;
-public:
-	bool isBoss() const override { return true; }
-	void onEnter(Player* p) override;
-	bool shouldTriggerCombat() const { return combatTriggered; }
-	void resetCombatTrigger() { combatTriggered = false; }
-};
+inline bool isBlockedKind(TileKind k) { return k == TileKind::Blocked; }
+inline bool isCombatKind(TileKind k) { return k == TileKind::Monster || k == TileKind::Boss; }
 
-class ExitTile : public Tile {
-public:
-	bool isExit() const override { return true; }
-	void onEnter(Player* p) override;
-};
+// Maps a level layout character ('N', 'B', 'M', 'T', 'E', 'P') to its kind.
+// 'P' and unknown characters are plain floor.
+TileKind tileKindFromChar(char ch);
 
-#endif
\ No newline at end of file
+#endif
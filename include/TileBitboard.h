@@ -0,0 +1,42 @@
+#ifndef TILEBITBOARD_H
+#define TILEBITBOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Tile.h"
+
+// One bit per board cell, each row packed into ceil(cols / 64) words (cell c
+// is bit c % 64 of word c / 64, so rows of any width work). Connectivity
+// questions become whole-row shifts and masks instead of a BFS per cell.
+class TileBitboard {
+private:
+	int rows = 0, cols = 0, words = 0;
+	std::vector<uint64_t> bits;
+	std::vector<uint64_t> scratch;		// two rows, for fillRow
+
+	void fillRow(uint64_t* row, const uint64_t* open);
+	bool sweep(const TileBitboard& open, bool down);
+
+public:
+	// Resizes to rows x cols with every bit clear; keeps the storage.
+	void reset(int rows, int cols);
+	// Sets exactly the cells a player can stand on (everything not Blocked).
+	void setOpen(int rows, int cols, const TileKind* tiles);
+
+	int getRows() const { return rows; }
+	int getCols() const { return cols; }
+	void set(int r, int c) { bits[(size_t)r * words + (c >> 6)] |= 1ull << (c & 63); }
+	bool test(int r, int c) const { return (bits[(size_t)r * words + (c >> 6)] >> (c & 63)) & 1; }
+
+	// Grows the set cells to every cell 4-connected to them through `open`
+	// (same size); set cells outside `open` are dropped first.
+	void floodFill(const TileBitboard& open);
+};
+
+// Whether the player's start reaches every Boss and Exit tile without
+// crossing a Blocked one (monsters are in the way, not walls). Keeps its
+// bitboards per thread, so it allocates only when a board grows.
+bool levelIsConnected(int rows, int cols, const TileKind* tiles, int startR, int startC);
+
+#endif
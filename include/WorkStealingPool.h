@@ -0,0 +1,64 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for loops whose iterations take very
+// different times (a run that dies on level 1 against one that clears the
+// campaign). parallelFor deals [0, count) out to the workers as one
+// contiguous range each; a worker eats its own range from the front, `grain`
+// indices at a time, and when it runs dry steals the back half of the next
+// range that still has some left. Each range sits behind its own lock,
+// which only a thief ever contends for, so the workers share nothing while
+// they all have work.
+class WorkStealingPool {
+public:
+	// worker is in [0, size()), so callers can keep per-worker state.
+	using RangeFn = std::function<void(int worker, long long begin, long long end)>;
+
+private:
+	struct alignas(64) Slot {
+		std::mutex mutex;
+		long long begin = 0, end = 0;
+	};
+
+	std::vector<std::thread> threads;
+	std::unique_ptr<Slot[]> slots;
+	int workerCount;
+
+	std::mutex jobMutex;
+	std::condition_variable jobStart, jobDone;
+	const RangeFn* job = nullptr;
+	long long grain = 1;
+	uint64_t jobGeneration = 0;
+	int running = 0;
+	bool stopping = false;
+	long long steals = 0;		// guarded by jobMutex, summed when workers finish
+
+	void workerLoop(int worker);
+	bool takeOwn(int worker, long long& begin, long long& end);
+	bool steal(int worker);
+
+public:
+	// 0 = hardware concurrency.
+	explicit WorkStealingPool(int threads = 0);
+	~WorkStealingPool();
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	int size() const { return workerCount; }
+
+	// Calls fn over every index in [0, count), in pieces of at most `grain`,
+	// and returns once all of them are done. One loop at a time.
+	void parallelFor(long long count, long long grain, const RangeFn& fn);
+	// Ranges taken from another worker during the last parallelFor.
+	long long getSteals() const { return steals; }
+};
+
+#endif
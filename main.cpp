@@ -4,13 +4,29 @@
 #include <string>
 #include <functional>
 #include <algorithm> // For min/max
-#include <sstream>  
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
 
+#include "include/Autosave.h"
 #include "include/Dice.h"
 #include "include/Player.h"
+#include "include/Profiler.h"
+#include "include/ProfilerOverlay.h"
 #include "include/Enemy.h"
-#include "include/CombatSystem.h"
+#include "include/CombatLog.h"
+#include "include/CombatAI.h"
+#include "include/Game.h"
 #include "include/Board.h"
+#include "include/BoardRenderer.h"
+#include "include/CachedText.h"
+#include "include/LevelGen.h"
+#include "include/LevelPack.h"
+#include "include/Reachability.h"
+#include "include/Recording.h"
+#include "include/ResourceManager.h"
+#include "include/SaveGame.h"
 #include "include/Tile.h"
 #include "include/GameState.h"
 #include "include/UIButton.h"
@@ -38,183 +54,209 @@ Button createButton(float x, float y, float w, float h, const string& txt, sf::F
     return b;
 }
 
-// --- HELPER FUNCTION: LOAD LEVEL ---
-void loadLevel(int levelIdx, const vector<vector<string>>& allLevels, Board& board, 
-               int rows, int cols, int& pStartR, int& pStartC,
-               sf::Texture& tEmpty, sf::Texture& tBlocked, 
-               sf::Texture& tMonster, sf::Texture& tBoss, sf::Texture& tExit) 
+// --- HELPER FUNCTION: CAMERA ---
+// Keeps the player centred but never scrolls past the board edges.
+// Boards smaller than the view stay centred.
+sf::Vector2f cameraCenter(const Board& board, float ts, const Player& player, sf::Vector2f viewSize)
 {
-    if(levelIdx >= allLevels.size()) return;
-    const vector<string>& layout = allLevels[levelIdx];
-    
-    for (int r = 0; r < rows; r++){
-        for (int c = 0; c < cols; c++){
-            char ch = layout[r][c];
-            if (ch=='N') board.setTile(r,c,new EmptyTile(), tEmpty); 
-            else if (ch=='B') board.setTile(r,c,new BlockedTile(), tBlocked);
-            else if (ch=='M') board.setTile(r,c,new MonsterTile(), tMonster);
-            else if (ch=='T') board.setTile(r,c,new BossTile(), tBoss);
-            else if (ch=='E') board.setTile(r,c,new ExitTile(), tExit);
-            else if (ch=='P') { 
-                board.setTile(r,c,new EmptyTile(), tEmpty); 
-                pStartR = r; pStartC = c; 
-            }
-            else board.setTile(r,c,new EmptyTile(), tEmpty);
-        }
-    }
-    cout << "Loaded Level " << levelIdx + 1 << endl;
+    float boardW = board.getCols() * ts, boardH = board.getRows() * ts;
+    float x = player.posC * ts + ts / 2, y = player.posR * ts + ts / 2;
+
+    if (boardW <= viewSize.x) x = boardW / 2;
+    else x = max(viewSize.x / 2, min(x, boardW - viewSize.x / 2));
+    if (boardH <= viewSize.y) y = boardH / 2;
+    else y = max(viewSize.y / 2, min(y, boardH - viewSize.y / 2));
+    return sf::Vector2f(x, y);
 }
 
-// --- HELPER FUNCTION: START BATTLE ---
-void startBattle(int r, int c, bool isBoss, int levelIndex, 
-                 Player* player, Enemy*& curEnemy, 
-                 CombatSystem*& combatSys, 
-                 int& enemyR, int& enemyC, GameState& state, string& msg,
-                 stringstream& ss)
+// --- HELPER FUNCTION: MOVE HIGHLIGHT ---
+// One translucent quad per tile the player can walk to with the current
+// roll; tiles that start a battle are tinted red.
+void buildMoveHighlight(const vector<Reachability::Move>& moves, float tileSize, sf::VertexArray& out)
 {
-    ss.str(""); 
-    ss.clear();
-    ss << "--- Battle start ---\n";
-
-    if (curEnemy) { delete curEnemy; curEnemy = nullptr; }
-    if (combatSys) { delete combatSys; combatSys = nullptr; }
-
-    if (isBoss) {
-        int hpBonus = levelIndex * 3;
-        int atkBonus = levelIndex * 2;
-        curEnemy = new Boss("Dungeon Lord", 3, 30+ hpBonus,6+ atkBonus , 8);
-    } else {
-        int hpBonus = levelIndex * 5;
-        int atkBonus = levelIndex * 2;
-        if (D20().roll() > 15) curEnemy = new Monster("Ogre", 1, 35 + hpBonus, 6 + atkBonus);
-        else curEnemy = new Monster("Goblin", 18, 5 + hpBonus, 2 + atkBonus);
+    out.setPrimitiveType(sf::Quads);
+    out.resize(moves.size() * 4);
+    for (size_t i = 0; i < moves.size(); i++) {
+        const Reachability::Move& m = moves[i];
+        sf::Color color = m.battle ? sf::Color(220, 40, 40, 90) : sf::Color(60, 200, 90, 70);
+        float x = m.c * tileSize, y = m.r * tileSize;
+        sf::Vertex* quad = &out[i * 4];
+        quad[0].position = sf::Vector2f(x, y);
+        quad[1].position = sf::Vector2f(x + tileSize, y);
+        quad[2].position = sf::Vector2f(x + tileSize, y + tileSize);
+        quad[3].position = sf::Vector2f(x, y + tileSize);
+        for (int k = 0; k < 4; k++) quad[k].color = color;
     }
-    
-    combatSys = new CombatSystem(player, curEnemy, ss);
-    
-    enemyR = r; 
-    enemyC = c;
-    state = GameState::InBattle;
-    
-    player->resetDefend();
-    
-    ss << player->name << " vs " << curEnemy->name;
-    msg = ss.str(); 
 }
 
-// --- HELPER FUNCTION: CHECK BATTLE STATUS ---
-// MODIFIED: This function NO LONGER deletes the enemy or changes state immediately.
-// It simply detects if the battle ended, updates the log, and sets the 'battleOver' flag.
-void checkBattleStatus(Player* player, Enemy* curEnemy, 
-                    CombatSystem* combatSys, 
-                    bool& bossDefeated, bool isLevelBossBattle,
-                    stringstream& ss,
-                    bool& battleOver, sf::Clock& battleDelayClock)
-{
-    if (!curEnemy || !combatSys) return;
-
-    if (combatSys->isEnemyDefeated()) {
-        ss << "\n" << curEnemy->name << " defeated! +5 HP.";
-        player->hp = min(player->hp + 5, player->maxHp);
+// --- HELPER: FRAME STATS ---
+// Render times of drawn frames, summarised at exit together with how much
+// CPU the process used while the window was open. Frames are counted into
+// fixed 0.1 ms buckets (the last one takes everything from 50 ms up), so a
+// session of any length uses the same memory; percentiles are read off the
+// buckets, the average and max are exact.
+struct FrameStats {
+    static const int BUCKETS = 500;
+    static constexpr double BUCKET_MS = 0.1;
+    long long counts[BUCKETS] = {};
+    long long frames = 0;
+    double totalMs = 0, maxMs = 0;
+
+    void add(double ms) {
+        int b = (int)(ms / BUCKET_MS);
+        counts[min(max(b, 0), BUCKETS - 1)]++;
+        frames++;
+        totalMs += ms;
+        maxMs = max(maxMs, ms);
+    }
 
-        if (isLevelBossBattle) {
-            bossDefeated = true;
-            ss << "\n>>> BOSS DEFEATED! Exit UNLOCKED! <<<";
-            cout << ">>> DUNGEON BOSS DEFEATED! The Exit is now UNLOCKED! <<<\n";
+    // Upper edge of the bucket holding the frame at rank `rank` (0-based), capped at the max
+    double at(long long rank) const {
+        long long seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += counts[b];
+            if (seen > rank) return min((b + 1) * BUCKET_MS, maxMs);
         }
-        
-        // Trigger the end sequence
-        battleOver = true;
-        battleDelayClock.restart();
+        return maxMs;
+    }
 
-    } else if (combatSys->isPlayerDefeated()) {
-        ss << "\n" << player->name << " died.";
-        cout << player->name << " died. Game Over.\n";
-        
-        // Trigger the end sequence
-        battleOver = true;
-        battleDelayClock.restart();
+    void print(ostream& out, double wallSeconds, double cpuSeconds) const {
+        out << fixed << setprecision(2);
+        out << "[Perf] " << wallSeconds << " s open, CPU " << cpuSeconds << " s ("
+            << (wallSeconds > 0 ? 100.0 * cpuSeconds / wallSeconds : 0.0) << "% of one core), "
+            << frames << " frames drawn\n";
+        if (frames == 0) return;
+        out << "[Perf] frame time avg " << totalMs / frames
+            << " ms, p50 " << at(frames / 2)
+            << " ms, p95 " << at(min(frames - 1, frames * 95 / 100))
+            << " ms, max " << maxMs << " ms\n";
     }
-}
+};
+
+int main(int argc, char** argv) {
+    auto startupBegin = chrono::steady_clock::now();
+
+    // --- RNG SEED --- (pass --seed N to replay a run, --record FILE to save
+    // the run for tools/replay, --continue to resume the autosave, --save FILE
+    // to autosave somewhere else, --trace FILE for where F4 writes a trace,
+    // --endless to play generated levels, rolled from --level-seed N)
+    unsigned long long seed = (unsigned long long)chrono::steady_clock::now().time_since_epoch().count();
+    unsigned long long levelSeed = 1;
+    string recordPath;
+    string savePath;
+    string tracePath = "trace.json";
+    bool continueRun = false;
+    bool endless = false;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--continue") continueRun = true;
+        if (string(argv[i]) == "--endless") endless = true;
+        if (i + 1 >= argc) continue;
+        bool seedArg = string(argv[i]) == "--seed", levelSeedArg = string(argv[i]) == "--level-seed";
+        if ((seedArg || levelSeedArg) && !parseSeed(argv[i + 1], seedArg ? seed : levelSeed)) {
+            cerr << "usage: " << argv[0] << " [--seed N] [--level-seed N] ...: " << argv[i] << " needs a whole number, got '"
+                 << argv[i + 1] << "'\n";
+            return 1;
+        }
+        if (string(argv[i]) == "--record") recordPath = argv[i + 1];
+        if (string(argv[i]) == "--save") savePath = argv[i + 1];
+        if (string(argv[i]) == "--trace") tracePath = argv[i + 1];
+    }
+    // A save only loads into the pack it was taken with, and each level seed
+    // rolls its own endless pack, so every level seed keeps its own save
+    if (savePath.empty()) savePath = endless ? "endless-" + to_string(levelSeed) + ".rsav" : "autosave.rsav";
+    cout << "RNG seed: " << seed << endl;
 
-int main() {
     const int ROWS = 10, COLS = 10;
     const float TILE_SIZE = 80.f; 
     const int WINDOW_W = int(COLS * TILE_SIZE);
     const int WINDOW_H = int(ROWS * TILE_SIZE + 100); 
 
     sf::RenderWindow window(sf::VideoMode(WINDOW_W, WINDOW_H), "RogueEmblem - OOP Project");
-    window.setFramerateLimit(120);
+    // No frame limit or vsync: the loop below only redraws when something
+    // changed and sleeps otherwise
+    const float TICK = 1.f / 60.f;         // simulation step
+    const float MAX_FRAME_TIME = 0.25f;    // catch up at most this much after a stall
+    bool needsRedraw = true;
+
+    // Camera for the map area above the HUD; follows the player on big boards
+    const float BOARD_VIEW_H = ROWS * TILE_SIZE;
+    sf::View boardView(sf::FloatRect(0, 0, WINDOW_W, BOARD_VIEW_H));
+    boardView.setViewport(sf::FloatRect(0, 0, 1.f, BOARD_VIEW_H / WINDOW_H));
 
     // --- ASSET LOADING ---
-    sf::Texture texEmpty, texBlocked, texMonster, texBoss, texExit, texPlayer;
-    if (!texEmpty.loadFromFile("assets/normal.png"))    cerr << "Warn: missing assets/normal.png\n";
-    if (!texBlocked.loadFromFile("assets/blocked.png")) cerr << "Warn: missing assets/blocked.png\n";
-    if (!texMonster.loadFromFile("assets/monster.png")) cerr << "Warn: missing assets/monster.png\n";
-    if (!texBoss.loadFromFile("assets/Boss.jpg"))       cerr << "Warn: missing assets/boss.png\n";
-    if (!texExit.loadFromFile("assets/exit.png"))       cerr << "Warn: missing assets/exit.png\n";
-    if (!texPlayer.loadFromFile("assets/player2.jpg"))  cerr << "Warn: missing assets/player.png\n";
-    sf::Texture texSoldier, texArcher, texMage;
-    if (!texSoldier.loadFromFile("assets/soldier.jpg")) cerr << "Warn: missing assets/soldier.jpg\n";
-    if (!texArcher.loadFromFile("assets/Archer.png"))   cerr << "Warn: missing assets/archer.jpg\n";
-    if (!texMage.loadFromFile("assets/Mage.jpeg"))       cerr << "Warn: missing assets/mage.jpg\n";
-    sf::Texture texMenuBg;
-    if (!texMenuBg.loadFromFile("assets/menu_bg.jpg")) cerr << "Warn: missing assets/menu_bg.jpg\n";
-    sf::Texture texBattleBg, texPortraitPlayer, texPortraitEnemy;
-    if (!texBattleBg.loadFromFile("assets/battle_bg.jpg"))           cerr << "Warn: missing assets/battle_bg.png\n";
-    if (!texPortraitPlayer.loadFromFile("assets/portrait_player.jpg")) cerr << "Warn: missing assets/portrait_player.png\n";
-    if (!texPortraitEnemy.loadFromFile("assets/portrait_enemy.png"))   cerr << "Warn: missing assets/portrait_enemy.png\n";
-    
-    sf::Font font;
-    bool fontOk = true;
-    if (!font.loadFromFile("assets/Arial.ttf")) {
-        cerr << "Warn: missing assets/Arial.ttf\n";
-        fontOk = false;
+    // Workers decode everything in parallel; the menu only waits for its own
+    // group and the rest is uploaded frame by frame while the menu is shown.
+    ResourceManager resources;
+    sf::Texture& texMenuBg = *resources.requestTexture("assets/menu_bg.jpg", "menu");
+    sf::Font& font = *resources.requestFont("assets/Arial.ttf", "menu");
+
+    sf::Texture& texEmpty   = *resources.requestTexture("assets/normal.png", "game");
+    sf::Texture& texBlocked = *resources.requestTexture("assets/blocked.png", "game");
+    sf::Texture& texMonster = *resources.requestTexture("assets/monster.png", "game");
+    sf::Texture& texBoss    = *resources.requestTexture("assets/Boss.jpg", "game");
+    sf::Texture& texExit    = *resources.requestTexture("assets/exit.png", "game");
+    sf::Texture& texPlayer  = *resources.requestTexture("assets/player2.jpg", "game");
+    sf::Texture& texArcher  = *resources.requestTexture("assets/Archer.png", "game");
+    sf::Texture& texMage    = *resources.requestTexture("assets/Mage.jpeg", "game");
+    sf::Texture& texBattleBg       = *resources.requestTexture("assets/battle_bg.jpg", "game");
+    sf::Texture& texPortraitPlayer = *resources.requestTexture("assets/portrait_player.jpg", "game");
+    sf::Texture& texPortraitEnemy  = *resources.requestTexture("assets/portrait_enemy.png", "game");
+
+    resources.waitGroup("menu");
+    bool fontOk = resources.isLoaded("assets/Arial.ttf");
+    bool gameAssetsBound = false;
+    function<void()> bindGameAssets;   // set up once the UI objects below exist
+
+    // --- LEVEL DATA --- (compiled from assets/levels.txt by tools/levelc,
+    // or generated on every core in endless mode)
+    LevelPack levels;
+    string levelError;
+    if (endless) {
+        auto genStart = chrono::steady_clock::now();
+        WorkStealingPool pool;
+        if (!generateEndlessPack(ENDLESS_LEVELS, levelSeed, pool, levels, levelError)) {
+            cerr << "Error: " << levelError << "\n";
+            return 1;
+        }
+        cout << "[Endless] generated " << levels.count() << " levels (level seed " << levelSeed << ") in "
+             << chrono::duration<double, milli>(chrono::steady_clock::now() - genStart).count() << " ms\n";
+    } else if (!levels.open("assets/levels.rlv", levelError)) {
+        cerr << "Warn: " << levelError << ", compiling assets/levels.txt instead\n";
+        if (!levels.compileFromFile("assets/levels.txt", levelError)) {
+            cerr << "Error: " << levelError << "\n";
+            return 1;
+        }
     }
 
-    // --- LEVEL DATA ---
-    vector<vector<string>> allLevels = {
-        { "PNNNBNNNNN", "NBBNBNMNBN", "NNNNBBNNNN", "NBNBNBNBNN", "NNNNNNNBNN", "NBNNBNNNNN", "NNBBNBNNBN", "BNNNNNNNNN", "BBNNNNBNMB", "ENNNBNNNNT" },
-        { "PBBBNNNNNN", "NBBBNBBNBN", "NNNNNBBMMM", "BBBBBBBBNB", "NNNNNNNNNB", "NBBNBBBBBB", "NBBMMNNNNN", "NNNBBBBBNB", "BNNNNNNNNB", "BBBBBBBNET" },
-        { "PNNMNNNMNN", "BBNBNBNBBN", "NNNBNBNBNN", "MBBBBBBBBM", "NNNNNNNNNN", "TBBBNBNBBT", "NNNBNBNBNN", "BBBNNNNNBB", "NNMNNNNMNN", "NNNNETNNNN" }
-    };
-
-    int currentLevelIndex = 0;
-    int playerStartR = 0, playerStartC = 0;
-    Board board(ROWS, COLS, TILE_SIZE);
+    // --- GAME LOGIC --- everything the window shows comes from here, and
+    // every click or key that changes it goes through game.apply
+    Game game(levels, seed, cout);
+    Board& board = game.getBoard();
+    BoardRenderer boardRenderer(TILE_SIZE);
+    boardRenderer.setTexture(TileKind::Empty, texEmpty);
+    boardRenderer.setTexture(TileKind::Blocked, texBlocked);
+    boardRenderer.setTexture(TileKind::Monster, texMonster);
+    boardRenderer.setTexture(TileKind::Boss, texBoss);
+    boardRenderer.setTexture(TileKind::Exit, texExit);
     sf::Sprite menuBgSprite;
     menuBgSprite.setTexture(texMenuBg);
     float bgScaleX = (float)WINDOW_W / texMenuBg.getSize().x;
     float bgScaleY = (float)WINDOW_H / texMenuBg.getSize().y;
     menuBgSprite.setScale(bgScaleX, bgScaleY);
 
-    loadLevel(currentLevelIndex, allLevels, board, ROWS, COLS, playerStartR, playerStartC, 
-              texEmpty, texBlocked, texMonster, texBoss, texExit);
-
-    Player* player = nullptr;
-    
     sf::Sprite playerSprite; 
-    playerSprite.setTexture(texPlayer); 
     playerSprite.setScale(1.25f, 1.25f);
-    int movePoints = 0;
-    GameState state = GameState::MainMenu;
-    
-    // --- BATTLE VARIABLES ---
-    string battleMessage;
-    std::stringstream battleLogStream; 
-    sf::Clock battleDelayClock;
+    CachedText hudText;   // exploration HUD line, set up with the battle text below
     
-    // Flags for flow control
-    bool enemyTurnPending = false; // Waiting for enemy to attack?
-    bool battleOver = false;       // Has the fight ended (waiting for victory screen delay)?
-    
-    bool levelBossDefeated = false;     
-    bool isFightingLevelBoss = false;   
+    // Auto-battle: press A in a battle to let the search pick the player's moves
+    CombatAI battleAI;
+    bool autoBattle = false;
 
-    Enemy* currentEnemy = nullptr; 
-    CombatSystem* combatSystem = nullptr;
-    
-    int enemyRow = -1, enemyCol = -1;
+    bool reportBoardDrawCalls = true;
+
+    // Tiles reachable with the current roll, drawn over the board
+    sf::VertexArray moveHighlight;
+    int highlightR = -1, highlightC = -1, highlightPoints = -1, highlightRevision = -1;
 
     // --- UI SETUP ---
     sf::Text titleText("RogueEmblem", font, 48);
@@ -227,143 +269,83 @@ int main() {
     // --- MAIN MENU BUTTONS ---
     vector<Button> menuButtons;
     sf::RectangleShape playerBox(sf::Vector2f(250, 300));
-    playerBox.setTexture(&texPortraitPlayer);               
     playerBox.setPosition(100,350);
     
     menuButtons.push_back(createButton(WINDOW_W/2 - 100, 250, 200, 50, "Soldier", font, fontOk, [&](){
-        if(player) delete player; 
-        player = new Soldier(playerStartR, playerStartC);
-        state = GameState::Exploring;
-        playerSprite.setPosition(player->posC * TILE_SIZE, player->posR * TILE_SIZE);
+        bindGameAssets();
+        if (!game.apply({GameInputKind::ChooseClass, (uint8_t)PlayerClass::Soldier})) return;
+        hudText.invalidate();
     }));
     
     menuButtons.push_back(createButton(WINDOW_W/2 - 100, 320, 200, 50, "Archer", font, fontOk, [&](){
-        if(player) delete player;
-        player = new Archer(playerStartR, playerStartC);
-        state = GameState::Exploring;
+        bindGameAssets();
+        if (!game.apply({GameInputKind::ChooseClass, (uint8_t)PlayerClass::Archer})) return;
+        hudText.invalidate();
         playerBox.setTexture(&texArcher);
-        playerSprite.setPosition(player->posC * TILE_SIZE, player->posR * TILE_SIZE);
     }));
     
     menuButtons.push_back(createButton(WINDOW_W/2 - 100, 390, 200, 50, "Mage", font, fontOk, [&](){
-        if(player) delete player;
-        player = new Mage(playerStartR, playerStartC);
-        state = GameState::Exploring;
+        bindGameAssets();
+        if (!game.apply({GameInputKind::ChooseClass, (uint8_t)PlayerClass::Mage})) return;
+        hudText.invalidate();
         playerBox.setTexture(&texMage); 
-        playerSprite.setPosition(player->posC * TILE_SIZE, player->posR * TILE_SIZE);
     }));
 
-    // --- BATTLE BUTTONS ---
+    // --- BATTLE BUTTONS --- (in CombatAction order, so the auto-battle can
+    // press them by index)
     vector<Button> battleButtons;
     const float btnW = 160, btnH = 40;
     float battleBtnY = WINDOW_H - 70.f;
-
-    // BUTTON: ATTACK
-    battleButtons.push_back(createButton(20, battleBtnY, btnW, btnH, "Attack", font, fontOk, [&](){
-        if (state != GameState::InBattle || !combatSystem) return;
-        if (enemyTurnPending || battleOver) return; // Wait for animations/end
-        
-        battleLogStream.str(""); 
-        battleLogStream.clear();
-
-        // 1. Player Attack
-        combatSystem->attack();
-        
-        // 2. Check Result
-        checkBattleStatus(player, currentEnemy, combatSystem, levelBossDefeated, isFightingLevelBoss, battleLogStream, battleOver, battleDelayClock);
-        
-        // 3. If battle continues, queue Enemy Turn
-        if (!battleOver) {
-             enemyTurnPending = true;
-             battleDelayClock.restart();
-
-        }
-
-        battleMessage = battleLogStream.str();
-    }));
-
-    // BUTTON: DEFEND
-    battleButtons.push_back(createButton(210, battleBtnY, btnW, btnH, "Defend", font, fontOk, [&](){
-        if (state != GameState::InBattle || !combatSystem) return;
-        if (enemyTurnPending || battleOver) return;
-
-        battleLogStream.str(""); 
-        battleLogStream.clear();
-
-        combatSystem->defend(); 
-        
-        // Always triggers enemy turn
-        enemyTurnPending = true;
-        battleDelayClock.restart();
-
-        
-        battleMessage = battleLogStream.str();
-    }));
-
-    // BUTTON: ABILITY
-    battleButtons.push_back(createButton(400, battleBtnY, btnW, btnH, "Ability", font, fontOk, [&](){
-        if (state != GameState::InBattle || !combatSystem) return;
-        if (enemyTurnPending || battleOver) return;
-
-        battleLogStream.str(""); 
-        battleLogStream.clear();
-
-        combatSystem->ability(); 
-        
-        checkBattleStatus(player, currentEnemy, combatSystem, levelBossDefeated, isFightingLevelBoss, battleLogStream, battleOver, battleDelayClock);
-        
-        if (!battleOver) {
-             enemyTurnPending = true;
-             battleDelayClock.restart();
-        }
-        
-        battleMessage = battleLogStream.str();
-    }));
-
-    // BUTTON: RUN
-    battleButtons.push_back(createButton(590, battleBtnY, btnW, btnH, "Run", font, fontOk, [&](){
-        if (state != GameState::InBattle || !combatSystem) return;
-        if (enemyTurnPending || battleOver) return;
-        
-        battleLogStream.str(""); 
-        battleLogStream.clear();
-
-        if (combatSystem->run()) {
-            Tile* t = board.getTile(player->posR, player->posC);
-            if (MonsterTile* mt = dynamic_cast<MonsterTile*>(t)) { mt->resetCombatTrigger(); }
-            if (BossTile* bt = dynamic_cast<BossTile*>(t)) { bt->resetCombatTrigger(); }
-            
-            delete currentEnemy; currentEnemy = nullptr;
-            delete combatSystem; combatSystem = nullptr;
-            
-            state = GameState::Exploring;
-            battleMessage = "You fled!";
-        } else {
-            // Run failed, enemy turn delayed
-            enemyTurnPending = true;
-            battleDelayClock.restart();;
-            battleMessage = battleLogStream.str();
+    const char* battleLabels[COMBAT_ACTION_COUNT] = { "Attack", "Defend", "Ability", "Run" };
+    for (int i = 0; i < COMBAT_ACTION_COUNT; i++) {
+        battleButtons.push_back(createButton(20 + 190.f * i, battleBtnY, btnW, btnH, battleLabels[i], font, fontOk, [&game, i](){
+            // Ignored while the enemy's turn or the battle's end is pending
+            game.apply({GameInputKind::BattleAction, (uint8_t)i});
+        }));
+    }
+    // A row above for each class's other abilities (the Ability button uses
+    // the first); the class table is fixed, so every class's row is built here
+    vector<Button> abilityButtons[PLAYER_CLASS_COUNT];
+    for (int c = 0; c < PLAYER_CLASS_COUNT; c++) {
+        const PlayerClassDef& def = PLAYER_CLASSES[c];
+        for (int i = 1; i < def.abilityCount; i++) {
+            string label = string(def.abilities[i].name) + " (" + to_string(def.abilities[i].manaCost) + ")";
+            abilityButtons[c].push_back(createButton(20 + 190.f * (i - 1), battleBtnY - 50, btnW, btnH, label, font, fontOk, [&game, i](){
+                game.apply({GameInputKind::BattleAction, battleInputValue(CombatAction::Ability, i)});
+            }));
         }
-    }));
+    }
+    auto classAbilityButtons = [&]() -> vector<Button>& {
+        return abilityButtons[game.getPlayer() ? (int)game.getPlayer()->getClass() : 0];
+    };
 
     // --- BATTLE UI BARS ---
     sf::RectangleShape battleBgRect(sf::Vector2f(WINDOW_W, WINDOW_H));
-    battleBgRect.setTexture(&texBattleBg);
 
     sf::RectangleShape enemyBox(sf::Vector2f(250, 300));
-    enemyBox.setTexture(&texPortraitEnemy);     
     enemyBox.setPosition(WINDOW_W - 350, 350);
 
-    sf::Text playerBattleName, enemyBattleName, battleLogText;
+    // Retained text: only re-laid out when the values behind it change
+    CachedText playerBattleName, enemyBattleName, battleLogText;
     if(fontOk) {
-        playerBattleName.setFont(font); playerBattleName.setCharacterSize(24); playerBattleName.setFillColor(sf::Color::White);
-        enemyBattleName.setFont(font); enemyBattleName.setCharacterSize(24); enemyBattleName.setFillColor(sf::Color::White);
+        playerBattleName.text.setFont(font); playerBattleName.text.setCharacterSize(24); playerBattleName.text.setFillColor(sf::Color::White);
+        playerBattleName.text.setPosition(playerBox.getPosition().x + 20, playerBox.getPosition().y - 70);
+        enemyBattleName.text.setFont(font); enemyBattleName.text.setCharacterSize(24); enemyBattleName.text.setFillColor(sf::Color::White);
+        enemyBattleName.text.setPosition(enemyBox.getPosition().x + 20, enemyBox.getPosition().y - 70);
         
-        battleLogText.setFont(font); 
-        battleLogText.setCharacterSize(20); 
-        battleLogText.setFillColor(sf::Color::White);
-        battleLogText.setPosition(50, WINDOW_H - 250);
+        battleLogText.text.setFont(font); 
+        battleLogText.text.setCharacterSize(20); 
+        battleLogText.text.setFillColor(sf::Color::White);
+        battleLogText.text.setPosition(50, WINDOW_H - 250);
+
+        hudText.text.setFont(font); hudText.text.setCharacterSize(16); hudText.text.setFillColor(sf::Color::White);
+        hudText.text.setPosition(10, ROWS*TILE_SIZE + 10);
     }
+
+    // F3 shows per-phase timings, F4 starts/stops a Chrome trace capture
+    // (both need a build with ROGUE_PROFILE)
+    ProfilerOverlay profilerOverlay;
+    if (fontOk) profilerOverlay.setFont(font);
     
     const float BAR_WIDTH = 200, BAR_HEIGHT = 25;
     sf::RectangleShape playerHpBarBack(sf::Vector2f(BAR_WIDTH, BAR_HEIGHT)); playerHpBarBack.setFillColor(sf::Color(50, 50, 50));
@@ -371,142 +353,69 @@ int main() {
     sf::RectangleShape enemyHpBarBack(sf::Vector2f(BAR_WIDTH, BAR_HEIGHT)); enemyHpBarBack.setFillColor(sf::Color(50, 50, 50));
     sf::RectangleShape enemyHpBarFront(sf::Vector2f(BAR_WIDTH, BAR_HEIGHT)); enemyHpBarFront.setFillColor(sf::Color::Red);
 
-    // --- GAME LOOP ---
-    while (window.isOpen()) {
-        
-        // --- DELAYED EVENTS HANDLING ---
-        
-        // 1. Handle Enemy Turn Delay
-        if (state == GameState::InBattle && enemyTurnPending && !battleOver) {
-            if (battleDelayClock.getElapsedTime().asSeconds() > 1.5f) {
-                battleLogStream << "\n"; // Spacer
-                combatSystem->enemyTurn();
-                
-                checkBattleStatus(player, currentEnemy, combatSystem, levelBossDefeated, isFightingLevelBoss, battleLogStream, battleOver, battleDelayClock);
-                
-                battleMessage = battleLogStream.str();
-                enemyTurnPending = false;
-            }
-        }
-        
-
-        if (state == GameState::InBattle && battleOver) {
-            if (battleDelayClock.getElapsedTime().asSeconds() > 2.0f) {
- 
-                
-                if (combatSystem->isPlayerDefeated()) {
-                    state = GameState::GameOver;
-                } else {
-
-                    board.replaceWithEmpty(enemyRow, enemyCol, texEmpty);
-                    state = GameState::Exploring;
-                }
-
-                delete currentEnemy; currentEnemy = nullptr; 
-                delete combatSystem; combatSystem = nullptr;
+    // Shapes and sprites take their texture rect from the texture size, so
+    // they can only be bound after the upload
+    bindGameAssets = [&]() {
+        if (gameAssetsBound) return;
+        resources.waitGroup("game");
+        playerSprite.setTexture(texPlayer, true);
+        playerBox.setTexture(&texPortraitPlayer, true);
+        battleBgRect.setTexture(&texBattleBg, true);
+        enemyBox.setTexture(&texPortraitEnemy, true);
+        resources.printReport(cout);
+        gameAssetsBound = true;
+    };
 
-                battleOver = false;
-                enemyTurnPending = false;
+    // --- SAVES --- snapshots are taken on the main thread (well under a
+    // millisecond) and written to disk by the autosave thread
+    Autosave autosave(savePath);
+    vector<uint8_t> snapshot;
+    if (continueRun) {
+        string error;
+        if (readSaveFile(savePath, snapshot, error) && game.loadSnapshot(snapshot.data(), snapshot.size(), error)) {
+            cout << "[Save] continued from " << savePath << " (level " << game.getLevelIndex() + 1 << ")\n";
+            if (game.getState() != GameState::MainMenu) {
+                bindGameAssets();
+                if (game.getPlayerClass() == PlayerClass::Archer) playerBox.setTexture(&texArcher);
+                if (game.getPlayerClass() == PlayerClass::Mage) playerBox.setTexture(&texMage);
             }
+        } else {
+            cerr << "Warn: " << error << ", starting a new run\n";
         }
-        
-        sf::Event ev;
-        while (window.pollEvent(ev)) {
-            if (ev.type == sf::Event::Closed) window.close();
-
-            if (state == GameState::MainMenu) {
-                if (ev.type == sf::Event::MouseButtonPressed && ev.mouseButton.button == sf::Mouse::Left) {
-                    sf::Vector2f mp(ev.mouseButton.x, ev.mouseButton.y);
-                    for (auto &b : menuButtons) {
-                        if (b.contains(mp)) { b.onClick(); break; }
-                    }
-                }
-            }
-            else if (state == GameState::Exploring) {
-                if (!player) { state = GameState::MainMenu; continue; }
-
-                if (ev.type == sf::Event::KeyPressed && ev.key.code == sf::Keyboard::Space) {
-                    D6 moveDice;
-                    if(movePoints>0){
-                        cout<<"you have movepoints"<<endl;
-                    }else{
-                    movePoints = moveDice.roll();
-                    cout << "[Movement] Rolled d6 = " << movePoints << " move points\n";
-                    }
-                }
-                if (ev.type == sf::Event::KeyPressed && movePoints > 0) {
-                    int dr=0, dc=0;
-                    if (ev.key.code == sf::Keyboard::W) dr = -1;
-                    if (ev.key.code == sf::Keyboard::S) dr = +1;
-                    if (ev.key.code == sf::Keyboard::A) dc = -1;
-                    if (ev.key.code == sf::Keyboard::D) dc = +1;
-                    
-                    if (dr!=0 || dc!=0) {
-                        int nr = player->posR + dr;
-                        int nc = player->posC + dc;
-                        Tile* t = board.getTile(nr,nc);
-                        
-                        if (!t) cout << "Cannot move out of bounds" << endl;
-                        else if (t->isBlocked()) cout << "Blocked tile" << endl;
-                        else {
-                            player->posR = nr; player->posC = nc;
-                            playerSprite.setPosition(player->posC * TILE_SIZE, player->posR * TILE_SIZE);
-                            movePoints--;
-                            t->onEnter(player); 
-                            
-                            // Check Combat Triggers
-                            bool trigMonster = t->isMonster() && dynamic_cast<MonsterTile*>(t)->shouldTriggerCombat();
-                            bool trigBoss = t->isBoss() && dynamic_cast<BossTile*>(t)->shouldTriggerCombat();
-                            
-                            if (trigMonster) {
-                                isFightingLevelBoss = false; 
-                                startBattle(nr, nc, false, currentLevelIndex, player, currentEnemy, combatSystem, enemyRow, enemyCol, state, battleMessage, battleLogStream);
-                                enemyTurnPending = false; 
-                                battleOver = false;
-                                
-                            }
-                            else if (trigBoss) {
-                                isFightingLevelBoss = true; 
-                                startBattle(nr, nc, true, currentLevelIndex, player, currentEnemy, combatSystem, enemyRow, enemyCol, state, battleMessage, battleLogStream);
-                                enemyTurnPending = false;
-                                battleOver = false;
-                            }
-                            else if (t->isExit()) {
-                                if (!levelBossDefeated) {
-                                    cout << "[LOCKED] The exit is locked! You must defeat the Boss ('T') first.\n";
-                                }
-                                else if (currentLevelIndex < allLevels.size() - 1) {
-                                    cout << "Level " << currentLevelIndex + 1 << " Cleared! Proceeding...\n";
-                                    currentLevelIndex++;
-                                    levelBossDefeated = false; 
-
-                                    loadLevel(currentLevelIndex, allLevels, board, ROWS, COLS, playerStartR, playerStartC, 
-                                              texEmpty, texBlocked, texMonster, texBoss, texExit);
-                                    player->posR = playerStartR; player->posC = playerStartC;
-                                    playerSprite.setPosition(player->posC * TILE_SIZE, player->posR * TILE_SIZE);
-                                    movePoints = 0; 
-                                } else {
-                                    cout << "Victory!\n";
-                                    state = GameState::Victory;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            else if (state == GameState::InBattle) {
-                if (ev.type == sf::Event::MouseButtonPressed && ev.mouseButton.button == sf::Mouse::Left) {
-                    // Prevent interaction if busy
-                    if (enemyTurnPending || battleOver) continue;
-
-                    sf::Vector2f mp(ev.mouseButton.x, ev.mouseButton.y);
-                    for (auto &b : battleButtons) {
-                        if (b.contains(mp)) { b.onClick(); break; }
-                    }
-                }
-            }
+    }
+    uint32_t savedCheckpoint = game.getCheckpoint();
+    auto saveGame = [&](const char* why) {
+        PROFILE_SCOPE("autosave snapshot");
+        auto begin = chrono::steady_clock::now();
+        game.saveSnapshot(snapshot);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+        cout << "[Save] " << why << ": " << snapshot.size() << " byte snapshot in " << ms << " ms\n";
+        autosave.submit(snapshot);
+        savedCheckpoint = game.getCheckpoint();
+    };
+
+    // --- UPDATE --- fixed-timestep simulation: battle delays advance in
+    // simulation time, and any state change asks for a redraw
+    auto update = [&](float dt) {
+        if (game.update(dt)) needsRedraw = true;
+
+        // Auto-battle: take the player's turn once the last one has been read
+        if (autoBattle && game.awaitingBattleAction() && game.getBattleDelay() > 0.75f) {
+            CombatDecision d = battleAI.decide(makeCombatSnapshot(*game.getPlayer(), *game.getEnemy()));
+            cout << "[Auto] " << combatActionName(d.action) << " (expected " << d.value << ", depth " << d.depth
+                 << ", " << d.nodes << " nodes in " << d.ms << " ms)\n";
+            battleButtons[(int)d.action].onClick();
+            needsRedraw = true;
         }
+    };
 
+    // --- RENDER ---
+    auto render = [&]() {
+        PROFILE_SCOPE("render");
+        GameState state = game.getState();
+        const Player* player = game.getPlayer();
+        const Enemy* currentEnemy = game.getEnemy();
+        int movePoints = game.getMovePoints();
         window.clear(sf::Color(25,25,25));
 
         if (state == GameState::MainMenu) {
@@ -519,54 +428,86 @@ int main() {
             }
         }
         else if (state == GameState::Exploring) {
-            board.draw(window);
+            if (player) boardView.setCenter(cameraCenter(board, TILE_SIZE, *player, boardView.getSize()));
+            window.setView(boardView);
+            boardRenderer.draw(board, window);
+            if (player && movePoints > 0) {
+                // Rebuilt only when the player, the roll or the board changed
+                Reachability& reach = game.getReach();
+                if (player->posR != highlightR || player->posC != highlightC ||
+                    movePoints != highlightPoints || reach.getRevision() != highlightRevision) {
+                    buildMoveHighlight(reach.movesFrom(player->posR, player->posC, movePoints), TILE_SIZE, moveHighlight);
+                    highlightR = player->posR; highlightC = player->posC;
+                    highlightPoints = movePoints; highlightRevision = reach.getRevision();
+                }
+                window.draw(moveHighlight);
+            }
+            if (player) playerSprite.setPosition(player->posC * TILE_SIZE, player->posR * TILE_SIZE);
             window.draw(playerSprite);
+            window.setView(window.getDefaultView());
+            if (reportBoardDrawCalls) {
+                cout << "[Render] Board draw calls per frame: " << boardRenderer.getLastDrawCalls()
+                     << " (per-tile sprites would need " << board.getRows() * board.getCols() << ", "
+                     << board.getAllocatedChunks() << " chunks allocated)\n";
+                reportBoardDrawCalls = false;
+            }
             if (fontOk && player) {
-                string s = "Lvl " + to_string(currentLevelIndex+1) + " | Move: WASD | SPACE(roll): " + to_string(movePoints) +  " | " + player->name + " HP: " + to_string(player->hp) + "/" + to_string(player->maxHp);
-                if (!levelBossDefeated) s += " | Exit: LOCKED";
-                else s += " | Exit: OPEN";
-
-                sf::Text t(s, font, 16); t.setFillColor(sf::Color::White); t.setPosition(10, ROWS*TILE_SIZE + 10);
-                window.draw(t);
+                if (hudText.changed({game.getLevelIndex(), movePoints, player->hp, player->maxHp, game.isLevelBossDefeated()})) {
+                    string& s = hudText.buffer();
+                    s += "Lvl "; s += to_string(game.getLevelIndex()+1);
+                    s += " | Move: WASD | SPACE(roll): "; s += to_string(movePoints);
+                    s += " | "; s += player->name;
+                    s += " HP: "; s += to_string(player->hp); s += "/"; s += to_string(player->maxHp);
+                    if (!game.isLevelBossDefeated()) s += " | Exit: LOCKED";
+                    else s += " | Exit: OPEN";
+                    hudText.commit();
+                }
+                window.draw(hudText);
             }
         }
         else if (state == GameState::InBattle) {
             window.draw(battleBgRect);
-            // Draw UI even if battleOver is true (so we can see the result)
+            // Draw UI even while the result is shown
             if (fontOk && player && currentEnemy) {
                 window.draw(playerBox);
                 playerBattleName.setString(player->name);
-                playerBattleName.setPosition(playerBox.getPosition().x + 20, playerBox.getPosition().y - 70);
                 window.draw(playerBattleName);
 
                 window.draw(enemyBox);
                 enemyBattleName.setString(currentEnemy->name);
-                enemyBattleName.setPosition(enemyBox.getPosition().x + 20, enemyBox.getPosition().y - 70);
                 window.draw(enemyBattleName);
 
                 float playerHpPercent = max(0.f, static_cast<float>(player->hp) / player->maxHp);
-                playerHpBarBack.setPosition(playerBattleName.getPosition().x, playerBattleName.getPosition().y + 40);
-                playerHpBarFront.setPosition(playerBattleName.getPosition().x, playerBattleName.getPosition().y + 40);
+                playerHpBarBack.setPosition(playerBattleName.text.getPosition().x, playerBattleName.text.getPosition().y + 40);
+                playerHpBarFront.setPosition(playerBattleName.text.getPosition().x, playerBattleName.text.getPosition().y + 40);
                 playerHpBarFront.setSize(sf::Vector2f(BAR_WIDTH * playerHpPercent, BAR_HEIGHT));
                 window.draw(playerHpBarBack); window.draw(playerHpBarFront);
 
                 float enemyHpPercent = max(0.f, static_cast<float>(currentEnemy->hp) / currentEnemy->maxHp);
-                enemyHpBarBack.setPosition(enemyBattleName.getPosition().x, enemyBattleName.getPosition().y + 40);
-                enemyHpBarFront.setPosition(enemyBattleName.getPosition().x, enemyBattleName.getPosition().y + 40);
+                enemyHpBarBack.setPosition(enemyBattleName.text.getPosition().x, enemyBattleName.text.getPosition().y + 40);
+                enemyHpBarFront.setPosition(enemyBattleName.text.getPosition().x, enemyBattleName.text.getPosition().y + 40);
                 enemyHpBarFront.setSize(sf::Vector2f(BAR_WIDTH * enemyHpPercent, BAR_HEIGHT));
                 window.draw(enemyHpBarBack); window.draw(enemyHpBarFront);
-                
-                battleLogText.setString(battleMessage);
+            
+                const CombatLog& battleLog = game.getBattleLog();
+                uint64_t battleMessageStart = game.getBattleMessageStart();
+                if (battleLogText.changed({(int64_t)battleMessageStart, (int64_t)battleLog.end()})) {
+                    for (uint64_t seq = max(battleMessageStart, battleLog.begin()); seq < battleLog.end(); seq++)
+                        formatCombatEvent(battleLogText.buffer(), battleLog.at(seq), *player, *currentEnemy);
+                    battleLogText.commit();
+                }
                 window.draw(battleLogText);
             }
-            
-            for (auto &b : battleButtons) {
-                // Dim buttons if waiting
-                if(enemyTurnPending || battleOver) b.rect.setFillColor(sf::Color(40,40,40)); 
-                else b.rect.setFillColor(sf::Color(70,70,70)); 
+        
+            for (vector<Button>* row : { &battleButtons, &classAbilityButtons() }) {
+                for (auto &b : *row) {
+                    // Dim buttons if waiting
+                    if(game.isBattleBusy()) b.rect.setFillColor(sf::Color(40,40,40)); 
+                    else b.rect.setFillColor(sf::Color(70,70,70)); 
                 
-                window.draw(b.rect);
-                if (fontOk) window.draw(b.label);
+                    window.draw(b.rect);
+                    if (fontOk) window.draw(b.label);
+                }
             }
         }
 
@@ -592,12 +533,157 @@ int main() {
                 window.draw(txt);
             }
         }
-        window.display();
+        window.setView(window.getDefaultView());
+        profilerOverlay.draw(window);
+    };
+
+    bool firstFrame = true;
+    bool focused = true;
+    float accumulator = 0.f;
+    sf::Clock frameClock;
+    FrameStats frameStats;
+
+    // --- GAME LOOP ---
+    while (window.isOpen()) {
+        {
+            PROFILE_SCOPE("assets");
+            resources.pump();
+            if (!gameAssetsBound && resources.isGroupReady("game")) {
+                bindGameAssets();
+                needsRedraw = true;
+            }
+        }
+        
+        {
+            PROFILE_SCOPE("events");
+            sf::Event ev;
+            while (window.pollEvent(ev)) {
+                if (ev.type == sf::Event::Closed) window.close();
+                if (ev.type == sf::Event::LostFocus) focused = false;
+                if (ev.type == sf::Event::GainedFocus) focused = true;
+                if (ev.type == sf::Event::KeyPressed || ev.type == sf::Event::MouseButtonPressed ||
+                    ev.type == sf::Event::Resized || ev.type == sf::Event::GainedFocus)
+                    needsRedraw = true;
+
+                if (ev.type == sf::Event::KeyPressed && ev.key.code == sf::Keyboard::F3) profilerOverlay.toggle();
+                if (ev.type == sf::Event::KeyPressed && ev.key.code == sf::Keyboard::F4) {
+                    if (!isProfileTracing()) {
+                        startProfileTrace();
+                        cout << "[Profile] trace capture started\n";
+                    } else {
+                        string error;
+                        if (stopProfileTrace(tracePath, error)) cout << "[Profile] trace written to " << tracePath << "\n";
+                        else cerr << "Error: " << error << "\n";
+                    }
+                }
+
+                GameState state = game.getState();
+                if (state == GameState::MainMenu) {
+                    if (ev.type == sf::Event::MouseButtonPressed && ev.mouseButton.button == sf::Mouse::Left) {
+                        sf::Vector2f mp(ev.mouseButton.x, ev.mouseButton.y);
+                        for (auto &b : menuButtons) {
+                            if (b.contains(mp)) { b.onClick(); break; }
+                        }
+                    }
+                }
+                else if (state == GameState::Exploring) {
+                    if (ev.type != sf::Event::KeyPressed) continue;
+                    if (ev.key.code == sf::Keyboard::Space) game.apply({GameInputKind::Roll});
+                    if (ev.key.code == sf::Keyboard::W) game.apply({GameInputKind::Move, (uint8_t)MoveDir::Up});
+                    if (ev.key.code == sf::Keyboard::S) game.apply({GameInputKind::Move, (uint8_t)MoveDir::Down});
+                    if (ev.key.code == sf::Keyboard::A) game.apply({GameInputKind::Move, (uint8_t)MoveDir::Left});
+                    if (ev.key.code == sf::Keyboard::D) game.apply({GameInputKind::Move, (uint8_t)MoveDir::Right});
+                }
+                else if (state == GameState::InBattle) {
+                    if (ev.type == sf::Event::KeyPressed && ev.key.code == sf::Keyboard::A) {
+                        autoBattle = !autoBattle;
+                        cout << "[Auto] battle autopilot " << (autoBattle ? "on" : "off") << "\n";
+                    }
+                    if (ev.type == sf::Event::MouseButtonPressed && ev.mouseButton.button == sf::Mouse::Left) {
+                        // Prevent interaction if busy
+                        if (game.isBattleBusy()) continue;
+
+                        sf::Vector2f mp(ev.mouseButton.x, ev.mouseButton.y);
+                        for (auto &b : battleButtons) {
+                            if (b.contains(mp)) { b.onClick(); break; }
+                        }
+                        for (auto &b : classAbilityButtons()) {
+                            if (b.contains(mp)) { b.onClick(); break; }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Fixed 60 Hz simulation steps, decoupled from how often we draw
+        accumulator = min(accumulator + frameClock.restart().asSeconds(), MAX_FRAME_TIME);
+        {
+            PROFILE_SCOPE("update");
+            while (accumulator >= TICK) {
+                update(TICK);
+                accumulator -= TICK;
+            }
+        }
+        // Level transitions and finished battles
+        if (game.getCheckpoint() != savedCheckpoint) saveGame("checkpoint");
+
+        // The overlay shows live numbers, so it keeps frames coming while open
+        if (profilerOverlay.isVisible()) needsRedraw = true;
+
+        if (needsRedraw) {
+            auto frameBegin = chrono::steady_clock::now();
+            render();
+            {
+                PROFILE_SCOPE("display");
+                window.display();
+            }
+            PROFILE_FRAME();
+            frameStats.add(chrono::duration<double, milli>(chrono::steady_clock::now() - frameBegin).count());
+            needsRedraw = false;
+
+            if (firstFrame) {
+                cout << "[Startup] time to first frame: "
+                     << chrono::duration<double, milli>(chrono::steady_clock::now() - startupBegin).count() << " ms\n";
+                firstFrame = false;
+            }
+        } else {
+            // Nothing to draw: wait for input or the next tick instead of spinning.
+            // A window in the background only needs to notice timers and focus.
+            {
+                PROFILE_SCOPE("idle");
+                sf::sleep(focused ? sf::seconds(TICK - accumulator) : sf::milliseconds(100));
+            }
+            // Not a frame: keeps the sleep out of the frame times and FPS
+            PROFILE_SKIP_FRAME();
+        }
     }
 
-    if (player) delete player;
-    if (currentEnemy) delete currentEnemy;
-    if (combatSystem) delete combatSystem;
+    if (isProfileTracing()) {
+        string error;
+        if (stopProfileTrace(tracePath, error)) cout << "[Profile] trace written to " << tracePath << "\n";
+        else cerr << "Error: " << error << "\n";
+    }
+
+    frameStats.print(cout, chrono::duration<double>(chrono::steady_clock::now() - startupBegin).count(),
+                     double(clock()) / CLOCKS_PER_SEC);
+    cout << "[Perf] text rebuilds: HUD " << hudText.getRebuilds() << ", battle log " << battleLogText.getRebuilds()
+         << ", names " << playerBattleName.getRebuilds() + enemyBattleName.getRebuilds() << "\n";
+
+    // Keep the run, a battle in progress included, unless there is nothing
+    // to continue (closing the menu must not replace an earlier save)
+    if (game.getState() == GameState::Exploring || game.getState() == GameState::InBattle) saveGame("exit");
+    autosave.flush();
+    autosave.printReport(cout);
+
+    if (!recordPath.empty()) {
+        // Resolve what was still on a timer so the hash matches a replay's
+        game.settle();
+        string error;
+        if (GameRecording::capture(game).save(recordPath, error))
+            cout << "[Replay] recorded " << game.getInputs().size() << " inputs to " << recordPath << "\n";
+        else
+            cerr << "Error: " << error << "\n";
+    }
     
     return 0;
-}
\ No newline at end of file
+}
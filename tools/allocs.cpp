@@ -0,0 +1,142 @@
+// Heap allocation checks for the level-lifetime storage: once warmed up,
+// starting and ending a battle (EncounterSlots), reloading a level
+// (Board + Reachability) and clearing a defeated boss's tile through
+// Game::step must not touch the heap. Also prints the
+// allocations per playthrough run. Links AllocCounter.cpp for the counting
+// operator new. Exits 1 if a check fails.
+//
+//   g++ -std=c++17 -O2 -pthread tools/allocs.cpp AllocCounter.cpp Game.cpp Playthrough.cpp WorkStealingPool.cpp Board.cpp Reachability.cpp Encounter.cpp Simulator.cpp CombatAI.cpp CombatOdds.cpp CombatSystem.cpp CombatLog.cpp Dice.cpp Entity.cpp StatusEffects.cpp Player.cpp Enemy.cpp LevelPack.cpp Tile.cpp TileBitboard.cpp -o allocs
+//   ./allocs [--runs N]
+
+#include "../include/AllocStats.h"
+#include "../include/Board.h"
+#include "../include/Encounter.h"
+#include "../include/Game.h"
+#include "../include/Playthrough.h"
+#include "../include/Reachability.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+static int failures = 0;
+
+static void expectNone(const char* what, uint64_t allocs) {
+	std::printf("%-32s %6llu heap allocations%s\n", what, (unsigned long long)allocs, allocs ? "  FAIL" : "");
+	if (allocs) failures++;
+}
+
+int main(int argc, char** argv) {
+	long long runs = 1000;
+	for (int i = 1; i < argc; i++) {
+		if (!std::strcmp(argv[i], "--runs") && i + 1 < argc) runs = std::atoll(argv[++i]);
+		else { std::printf("usage: %s [--runs N]\n", argv[0]); return 1; }
+	}
+
+	LevelPack levels;
+	std::string error;
+	if (!levels.open("assets/levels.rlv", error)) {
+		std::printf("assets/levels.rlv: %s\n", error.c_str());
+		return 1;
+	}
+
+	// Battles: every kind at every prepared level, after one warm-up pass
+	// (the combat log and the slot strings grow to their working size).
+	{
+		Player player(PlayerClass::Mage, 0, 0);
+		CombatLog log;
+		EncounterSlots slots;
+		slots.prepareLevels(levels.count());
+		for (int pass = 0; pass < 2; pass++) {
+			uint64_t begins = 0, ends = 0;
+			for (int kind = 0; kind < 3; kind++) {
+				for (int l = 0; l < levels.count(); l++) {
+					uint64_t a = heapAllocations();
+					slots.begin((EnemyKind)kind, l, &player, log);
+					uint64_t b = heapAllocations();
+					slots.end();
+					begins += b - a;
+					ends += heapAllocations() - b;
+				}
+			}
+			if (pass == 0) continue;
+			expectNone("battle start", begins);
+			expectNone("battle end", ends);
+		}
+	}
+
+	// Level loads: the second pass over the pack reuses the chunk arena and
+	// the distance fields sized by the first.
+	{
+		Board board(1, 1);
+		Reachability reach;
+		for (int pass = 0; pass < 2; pass++) {
+			uint64_t allocs = 0;
+			for (int i = 0; i < levels.count(); i++) {
+				const LevelView& lvl = levels.level(i);
+				uint64_t a = heapAllocations();
+				board.load(lvl.rows, lvl.cols, lvl.tiles);
+				reach.build(board, lvl.startR, lvl.startC);
+				allocs += heapAllocations() - a;
+			}
+			if (pass == 1) expectNone("level reload", allocs);
+		}
+	}
+
+	// A won boss battle ending through Game::step: clearing the tile repairs
+	// the distance fields (the boss field loses a source, which re-solves
+	// through increase()'s heap) before endBattle frees the slot. The level
+	// has a second boss so the repaired region still has a source to reach.
+	{
+		LevelData lvl;
+		lvl.rows = 1; lvl.cols = 6;
+		lvl.tiles = { TileKind::Empty, TileKind::Boss, TileKind::Empty, TileKind::Empty, TileKind::Boss, TileKind::Exit };
+		std::vector<uint8_t> bytes;
+		packLevels({ lvl }, bytes);
+		LevelPack pack;
+		if (!pack.loadFromBytes(bytes, error)) {
+			std::printf("boss level: %s\n", error.c_str());
+			return 1;
+		}
+		std::ostream quiet(nullptr);
+		Game game(pack, 1, quiet);
+		int won = 0;
+		uint64_t allocs = 0;
+		for (uint64_t seed = 1; won < 2 && seed < 1000; seed++) {
+			game.restart(seed);
+			game.apply({ GameInputKind::ChooseClass, (uint8_t)PlayerClass::Soldier });
+			game.apply({ GameInputKind::Roll });
+			game.apply({ GameInputKind::Move, (uint8_t)MoveDir::Right });
+			while (game.awaitingBattleAction()) {
+				game.apply({ GameInputKind::BattleAction, battleInputValue(CombatAction::Attack) });
+				bool bossDown = game.getEnemy() && game.getEnemy()->hp <= 0;
+				uint64_t a = heapAllocations();
+				game.settle();
+				// The first win warms up the storage
+				if (bossDown && game.getState() == GameState::Exploring && won++ == 1) allocs = heapAllocations() - a;
+			}
+		}
+		if (won < 2) {
+			std::printf("boss level: no seed won twice\n");
+			return 1;
+		}
+		expectNone("boss tile cleared (Game::step)", allocs);
+	}
+
+	// Whole runs, for reference: levels, battles and the bot's moves.
+	if (runs > 0) {
+		WorkStealingPool pool(1);
+		uint64_t a = heapAllocations();
+		runPlaythroughs(levels, runs, SimPolicy::Ability, pool, 1);
+		std::printf("%-32s %8.1f heap allocations/run\n", "playthrough (ability policy)",
+		            (heapAllocations() - a) / (double)runs);
+	}
+
+	if (failures) {
+		std::printf("%d check(s) failed\n", failures);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,76 @@
+// Exact balance matrix: every class against every encounter startBattle()
+// can produce, at every level index, solved by CombatSolver instead of
+// sampled. Re-run after touching stats in Player.cpp or Enemy.cpp.
+//
+//   g++ -std=c++17 -O2 -pthread tools/balance.cpp CombatSolver.cpp CombatOdds.cpp Simulator.cpp CombatAI.cpp CombatSystem.cpp CombatLog.cpp Dice.cpp Entity.cpp StatusEffects.cpp Player.cpp Enemy.cpp LevelPack.cpp Tile.cpp TileBitboard.cpp -o balance
+//   ./balance --levels 5 --flee-value 0.25
+
+#include "../include/CombatSolver.h"
+#include "../include/Simulator.h"
+#include "../include/LevelPack.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+static void usage(const char* prog) {
+	std::printf("usage: %s [--levels L] [--flee-value V]\n", prog);
+}
+
+int main(int argc, char** argv) {
+	int levels = 0;		// default: as many as the campaign pack holds
+	double fleeValue = 0.25;
+
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--levels") && hasValue) levels = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--flee-value") && hasValue) fleeValue = std::atof(argv[++i]);
+		else { usage(argv[0]); return 1; }
+	}
+	if (levels == 0) {
+		LevelPack pack;
+		std::string error;
+		levels = pack.open("assets/levels.rlv", error) ? pack.count() : 3;
+	}
+	if (levels <= 0) { usage(argv[0]); return 1; }
+
+	const PlayerClass classes[] = { PlayerClass::Soldier, PlayerClass::Archer, PlayerClass::Mage };
+	const EnemyKind enemies[] = { EnemyKind::Goblin, EnemyKind::Ogre, EnemyKind::Boss };
+
+	std::printf("%-8s %-7s %3s | %8s %8s | %8s %6s %-7s %6s | %7s %7s\n",
+	            "class", "enemy", "lvl", "attack", "ability", "best", "fled%", "opener", "turns",
+	            "50%hp", "turns");
+
+	CombatSolver solver(fleeValue);
+	auto start = std::chrono::steady_clock::now();
+
+	for (PlayerClass cls : classes) {
+		for (EnemyKind kind : enemies) {
+			for (int lvl = 0; lvl < levels; lvl++) {
+				Player player(cls, 0, 0);
+				std::unique_ptr<Enemy> enemy(makeEnemy(kind, lvl));
+				CombatSnapshot s = makeCombatSnapshot(player, *enemy);
+
+				CombatOutcome attack = solver.solve(s, SolverPolicy::Attack);
+				CombatOutcome ability = solver.solve(s, SolverPolicy::Ability);
+				CombatOutcome best = solver.solve(s, SolverPolicy::Best);
+				// Arriving hurt from an earlier fight: answered by the same table
+				CombatSnapshot hurt = s;
+				hurt.playerHp = (int16_t)std::max(1, s.playerMaxHp / 2);
+				CombatOutcome hurtBest = solver.solve(hurt, SolverPolicy::Best);
+
+				std::printf("%-8s %-7s %3d | %7.2f%% %7.2f%% | %7.2f%% %5.2f%% %-7s %6.2f | %6.2f%% %7.2f\n",
+				            playerClassName(cls), enemyKindName(kind), lvl + 1,
+				            100.0 * attack.win, 100.0 * ability.win,
+				            100.0 * best.win, 100.0 * best.flee, combatActionName(best.firstAction), best.expectedTurns,
+				            100.0 * hurtBest.win, hurtBest.expectedTurns);
+			}
+		}
+	}
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::printf("\n%d tables, %lld states solved in %.1f ms\n", solver.getTableCount(), solver.getStatesSolved(), ms);
+	return 0;
+}
@@ -0,0 +1,437 @@
+// Benchmark suite for the game core: dice, damage, combat rounds, level
+// loads, board scans, board drawing into an offscreen target and save
+// snapshots. Each benchmark is calibrated to run for a fixed time, repeated,
+// and reported as the median ns per operation. --json writes the results
+// as JSON; --baseline compares against such a file and exits with status 2
+// when anything got slower than the threshold.
+//
+//   g++ -std=c++17 -O2 -pthread tools/bench.cpp Game.cpp SaveGame.cpp Board.cpp Reachability.cpp Encounter.cpp AllocStats.cpp Simulator.cpp CombatAI.cpp CombatOdds.cpp CombatSystem.cpp CombatLog.cpp Dice.cpp Entity.cpp StatusEffects.cpp Player.cpp Enemy.cpp LevelPack.cpp Tile.cpp TileBitboard.cpp -o bench
+//   (add -DROGUE_RENDER BoardRenderer.cpp -lsfml-graphics -lsfml-window -lsfml-system for the draw benchmarks)
+//   ./bench --json bench_main.json
+//   ./bench --baseline bench_main.json [--threshold 15]
+
+#include "../include/Board.h"
+#ifdef ROGUE_RENDER
+#include "../include/BoardRenderer.h"
+#endif
+#include "../include/CombatSystem.h"
+#include "../include/Game.h"
+#include "../include/LevelPack.h"
+#include "../include/Reachability.h"
+#include "../include/Simulator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+static const int BENCH_FORMAT = 1;
+
+struct BenchResult {
+	std::string name;
+	uint64_t opsPerRep = 0;
+	int reps = 0;
+	double nsPerOp = 0;		// median of the repetitions
+	double minNsPerOp = 0;
+};
+
+// body(n) performs n operations and returns something derived from their
+// results, so the compiler cannot drop them.
+typedef std::function<uint64_t(uint64_t)> BenchBody;
+
+static volatile uint64_t sink;
+
+static double timeBody(const BenchBody& body, uint64_t n) {
+	auto start = std::chrono::steady_clock::now();
+	sink = sink + body(n);
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+class BenchSuite {
+private:
+	std::string filter;
+	double repSecs;
+	int reps;
+public:
+	std::vector<BenchResult> results;
+
+	BenchSuite(const std::string& filter, double minSecs, int reps)
+		: filter(filter), repSecs(minSecs / reps), reps(reps) {}
+
+	bool wants(const std::string& name) const { return filter.empty() || name.find(filter) != std::string::npos; }
+
+	void run(const std::string& name, const BenchBody& body) {
+		if (!wants(name)) return;
+
+		// Double the batch until it takes long enough to time, then size
+		// each repetition to repSecs
+		uint64_t n = 1;
+		double secs = timeBody(body, n);
+		while (secs < 0.01 && n < (1ull << 40)) {
+			n *= 2;
+			secs = timeBody(body, n);
+		}
+		n = std::max<uint64_t>(1, (uint64_t)(n * repSecs / secs));
+
+		std::vector<double> ns;
+		for (int r = 0; r < reps; r++) ns.push_back(timeBody(body, n) * 1e9 / n);
+		std::sort(ns.begin(), ns.end());
+
+		BenchResult res;
+		res.name = name;
+		res.opsPerRep = n;
+		res.reps = reps;
+		res.nsPerOp = ns[ns.size() / 2];
+		res.minNsPerOp = ns.front();
+		results.push_back(res);
+		std::printf("%-32s %12.2f ns/op %14.0f ops/s  (min %.2f, %d x %llu)\n", name.c_str(), res.nsPerOp,
+		            1e9 / res.nsPerOp, res.minNsPerOp, reps, (unsigned long long)n);
+		std::fflush(stdout);
+	}
+};
+
+// --- Benchmarks ---
+
+static void benchDice(BenchSuite& suite) {
+	suite.run("dice.d6_roll", [](uint64_t n) {
+		seedThreadRng(1);
+		D6 d;
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < n; i++) sum += d.roll();
+		return sum;
+	});
+	suite.run("dice.d20_roll", [](uint64_t n) {
+		seedThreadRng(1);
+		D20 d;
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < n; i++) sum += d.roll();
+		return sum;
+	});
+	suite.run("dice.d20_rollN", [](uint64_t n) {
+		Rng r(1);
+		int buf[1024];
+		uint64_t sum = 0;
+		for (uint64_t done = 0; done < n; done += 1024) {
+			size_t k = (size_t)std::min<uint64_t>(1024, n - done);
+			r.rollN(20, buf, k);
+			for (size_t i = 0; i < k; i++) sum += buf[i];
+		}
+		return sum;
+	});
+}
+
+static void benchEntity(BenchSuite& suite) {
+	suite.run("entity.take_damage", [](uint64_t n) {
+		Monster m = makeOgre(2);
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < n; i++) {
+			m.defending = (i & 1) != 0;
+			sum += m.takeDamage(3 + (int)(i & 7));
+			if (m.hp <= 0) m.hp = m.maxHp;
+		}
+		return sum;
+	});
+}
+
+// One round: the player attacks and the enemy strikes back; both are
+// healed when either falls so every round does the full work.
+static void benchCombat(BenchSuite& suite) {
+	const PlayerClass classes[] = { PlayerClass::Soldier, PlayerClass::Archer, PlayerClass::Mage };
+	for (PlayerClass cls : classes) {
+		std::string name = std::string("combat.round.") + playerClassName(cls);
+		for (char& ch : name) ch = (char)std::tolower((unsigned char)ch);
+		suite.run(name, [cls](uint64_t n) {
+			seedThreadRng(7);
+			Player player(cls, 0, 0);
+			Monster enemy = makeGoblin(1);
+			CombatSystem combat(&player, &enemy);
+			uint64_t sum = 0;
+			for (uint64_t i = 0; i < n; i++) {
+				combat.attack();
+				combat.enemyTurn();
+				if (combat.isEnemyDefeated() || combat.isPlayerDefeated()) {
+					sum += (uint64_t)player.hp;
+					player.hp = player.maxHp;
+					enemy.hp = enemy.maxHp;
+				}
+			}
+			return sum + (uint64_t)enemy.hp;
+		});
+	}
+	// The same round with the enemy poisoned and the player shielded and
+	// guarded, refreshed each round so every tick has all three to process
+	suite.run("combat.round.effects", [](uint64_t n) {
+		seedThreadRng(7);
+		Player player(PlayerClass::Soldier, 0, 0);
+		Monster enemy = makeGoblin(1);
+		CombatSystem combat(&player, &enemy);
+		const StatusEffect poison = { EffectKind::Poison, 2, 1 };
+		const StatusEffect shield = { EffectKind::Shield, 2, 2 };
+		const StatusEffect guard = { EffectKind::Guard, 2, 0 };
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < n; i++) {
+			enemy.effects.apply(poison);
+			player.effects.apply(shield);
+			player.effects.apply(guard);
+			combat.attack();
+			combat.enemyTurn();
+			if (combat.isEnemyDefeated() || combat.isPlayerDefeated()) {
+				sum += (uint64_t)player.hp;
+				player.hp = player.maxHp;
+				enemy.hp = enemy.maxHp;
+			}
+		}
+		return sum + (uint64_t)enemy.hp;
+	});
+}
+
+// What Game::loadLevel does: copy the pack's tiles into the board and
+// build the distance fields.
+static void benchLevels(BenchSuite& suite, const LevelPack& levels) {
+	for (int i = 0; i < levels.count(); i++) {
+		suite.run("level.load." + std::to_string(i + 1), [&levels, i](uint64_t n) {
+			Board board(1, 1);
+			Reachability reach;
+			const LevelView& lvl = levels.level(i);
+			uint64_t sum = 0;
+			for (uint64_t k = 0; k < n; k++) {
+				board.load(lvl.rows, lvl.cols, lvl.tiles);
+				reach.build(board, lvl.startR, lvl.startC);
+				sum += (uint64_t)board.getAllocatedChunks();
+			}
+			return sum;
+		});
+	}
+	suite.run("level.load_all", [&levels](uint64_t n) {
+		Board board(1, 1);
+		Reachability reach;
+		uint64_t sum = 0;
+		for (uint64_t k = 0; k < n; k++) {
+			for (int i = 0; i < levels.count(); i++) {
+				const LevelView& lvl = levels.level(i);
+				board.load(lvl.rows, lvl.cols, lvl.tiles);
+				reach.build(board, lvl.startR, lvl.startC);
+			}
+			sum += (uint64_t)board.getAllocatedChunks();
+		}
+		return sum;
+	});
+}
+
+// A big board with scattered walls and monsters, as a stress level would have.
+static std::vector<TileKind> makeScatteredTiles(int rows, int cols) {
+	std::vector<TileKind> tiles((size_t)rows * cols, TileKind::Empty);
+	Rng r(3);
+	for (TileKind& t : tiles) {
+		uint32_t x = r.bounded(100);
+		if (x < 12) t = TileKind::Blocked;
+		else if (x < 14) t = TileKind::Monster;
+	}
+	tiles[1] = TileKind::Boss;
+	tiles.back() = TileKind::Exit;
+	return tiles;
+}
+
+static void benchBoard(BenchSuite& suite) {
+	const int SIZES[] = { 10, 1000 };
+	for (int size : SIZES) {
+		std::vector<TileKind> tiles = makeScatteredTiles(size, size);
+		auto board = std::make_shared<Board>(1, 1);
+		board->load(size, size, tiles.data());
+
+		// One op is one getTile call
+		suite.run("board.get_tile_scan." + std::to_string(size), [board, size](uint64_t n) {
+			uint64_t monsters = 0, done = 0;
+			while (done < n) {
+				for (int r = 0; r < size && done < n; r++)
+					for (int c = 0; c < size && done < n; c++, done++)
+						monsters += board->getTile(r, c) == TileKind::Monster;
+			}
+			return monsters;
+		});
+	}
+}
+
+// Board drawing needs SFML, so it is only built with ROGUE_RENDER (the CMake
+// build defines it when SFML is found).
+static void benchDraw(BenchSuite& suite, bool draw) {
+	if (!draw || !suite.wants("board.draw")) return;
+#ifdef ROGUE_RENDER
+	// An 800x800 view like the game's, over the 10x10 board and a corner of
+	// a 1000x1000 one (only chunks in view are drawn)
+	auto target = std::make_shared<sf::RenderTexture>();
+	if (!target->create(800, 800)) {
+		std::printf("%-32s skipped (no offscreen render target)\n", "board.draw");
+		return;
+	}
+	const int SIZES[] = { 10, 1000 };
+	for (int size : SIZES) {
+		std::vector<TileKind> tiles = makeScatteredTiles(size, size);
+		auto board = std::make_shared<Board>(1, 1);
+		board->load(size, size, tiles.data());
+		auto renderer = std::make_shared<BoardRenderer>(80.f);
+		suite.run("board.draw." + std::to_string(size), [board, renderer, target](uint64_t n) {
+			uint64_t calls = 0;
+			for (uint64_t i = 0; i < n; i++) {
+				target->clear();
+				renderer->draw(*board, *target);
+				target->display();
+				calls += (uint64_t)renderer->getLastDrawCalls();
+			}
+			return calls;
+		});
+	}
+#else
+	std::printf("%-32s skipped (built without ROGUE_RENDER)\n", "board.draw");
+#endif
+}
+
+static void benchSaves(BenchSuite& suite, const LevelPack& levels) {
+	static std::ostream silent(nullptr);
+	auto game = std::make_shared<Game>(levels, 5, silent);
+	game->apply({ GameInputKind::ChooseClass, (uint8_t)PlayerClass::Mage });
+	auto snapshot = std::make_shared<std::vector<uint8_t>>();
+	game->saveSnapshot(*snapshot);
+
+	suite.run("save.snapshot", [game, snapshot](uint64_t n) {
+		uint64_t bytes = 0;
+		for (uint64_t i = 0; i < n; i++) {
+			game->saveSnapshot(*snapshot);
+			bytes += snapshot->size();
+		}
+		return bytes;
+	});
+	suite.run("save.load", [game, snapshot](uint64_t n) {
+		std::string error;
+		uint64_t ok = 0;
+		for (uint64_t i = 0; i < n; i++) ok += game->loadSnapshot(snapshot->data(), snapshot->size(), error);
+		return ok;
+	});
+}
+
+// --- JSON ---
+
+static void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+	char buf[512];
+	out << "{\n  \"format\": " << BENCH_FORMAT << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchResult& r = results[i];
+		std::snprintf(buf, sizeof(buf),
+		              "    { \"name\": \"%s\", \"ns_per_op\": %.4f, \"min_ns_per_op\": %.4f, \"ops_per_rep\": %llu, \"reps\": %d }%s\n",
+		              r.name.c_str(), r.nsPerOp, r.minNsPerOp, (unsigned long long)r.opsPerRep, r.reps,
+		              i + 1 < results.size() ? "," : "");
+		out << buf;
+	}
+	out << "  ]\n}\n";
+}
+
+// Reads back what writeJson wrote: every "name" with the "ns_per_op"
+// that follows it. Not a general JSON parser.
+static bool readBaseline(const std::string& path, std::map<std::string, double>& out, std::string& error) {
+	std::ifstream in(path);
+	if (!in) { error = "cannot open " + path; return false; }
+	std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	size_t pos = 0;
+	while ((pos = text.find("\"name\"", pos)) != std::string::npos) {
+		size_t open = text.find('"', text.find(':', pos) + 1);
+		size_t close = text.find('"', open + 1);
+		size_t ns = text.find("\"ns_per_op\"", close);
+		if (open == std::string::npos || close == std::string::npos || ns == std::string::npos) break;
+		out[text.substr(open + 1, close - open - 1)] = std::strtod(text.c_str() + text.find(':', ns) + 1, nullptr);
+		pos = close;
+	}
+	if (out.empty()) { error = path + " has no benchmark results"; return false; }
+	return true;
+}
+
+// Prints old vs new for every benchmark in both; returns how many got
+// slower by more than thresholdPct.
+static int compareBaseline(const std::map<std::string, double>& baseline, const std::vector<BenchResult>& results,
+                           double thresholdPct) {
+	int regressions = 0;
+	std::printf("\n%-32s %12s %12s %9s\n", "benchmark", "baseline ns", "now ns", "change");
+	for (const BenchResult& r : results) {
+		auto it = baseline.find(r.name);
+		if (it == baseline.end() || it->second <= 0) {
+			std::printf("%-32s %12s %12.2f %9s\n", r.name.c_str(), "-", r.nsPerOp, "new");
+			continue;
+		}
+		double change = (r.nsPerOp / it->second - 1.0) * 100.0;
+		bool slower = change > thresholdPct;
+		regressions += slower;
+		std::printf("%-32s %12.2f %12.2f %+8.1f%%%s\n", r.name.c_str(), it->second, r.nsPerOp, change,
+		            slower ? "  REGRESSION" : change < -thresholdPct ? "  faster" : "");
+	}
+	std::printf("%d regression%s over %.1f%%\n", regressions, regressions == 1 ? "" : "s", thresholdPct);
+	return regressions;
+}
+
+static void usage(const char* prog) {
+	std::printf("usage: %s [--filter TEXT] [--min-time SECS] [--reps N] [--no-draw]\n"
+	            "       [--json FILE] [--baseline FILE [--threshold PCT]]\n", prog);
+}
+
+int main(int argc, char** argv) {
+	std::string filter, jsonPath, baselinePath;
+	double minSecs = 0.5, thresholdPct = 15.0;
+	int reps = 5;
+	bool draw = true;
+
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--filter") && hasValue) filter = argv[++i];
+		else if (!std::strcmp(argv[i], "--min-time") && hasValue) minSecs = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--reps") && hasValue) reps = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--json") && hasValue) jsonPath = argv[++i];
+		else if (!std::strcmp(argv[i], "--baseline") && hasValue) baselinePath = argv[++i];
+		else if (!std::strcmp(argv[i], "--threshold") && hasValue) thresholdPct = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--no-draw")) draw = false;
+		else { usage(argv[0]); return 1; }
+	}
+
+	// Read the baseline first so a bad path fails before the long part
+	std::map<std::string, double> baseline;
+	std::string error;
+	if (!baselinePath.empty() && !readBaseline(baselinePath, baseline, error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	LevelPack levels;
+	if (!levels.open("assets/levels.rlv", error) && !levels.compileFromFile("assets/levels.txt", error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	BenchSuite suite(filter, minSecs, reps);
+	benchDice(suite);
+	benchEntity(suite);
+	benchCombat(suite);
+	benchLevels(suite, levels);
+	benchBoard(suite);
+	benchDraw(suite, draw);
+	benchSaves(suite, levels);
+
+	if (!jsonPath.empty()) {
+		std::ofstream out(jsonPath);
+		writeJson(out, suite.results);
+		if (!out) {
+			std::fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+			return 1;
+		}
+		std::printf("wrote %s\n", jsonPath.c_str());
+	}
+	if (!baseline.empty() && compareBaseline(baseline, suite.results, thresholdPct) > 0) return 2;
+	return 0;
+}
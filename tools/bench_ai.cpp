@@ -0,0 +1,55 @@
+// Expectimax search speed: nodes per second at fixed depths (cold table),
+// and how deep a decision gets within a per-turn time budget.
+//
+//   g++ -std=c++17 -O2 tools/bench_ai.cpp CombatAI.cpp CombatOdds.cpp Simulator.cpp CombatSystem.cpp CombatLog.cpp Dice.cpp Entity.cpp StatusEffects.cpp Player.cpp Enemy.cpp -pthread -o bench_ai
+
+#include "../include/CombatAI.h"
+#include "../include/Simulator.h"
+
+#include <cstdio>
+#include <memory>
+
+int main() {
+	const PlayerClass classes[] = { PlayerClass::Soldier, PlayerClass::Archer, PlayerClass::Mage };
+	const EnemyKind enemies[] = { EnemyKind::Goblin, EnemyKind::Boss };
+	const int LEVEL = 2;
+	const int MAX_DEPTH = 6;
+
+	std::printf("Fixed depth, cold transposition table (level %d encounters)\n", LEVEL + 1);
+	std::printf("%-8s %-7s %5s | %-7s %8s | %12s %9s %10s\n", "class", "enemy", "depth", "action", "value", "nodes", "ms", "Mnodes/s");
+	for (PlayerClass cls : classes) {
+		for (EnemyKind kind : enemies) {
+			Player player(cls, 0, 0);
+			std::unique_ptr<Enemy> enemy(makeEnemy(kind, LEVEL));
+			CombatSnapshot s = makeCombatSnapshot(player, *enemy);
+
+			for (int depth = 1; depth <= MAX_DEPTH; depth++) {
+				CombatAIConfig config;
+				config.budgetMs = 0;
+				config.maxDepth = depth;
+				CombatAI ai(config);
+				CombatDecision d = ai.decide(s);
+				std::printf("%-8s %-7s %5d | %-7s %8.4f | %12llu %9.2f %10.2f\n",
+				            playerClassName(cls), enemyKindName(kind), depth, combatActionName(d.action), d.value,
+				            (unsigned long long)d.nodes, d.ms, d.ms > 0 ? d.nodes / d.ms / 1000.0 : 0.0);
+			}
+		}
+	}
+
+	const double budgets[] = { 1, 5, 10, 50 };
+	std::printf("\nTime budget per decision (Mage vs level %d Boss, fresh table each run)\n", LEVEL + 1);
+	std::printf("%9s | %5s %-7s %12s %9s %10s\n", "budget", "depth", "action", "nodes", "ms", "Mnodes/s");
+	Player mage(PlayerClass::Mage, 0, 0);
+	std::unique_ptr<Enemy> boss(makeEnemy(EnemyKind::Boss, LEVEL));
+	CombatSnapshot s = makeCombatSnapshot(mage, *boss);
+	for (double budget : budgets) {
+		CombatAIConfig config;
+		config.budgetMs = budget;
+		config.maxDepth = 1000;
+		CombatAI ai(config);
+		CombatDecision d = ai.decide(s);
+		std::printf("%6.0f ms | %5d %-7s %12llu %9.2f %10.2f\n", budget, d.depth, combatActionName(d.action),
+		            (unsigned long long)d.nodes, d.ms, d.ms > 0 ? d.nodes / d.ms / 1000.0 : 0.0);
+	}
+	return 0;
+}
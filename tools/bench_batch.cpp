@@ -0,0 +1,103 @@
+// Batch combat kernel: checks that the scalar and AVX2 kernels end every
+// battle exactly as simulateBattle does for the same Rng stream, down to the
+// effects left on each side, then compares battles per second (single
+// thread) for each matchup and policy. Also checks that a policy the
+// kernels cannot play (Search) is refused.
+//
+//   g++ -std=c++17 -O2 tools/bench_batch.cpp BatchCombat.cpp Simulator.cpp CombatAI.cpp CombatOdds.cpp CombatSystem.cpp CombatLog.cpp Dice.cpp Entity.cpp StatusEffects.cpp Player.cpp Enemy.cpp -pthread -o bench_batch
+//   ./bench_batch --battles 200000 --level 2
+
+#include "../include/BatchCombat.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+static bool same(const BattleResult& a, const BattleResult& b) {
+	return a.playerWon == b.playerWon && a.turns == b.turns && a.playerHp == b.playerHp && a.enemyHp == b.enemyHp
+	       && a.playerRolls == b.playerRolls && a.playerHits == b.playerHits && a.playerCrits == b.playerCrits
+	       && a.enemyHits == b.enemyHits;
+}
+
+static double seconds(std::chrono::steady_clock::time_point since) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+int main(int argc, char** argv) {
+	int battles = 200000;
+	int level = 2;
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--battles") && hasValue) battles = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--level") && hasValue) level = std::atoi(argv[++i]) - 1;
+		else { std::printf("usage: %s [--battles N] [--level L]\n", argv[0]); return 1; }
+	}
+	if (battles <= 0 || level < 0) return 1;
+
+	const PlayerClass classes[] = { PlayerClass::Soldier, PlayerClass::Archer, PlayerClass::Mage };
+	const EnemyKind enemies[] = { EnemyKind::Goblin, EnemyKind::Ogre, EnemyKind::Boss };
+	const SimPolicy policies[] = { SimPolicy::Attack, SimPolicy::Ability, SimPolicy::Effects };
+	const uint64_t SEED = 7;
+	bool avx2 = BatchCombat::avx2Available();
+
+	// The kernels cannot run CombatAI, so Search must be refused, not played as Attack
+	if (BatchCombat(1).run(SimPolicy::Search)) { std::printf("MISMATCH: Search policy was accepted\n"); return 1; }
+
+	std::printf("%d battles per matchup, level %d, AVX2 %s\n\n", battles, level + 1, avx2 ? "available" : "not available");
+	std::printf("%-8s %-7s %-7s | %10s %10s %10s | %9s\n", "class", "enemy", "policy", "entity/s", "scalar/s", "avx2/s", "mismatch");
+
+	long long mismatches = 0;
+	for (PlayerClass cls : classes) {
+		for (EnemyKind kind : enemies) {
+			for (SimPolicy policy : policies) {
+				Player player(cls, 0, 0);
+				std::unique_ptr<Enemy> enemy(makeEnemy(kind, level));
+				const int startMana = player.mana;
+				CombatSnapshot start = makeCombatSnapshot(player, *enemy);
+
+				// Reference: Entity objects through CombatSystem
+				std::vector<BattleResult> reference(battles);
+				std::vector<uint8_t> playerEffects(battles), enemyEffects(battles);
+				auto t0 = std::chrono::steady_clock::now();
+				for (int i = 0; i < battles; i++) {
+					player.hp = player.maxHp;
+					player.mana = startMana;
+					enemy->hp = enemy->maxHp;
+					Rng rng(SEED, (uint64_t)i);
+					RngScope scope(rng);
+					reference[i] = simulateBattle(player, *enemy, policy);
+					playerEffects[i] = player.effects.activeMask();
+					enemyEffects[i] = enemy->effects.activeMask();
+				}
+				double entitySecs = seconds(t0);
+
+				double kernelSecs[2] = { 0, 0 };
+				long long bad = 0;
+				const BatchKernel kernels[] = { BatchKernel::Scalar, BatchKernel::AVX2 };
+				for (int k = 0; k < (avx2 ? 2 : 1); k++) {
+					BatchCombat batch(battles);
+					for (int i = 0; i < battles; i++) {
+						batch.set(i, start, Rng(SEED, (uint64_t)i));
+						batch.setAbilities(i, player.getClassDef());
+					}
+					t0 = std::chrono::steady_clock::now();
+					if (!batch.run(policy, 1000, kernels[k])) { std::printf("%s: not supported\n", simPolicyName(policy)); return 1; }
+					kernelSecs[k] = seconds(t0);
+					for (int i = 0; i < battles; i++)
+						if (!same(batch.result(i), reference[i]) || batch.playerEffects[i] != playerEffects[i]
+						    || batch.enemyEffects[i] != enemyEffects[i]) bad++;
+				}
+				mismatches += bad;
+
+				std::printf("%-8s %-7s %-7s | %9.2fM %9.2fM %9.2fM | %9lld\n",
+				            playerClassName(cls), enemyKindName(kind), simPolicyName(policy),
+				            battles / entitySecs / 1e6, battles / kernelSecs[0] / 1e6,
+				            avx2 ? battles / kernelSecs[1] / 1e6 : 0.0, bad);
+			}
+		}
+	}
+	std::printf("\n%s\n", mismatches ? "MISMATCH: kernels disagree with CombatSystem" : "All battles identical to CombatSystem");
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+// Rolls per second: the old Dice path (global mt19937 + a fresh
+// uniform_int_distribution per call) against Dice::roll, Rng::roll and rollN.
+//
+//   g++ -std=c++17 -O2 tools/bench_dice.cpp Dice.cpp -o bench_dice
+
+#include "../include/Dice.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static volatile long long sink;
+
+template <class F>
+static void report(const char* label, long long rolls, F body) {
+	auto start = std::chrono::steady_clock::now();
+	long long sum = body();
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	sink = sum;
+	std::printf("%-34s %8.1f M rolls/s\n", label, rolls / secs / 1e6);
+}
+
+int main() {
+	const long long N = 50000000;
+	const int sidesList[] = { 6, 20 };
+
+	for (int sides : sidesList) {
+		std::printf("d%d, %lld rolls\n", sides, N);
+
+		report("legacy mt19937 + distribution", N, [&]() {
+			std::mt19937 legacy(12345);
+			long long sum = 0;
+			for (long long i = 0; i < N; i++) {
+				std::uniform_int_distribution<int> dist(1, sides);
+				sum += dist(legacy);
+			}
+			return sum;
+		});
+
+		report("Dice::roll", N, [&]() {
+			seedThreadRng(12345);
+			Dice d(sides);
+			long long sum = 0;
+			for (long long i = 0; i < N; i++) sum += d.roll();
+			return sum;
+		});
+
+		report("Rng::roll", N, [&]() {
+			Rng r(12345);
+			long long sum = 0;
+			for (long long i = 0; i < N; i++) sum += r.roll(sides);
+			return sum;
+		});
+
+		report("Rng::rollN (4096 buffer)", N, [&]() {
+			Rng r(12345);
+			std::vector<int> buf(4096);
+			long long sum = 0;
+			for (long long done = 0; done < N; done += (long long)buf.size()) {
+				r.rollN(sides, buf.data(), buf.size());
+				for (int v : buf) sum += v;
+			}
+			return sum;
+		});
+		std::printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,98 @@
+// TileBitboard against a plain BFS: on random boards of every width around
+// the 64-bit word edges, floodFill from the start must reach exactly the
+// cells a BFS over the non-Blocked tiles reaches, and levelIsConnected must
+// agree with whether that BFS finds every Boss and Exit. Exits 1 on the
+// first board where they differ.
+//
+//   g++ -std=c++17 -O2 tools/floodcheck.cpp TileBitboard.cpp Tile.cpp Dice.cpp -o floodcheck
+//   ./floodcheck --boards 100000 --seed 7
+
+#include "../include/Dice.h"
+#include "../include/TileBitboard.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Cells 4-connected to (sr, sc) through tiles that are not Blocked.
+static void bfs(int rows, int cols, const std::vector<TileKind>& tiles, int sr, int sc,
+                std::vector<uint8_t>& seen, std::vector<int>& queue) {
+	seen.assign((size_t)rows * cols, 0);
+	queue.clear();
+	queue.push_back(sr * cols + sc);
+	seen[sr * cols + sc] = 1;
+	for (size_t head = 0; head < queue.size(); head++) {
+		int r = queue[head] / cols, c = queue[head] % cols;
+		const int dr[4] = { 1, -1, 0, 0 }, dc[4] = { 0, 0, 1, -1 };
+		for (int d = 0; d < 4; d++) {
+			int nr = r + dr[d], nc = c + dc[d];
+			if (nr < 0 || nc < 0 || nr >= rows || nc >= cols) continue;
+			int u = nr * cols + nc;
+			if (seen[u] || tiles[u] == TileKind::Blocked) continue;
+			seen[u] = 1;
+			queue.push_back(u);
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	long long boards = 20000;
+	unsigned long long seed = 7;
+	for (int i = 1; i < argc; i++) {
+		if (!std::strcmp(argv[i], "--boards") && i + 1 < argc) boards = std::atoll(argv[++i]);
+		else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc && parseSeed(argv[i + 1], seed)) i++;
+		else { std::printf("usage: %s [--boards N] [--seed S]\n", argv[0]); return 1; }
+	}
+
+	// Widths that sit on and either side of the word edges, plus any up to 300
+	const int EDGE_COLS[] = { 1, 2, 63, 64, 65, 127, 128, 129, 191, 192, 193 };
+	Rng rng(seed);
+	TileBitboard open, reach;
+	std::vector<TileKind> tiles;
+	std::vector<uint8_t> seen;
+	std::vector<int> queue;
+	long long cells = 0, connected = 0;
+
+	for (long long b = 0; b < boards; b++) {
+		int rows = 1 + (int)rng.bounded(b % 10 == 0 ? 200 : 24);
+		int cols = b % 2 ? EDGE_COLS[rng.bounded(sizeof(EDGE_COLS) / sizeof(EDGE_COLS[0]))] : 1 + (int)rng.bounded(300);
+		uint32_t walls = rng.bounded(70), monsters = rng.bounded(10);
+		tiles.resize((size_t)rows * cols);
+		for (TileKind& k : tiles) {
+			uint32_t u = rng.bounded(100);
+			k = u < walls ? TileKind::Blocked : u < walls + monsters ? TileKind::Monster : TileKind::Empty;
+		}
+		for (int goals = 1 + (int)rng.bounded(3); goals > 0; goals--)
+			tiles[rng.bounded((uint32_t)tiles.size())] = goals % 2 ? TileKind::Boss : TileKind::Exit;
+		int sr = (int)rng.bounded(rows), sc = (int)rng.bounded(cols);
+		tiles[sr * cols + sc] = TileKind::Empty;
+
+		open.setOpen(rows, cols, tiles.data());
+		reach.reset(rows, cols);
+		reach.set(sr, sc);
+		reach.floodFill(open);
+		bfs(rows, cols, tiles, sr, sc, seen, queue);
+
+		bool allGoals = true;
+		for (int i = 0; i < rows * cols; i++) {
+			int r = i / cols, c = i % cols;
+			if ((seen[i] != 0) != reach.test(r, c)) {
+				std::printf("board %lld (%dx%d, start %d,%d): cell %d,%d is %s by BFS but not by floodFill\n",
+				            b, rows, cols, sr, sc, r, c, seen[i] ? "reached" : "unreached");
+				return 1;
+			}
+			if ((tiles[i] == TileKind::Boss || tiles[i] == TileKind::Exit) && !seen[i]) allGoals = false;
+		}
+		if (levelIsConnected(rows, cols, tiles.data(), sr, sc) != allGoals) {
+			std::printf("board %lld (%dx%d, start %d,%d): levelIsConnected says %d, BFS %d\n",
+			            b, rows, cols, sr, sc, !allGoals, allGoals);
+			return 1;
+		}
+		cells += (long long)rows * cols;
+		connected += allGoals;
+	}
+	std::printf("%lld boards (%lld cells, %lld connected): floodFill and levelIsConnected match BFS\n",
+	            boards, cells, connected);
+	return 0;
+}
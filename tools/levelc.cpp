@@ -0,0 +1,48 @@
+// Offline level compiler: validates text layouts and writes the binary
+// level pack the game memory-maps at startup.
+//
+//   g++ -std=c++17 -O2 tools/levelc.cpp LevelPack.cpp Tile.cpp TileBitboard.cpp -o levelc
+//   ./levelc assets/levels.txt assets/levels.rlv
+
+#include "../include/LevelPack.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		std::fprintf(stderr, "usage: %s <levels.txt> <levels.rlv>\n", argv[0]);
+		return 1;
+	}
+
+	std::ifstream in(argv[1]);
+	if (!in) { std::fprintf(stderr, "cannot open %s\n", argv[1]); return 1; }
+	std::stringstream text;
+	text << in.rdbuf();
+
+	std::vector<uint8_t> bytes;
+	std::string error;
+	if (!compileLevels(text.str(), bytes, error)) {
+		std::fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+		return 1;
+	}
+
+	// Round-trip through the loader so a pack that would be rejected is never written
+	LevelPack check;
+	if (!check.loadFromBytes(bytes, error)) {
+		std::fprintf(stderr, "internal error: %s\n", error.c_str());
+		return 1;
+	}
+
+	std::ofstream out(argv[2], std::ios::binary);
+	out.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+	if (!out) { std::fprintf(stderr, "cannot write %s\n", argv[2]); return 1; }
+
+	std::printf("%s: %d levels, %zu bytes\n", argv[2], check.count(), bytes.size());
+	for (int i = 0; i < check.count(); i++) {
+		const LevelView& v = check.level(i);
+		std::printf("  level %d: %dx%d, start (%d,%d)\n", i + 1, v.rows, v.cols, v.startR, v.startC);
+	}
+	return 0;
+}
@@ -0,0 +1,83 @@
+// Procedural level generator: rolls layouts at the given size and densities
+// on every core, keeps the ones whose start reaches every boss and exit, and
+// writes them as a level pack (.rlv) or as text for assets/levels.txt.
+//
+//   g++ -std=c++17 -O2 -pthread tools/levelgen.cpp LevelGen.cpp WorkStealingPool.cpp LevelPack.cpp Tile.cpp TileBitboard.cpp Dice.cpp -o levelgen
+//   ./levelgen --count 10000 --rows 32 --cols 32 --blocks 0.35 --out stress.rlv
+//   ./levelgen --count 5 --out levels.txt
+//   ./levelgen --endless --count 1000 --out endless.rlv
+
+#include "../include/LevelGen.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+
+static void usage(const char* prog) {
+	std::printf("usage: %s [--count N] [--rows R] [--cols C] [--blocks D] [--monsters D] [--bosses K] [--exits K]\n"
+	            "       %*s [--endless] [--seed S] [--threads T] [--out FILE.rlv|FILE.txt]\n", prog, (int)std::strlen(prog), "");
+}
+
+static bool endsWith(const std::string& s, const char* suffix) {
+	size_t n = std::strlen(suffix);
+	return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+int main(int argc, char** argv) {
+	int count = 1000;
+	LevelGenParams params;
+	bool endless = false;
+	int threads = 0;
+	unsigned long long seed = 1;
+	std::string outPath;
+
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--count") && hasValue) count = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--rows") && hasValue) params.rows = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--cols") && hasValue) params.cols = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--blocks") && hasValue) params.blockDensity = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--monsters") && hasValue) params.monsterDensity = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--bosses") && hasValue) params.bosses = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--exits") && hasValue) params.exits = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--seed") && hasValue && parseSeed(argv[i + 1], seed)) i++;
+		else if (!std::strcmp(argv[i], "--threads") && hasValue) threads = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--out") && hasValue) outPath = argv[++i];
+		else if (!std::strcmp(argv[i], "--endless")) endless = true;
+		else { usage(argv[0]); return 1; }
+	}
+	// The pack's level table is 16-bit
+	if (count <= 0 || count > 65535) { usage(argv[0]); return 1; }
+
+	WorkStealingPool pool(threads);
+	std::vector<LevelData> levels;
+	std::string error;
+	long long attempts = 0;
+	auto start = std::chrono::steady_clock::now();
+	bool ok = endless
+		? generateLevels(endlessLevelParams, count, seed, pool, levels, error, &attempts)
+		: generateLevels([&](int) { return params; }, count, seed, pool, levels, error, &attempts);
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (!ok) { std::fprintf(stderr, "%s\n", error.c_str()); return 1; }
+
+	std::printf("%d levels on %d threads in %.3f s: %.0f levels/s, %.2f candidates per level (%.0f candidates/s)\n",
+	            count, pool.size(), secs, count / secs, (double)attempts / count, attempts / secs);
+	if (outPath.empty()) return 0;
+
+	std::ofstream out(outPath, std::ios::binary);
+	if (endsWith(outPath, ".txt")) {
+		out << "# Generated by tools/levelgen (seed " << seed << ")\n";
+		for (int i = 0; i < count; i++) out << "\n# Level " << i + 1 << "\n" << levelToText(levels[i]);
+	} else {
+		std::vector<uint8_t> bytes;
+		packLevels(levels, bytes);
+		out.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+	}
+	if (!out) { std::fprintf(stderr, "cannot write %s\n", outPath.c_str()); return 1; }
+	std::printf("wrote %s\n", outPath.c_str());
+	return 0;
+}
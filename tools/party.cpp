@@ -0,0 +1,140 @@
+// Party battles (PartyBattle.h): a party of players against an enemy group,
+// in initiative order. Plays --battles battles of --players vs --enemies and
+// prints the win rate, rounds and turns per second. --scaling plays sides of
+// 1, 2, 4... up to --max combatants each and reports the time per turn,
+// which should grow with log n rather than n.
+//
+// Needs only the core sources (no SFML):
+//   g++ -std=c++17 -O2 -pthread tools/party.cpp PartyBattle.cpp Simulator.cpp CombatAI.cpp CombatOdds.cpp CombatSystem.cpp CombatLog.cpp Dice.cpp Entity.cpp StatusEffects.cpp Player.cpp Enemy.cpp -o party
+//   ./party --players 4 --enemies 6 --target weakest
+//   ./party --scaling --max 1024
+
+#include "../include/PartyBattle.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+static void usage(const char* prog) {
+	std::printf("usage: %s [--players N] [--enemies M] [--battles B] [--level L] [--policy attack|ability|effects]\n"
+	            "       [--target front|random|weakest] [--seed S] [--scaling [--max N]]\n", prog);
+}
+
+// The combatants of one scenario, built once and healed before each battle:
+// players cycle through the classes, every fourth enemy is an ogre.
+struct Scenario {
+	std::vector<Player> players;
+	std::vector<std::unique_ptr<Enemy>> enemies;
+
+	Scenario(int playerCount, int enemyCount, int level) {
+		for (int i = 0; i < playerCount; i++)
+			players.emplace_back((PlayerClass)(i % PLAYER_CLASS_COUNT), 0, 0);
+		for (int i = 0; i < enemyCount; i++)
+			enemies.emplace_back(makeEnemy(i % 4 == 3 ? EnemyKind::Ogre : EnemyKind::Goblin, level));
+	}
+
+	void setUp(PartyBattle& battle, SimPolicy policy, TargetRule rule) {
+		battle.reset();
+		for (Player& p : players) {
+			p.hp = p.maxHp;
+			p.mana = p.getClassDef().mana;
+			battle.addPlayer(&p, policy, rule);
+		}
+		for (auto& e : enemies) {
+			e->hp = e->maxHp;
+			battle.addEnemy(e.get(), rule);
+		}
+		battle.start();
+	}
+};
+
+struct Totals {
+	long long battles = 0, wins = 0, timeouts = 0, rounds = 0, turns = 0;
+	double secs = 0;
+};
+
+static Totals play(int playerCount, int enemyCount, int level, long long battles, SimPolicy policy,
+                   TargetRule rule, uint64_t seed) {
+	Scenario scenario(playerCount, enemyCount, level);
+	PartyBattle battle;
+	Totals t;
+	// Generous: every combatant gets a few hundred turns
+	long long maxTurns = 300LL * (playerCount + enemyCount);
+
+	auto start = std::chrono::steady_clock::now();
+	for (long long i = 0; i < battles; i++) {
+		Rng rng(seed, (uint64_t)i);
+		RngScope scope(rng);
+		scenario.setUp(battle, policy, rule);
+		battle.run(maxTurns);
+		t.battles++;
+		t.turns += battle.getTurns();
+		t.rounds += battle.getRound();
+		if (!battle.isOver()) t.timeouts++;
+		else if (battle.winner() == SIDE_PLAYER) t.wins++;
+	}
+	t.secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return t;
+}
+
+int main(int argc, char** argv) {
+	int players = 4, enemies = 6, level = 0, maxSide = 512;
+	long long battles = 20000;
+	SimPolicy policy = SimPolicy::Ability;
+	TargetRule rule = TargetRule::Front;
+	unsigned long long seed = 1;
+	bool scaling = false;
+
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--players") && hasValue) players = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--enemies") && hasValue) enemies = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--battles") && hasValue) battles = std::atoll(argv[++i]);
+		else if (!std::strcmp(argv[i], "--level") && hasValue) level = std::atoi(argv[++i]) - 1;
+		else if (!std::strcmp(argv[i], "--seed") && hasValue && parseSeed(argv[i + 1], seed)) i++;
+		else if (!std::strcmp(argv[i], "--max") && hasValue) maxSide = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--scaling")) scaling = true;
+		else if (!std::strcmp(argv[i], "--policy") && hasValue) {
+			const char* p = argv[++i];
+			if (!std::strcmp(p, "attack")) policy = SimPolicy::Attack;
+			else if (!std::strcmp(p, "ability")) policy = SimPolicy::Ability;
+			else if (!std::strcmp(p, "effects")) policy = SimPolicy::Effects;
+			else { usage(argv[0]); return 1; }
+		}
+		else if (!std::strcmp(argv[i], "--target") && hasValue) {
+			const char* t = argv[++i];
+			if (!std::strcmp(t, "front")) rule = TargetRule::Front;
+			else if (!std::strcmp(t, "random")) rule = TargetRule::Random;
+			else if (!std::strcmp(t, "weakest")) rule = TargetRule::Weakest;
+			else { usage(argv[0]); return 1; }
+		}
+		else { usage(argv[0]); return 1; }
+	}
+	if (players <= 0 || enemies <= 0 || battles <= 0 || level < 0 || maxSide <= 0) { usage(argv[0]); return 1; }
+
+	if (scaling) {
+		// About the same number of turns at every size, so the times compare
+		std::printf("policy=%s target=%s level=%d\n", simPolicyName(policy), targetRuleName(rule), level + 1);
+		std::printf("%6s %9s %12s %10s %10s %8s\n", "side", "battles", "turns", "ns/turn", "rounds", "win%");
+		for (int n = 1; n <= maxSide; n *= 2) {
+			long long count = std::max(20LL, 400000LL / (n * 10));
+			Totals t = play(n, n, level, count, policy, rule, seed);
+			std::printf("%6d %9lld %12lld %10.1f %10.1f %7.1f%%\n", n, t.battles, t.turns,
+			            t.secs * 1e9 / std::max(1LL, t.turns), (double)t.rounds / t.battles,
+			            100.0 * t.wins / t.battles);
+		}
+		return 0;
+	}
+
+	Totals t = play(players, enemies, level, battles, policy, rule, seed);
+	std::printf("%d players vs %d enemies, level %d, policy=%s, target=%s, seed=%llu\n", players, enemies,
+	            level + 1, simPolicyName(policy), targetRuleName(rule), seed);
+	std::printf("%lld battles: party won %.2f%%, %lld timeouts, %.2f rounds and %.1f turns a battle\n",
+	            t.battles, 100.0 * t.wins / t.battles, t.timeouts, (double)t.rounds / t.battles,
+	            (double)t.turns / t.battles);
+	std::printf("%.3f s: %.0f battles/s, %.0f turns/s\n", t.secs, t.battles / t.secs, t.turns / t.secs);
+	return 0;
+}
@@ -0,0 +1,110 @@
+// Whole-campaign playthroughs: a scripted player (see Playthrough.h) runs
+// every level of the pack through Game, many runs at once on a
+// work-stealing pool, and the totals come out as CSV (clear rate per class,
+// deaths and turns per level). --scaling repeats the batch at 1, 2, 4...
+// threads and reports the speedup.
+//
+// Needs only the core sources (no SFML):
+//   g++ -std=c++17 -O2 -pthread tools/playthrough.cpp Playthrough.cpp WorkStealingPool.cpp Game.cpp Board.cpp Reachability.cpp Encounter.cpp AllocStats.cpp Simulator.cpp CombatAI.cpp CombatOdds.cpp CombatSystem.cpp CombatLog.cpp Dice.cpp Entity.cpp StatusEffects.cpp Player.cpp Enemy.cpp LevelPack.cpp Tile.cpp TileBitboard.cpp -o playthrough
+//   ./playthrough --runs 30000 --policy ability --csv runs.csv
+
+#include "../include/Playthrough.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+static void usage(const char* prog) {
+	std::printf("usage: %s [--runs N] [--threads T] [--policy attack|ability|search|effects] [--seed S] [--csv FILE] [--scaling]\n", prog);
+}
+
+static double timePlaythroughs(const LevelPack& levels, long long runs, SimPolicy policy, int threads,
+                               uint64_t seed, PlaythroughStats& stats, long long& steals) {
+	WorkStealingPool pool(threads);
+	auto start = std::chrono::steady_clock::now();
+	stats = runPlaythroughs(levels, runs, policy, pool, seed);
+	steals = pool.getSteals();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+	long long runs = 30000;
+	int threads = 0;
+	SimPolicy policy = SimPolicy::Ability;
+	unsigned long long seed = 1;
+	std::string csvPath;
+	bool scaling = false;
+
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--runs") && hasValue) runs = std::atoll(argv[++i]);
+		else if (!std::strcmp(argv[i], "--threads") && hasValue) threads = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--seed") && hasValue && parseSeed(argv[i + 1], seed)) i++;
+		else if (!std::strcmp(argv[i], "--csv") && hasValue) csvPath = argv[++i];
+		else if (!std::strcmp(argv[i], "--scaling")) scaling = true;
+		else if (!std::strcmp(argv[i], "--policy") && hasValue) {
+			const char* p = argv[++i];
+			if (!std::strcmp(p, "attack")) policy = SimPolicy::Attack;
+			else if (!std::strcmp(p, "ability")) policy = SimPolicy::Ability;
+			else if (!std::strcmp(p, "search")) policy = SimPolicy::Search;
+			else if (!std::strcmp(p, "effects")) policy = SimPolicy::Effects;
+			else { usage(argv[0]); return 1; }
+		}
+		else { usage(argv[0]); return 1; }
+	}
+	if (runs <= 0) { usage(argv[0]); return 1; }
+	if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+	LevelPack levels;
+	std::string error;
+	if (!levels.open("assets/levels.rlv", error) && !levels.compileFromFile("assets/levels.txt", error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	PlaythroughStats stats;
+	long long steals = 0;
+	if (scaling) {
+		// Same seed at every width: the totals must match exactly
+		std::printf("%7s %10s %10s %8s %10s %7s\n", "threads", "secs", "runs/s", "speedup", "efficiency", "steals");
+		double base = 0;
+		PlaythroughStats first;
+		for (int t = 1;; t = std::min(t * 2, threads)) {
+			double secs = timePlaythroughs(levels, runs, policy, t, seed, stats, steals);
+			if (t == 1) { base = secs; first = stats; }
+			bool same = true;
+			for (int c = 0; c < PLAYER_CLASS_COUNT; c++)
+				same = same && stats.classes[c].clears == first.classes[c].clears && stats.classes[c].turns == first.classes[c].turns;
+			std::printf("%7d %10.3f %10.0f %7.2fx %9.0f%% %7lld%s\n", t, secs, runs / secs, base / secs,
+			            base / secs / t * 100.0, steals, same ? "" : "  TOTALS DIFFER");
+			if (!same) return 1;
+			if (t == threads) break;
+		}
+	} else {
+		double secs = timePlaythroughs(levels, runs, policy, threads, seed, stats, steals);
+		std::fprintf(stderr, "%lld runs on %d threads in %.3f s: %.0f runs/s, %lld steals\n",
+		             runs, threads, secs, runs / secs, steals);
+	}
+
+	for (int c = 0; c < PLAYER_CLASS_COUNT; c++) {
+		const ClassRunStats& cs = stats.classes[c];
+		std::fprintf(stderr, "%-8s clear %5.1f%%  died %5.1f%%  timed out %lld\n", playerClassName((PlayerClass)c),
+		             cs.clearRate() * 100.0, cs.runs ? 100.0 * cs.deaths / cs.runs : 0.0, cs.timeouts);
+	}
+
+	if (csvPath.empty()) {
+		if (!scaling) writePlaythroughCsv(stats, std::cout);
+		return 0;
+	}
+	std::ofstream csv(csvPath);
+	writePlaythroughCsv(stats, csv);
+	if (!csv) {
+		std::fprintf(stderr, "cannot write %s\n", csvPath.c_str());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,133 @@
+// Reachability's incremental distance fields against full rebuilds: on
+// random boards, tiles are changed one at a time (walls knocked down or put
+// up, monsters cleared, bosses and exits moved) and after every change the
+// fields repaired by tileChanged must equal a fresh build, and every build
+// must equal a plain multi-source BFS. Also prints how many tiles an update
+// visits next to a rebuild. Exits 1 on the first difference.
+//
+//   g++ -std=c++17 -O2 tools/reachcheck.cpp Reachability.cpp Board.cpp Tile.cpp Dice.cpp Profiler.cpp -pthread -o reachcheck
+//   ./reachcheck --boards 2000 --changes 200 --seed 11
+
+#include "../include/Board.h"
+#include "../include/Dice.h"
+#include "../include/Reachability.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const int DR[4] = { 1, -1, 0, 0 }, DC[4] = { 0, 0, 1, -1 };
+
+// Steps from the nearest tile of kind `target` (or from `start`, if given)
+// over non-blocked tiles.
+static void bfs(const Board& board, TileKind target, int start, std::vector<int32_t>& dist, std::vector<int>& queue) {
+	int rows = board.getRows(), cols = board.getCols();
+	dist.assign((size_t)rows * cols, DistanceField::UNREACHABLE);
+	queue.clear();
+	for (int i = 0; i < rows * cols; i++) {
+		bool source = start >= 0 ? i == start : board.getTile(i / cols, i % cols) == target;
+		if (source && !board.isBlocked(i / cols, i % cols)) { dist[i] = 0; queue.push_back(i); }
+	}
+	for (size_t head = 0; head < queue.size(); head++) {
+		int r = queue[head] / cols, c = queue[head] % cols;
+		for (int d = 0; d < 4; d++) {
+			int nr = r + DR[d], nc = c + DC[d];
+			if (board.isBlocked(nr, nc) || dist[nr * cols + nc] != DistanceField::UNREACHABLE) continue;
+			dist[nr * cols + nc] = dist[queue[head]] + 1;
+			queue.push_back(nr * cols + nc);
+		}
+	}
+}
+
+static bool sameField(const char* name, const DistanceField& got, const DistanceField& want, int rows, int cols,
+                      long long board, int change) {
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			if (got.at(r, c) == want.at(r, c)) continue;
+			std::printf("board %lld, change %d: %s at %d,%d is %d, rebuild says %d\n",
+			            board, change, name, r, c, got.at(r, c), want.at(r, c));
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool matchesBfs(const char* name, const DistanceField& field, const std::vector<int32_t>& dist, int cols,
+                       long long board) {
+	for (size_t i = 0; i < dist.size(); i++) {
+		int r = (int)i / cols, c = (int)i % cols;
+		if (field.at(r, c) == dist[i]) continue;
+		std::printf("board %lld: built %s at %d,%d is %d, BFS says %d\n", board, name, r, c, field.at(r, c), dist[i]);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	long long boards = 300;
+	int changes = 100;
+	unsigned long long seed = 11;
+	for (int i = 1; i < argc; i++) {
+		if (!std::strcmp(argv[i], "--boards") && i + 1 < argc) boards = std::atoll(argv[++i]);
+		else if (!std::strcmp(argv[i], "--changes") && i + 1 < argc) changes = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc && parseSeed(argv[i + 1], seed)) i++;
+		else { std::printf("usage: %s [--boards N] [--changes K] [--seed S]\n", argv[0]); return 1; }
+	}
+
+	Rng rng(seed);
+	Board board(1, 1);
+	Reachability live, fresh;
+	std::vector<TileKind> tiles;
+	std::vector<int32_t> dist;
+	std::vector<int> queue;
+	long long updates = 0, updateCells = 0, rebuildCells = 0;
+
+	for (long long b = 0; b < boards; b++) {
+		int rows = 1 + (int)rng.bounded(b % 10 == 0 ? 120 : 30), cols = 1 + (int)rng.bounded(b % 10 == 0 ? 120 : 30);
+		uint32_t walls = rng.bounded(50), monsters = rng.bounded(15);
+		tiles.resize((size_t)rows * cols);
+		for (TileKind& k : tiles) {
+			uint32_t u = rng.bounded(100);
+			k = u < walls ? TileKind::Blocked : u < walls + monsters ? TileKind::Monster : TileKind::Empty;
+		}
+		tiles[rng.bounded((uint32_t)tiles.size())] = TileKind::Boss;
+		tiles[rng.bounded((uint32_t)tiles.size())] = TileKind::Exit;
+		int start = (int)rng.bounded((uint32_t)tiles.size());
+		tiles[start] = TileKind::Empty;
+		int startR = start / cols, startC = start % cols;
+
+		board.load(rows, cols, tiles.data());
+		live.build(board, startR, startC);
+		bfs(board, TileKind::Empty, start, dist, queue);
+		if (!matchesBfs("fromStart", live.distanceFromStart(), dist, cols, b)) return 1;
+		bfs(board, TileKind::Boss, -1, dist, queue);
+		if (!matchesBfs("toBoss", live.distanceToBoss(), dist, cols, b)) return 1;
+		bfs(board, TileKind::Exit, -1, dist, queue);
+		if (!matchesBfs("toExit", live.distanceToExit(), dist, cols, b)) return 1;
+
+		for (int k = 0; k < changes; k++) {
+			// Mostly the game's own change (a cleared monster), plus walls
+			// going up and down and goals appearing or vanishing
+			int r = (int)rng.bounded(rows), c = (int)rng.bounded(cols);
+			uint32_t u = rng.bounded(100);
+			TileKind kind = u < 40 ? TileKind::Empty : u < 70 ? TileKind::Blocked : u < 85 ? TileKind::Monster
+			              : u < 93 ? TileKind::Boss : TileKind::Exit;
+			if (board.getTile(r, c) == kind) continue;
+			board.setTile(r, c, kind);
+			live.tileChanged(board, r, c);
+			fresh.build(board, startR, startC);
+			if (!sameField("fromStart", live.distanceFromStart(), fresh.distanceFromStart(), rows, cols, b, k)) return 1;
+			if (!sameField("toBoss", live.distanceToBoss(), fresh.distanceToBoss(), rows, cols, b, k)) return 1;
+			if (!sameField("toExit", live.distanceToExit(), fresh.distanceToExit(), rows, cols, b, k)) return 1;
+			updates++;
+			updateCells += live.distanceFromStart().getLastUpdateCells() + live.distanceToBoss().getLastUpdateCells()
+			               + live.distanceToExit().getLastUpdateCells();
+			rebuildCells += 3LL * rows * cols;
+		}
+	}
+	std::printf("%lld boards, %lld tile changes: incremental fields match rebuilds and BFS\n", boards, updates);
+	std::printf("an update visits %.1f tiles where a rebuild visits %.1f\n",
+	            updates ? (double)updateCells / updates : 0.0, updates ? (double)rebuildCells / updates : 0.0);
+	return 0;
+}
@@ -0,0 +1,218 @@
+// Headless replay of recorded runs (main --record FILE): every recording is
+// played back through Game without a window or battle delays and must end
+// in the recorded state. --generate writes a corpus of bot-played runs.
+// --check-saves also snapshots the game after every input, restores the
+// snapshot into a fresh Game and checks both end up in the same state.
+//
+// Needs only the core sources (no SFML):
+//   g++ -std=c++17 -O2 -pthread tools/replay.cpp Game.cpp Recording.cpp SaveGame.cpp Board.cpp Reachability.cpp Encounter.cpp AllocStats.cpp Simulator.cpp CombatAI.cpp CombatOdds.cpp CombatSystem.cpp CombatLog.cpp Dice.cpp Entity.cpp StatusEffects.cpp Player.cpp Enemy.cpp LevelPack.cpp Tile.cpp TileBitboard.cpp -o replay
+//   ./replay --generate 1000 --out corpus
+//   ./replay corpus/*.rrec
+//   ./replay --check-saves corpus/*.rrec
+
+#include "../include/Recording.h"
+#include "../include/SaveGame.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void usage(const char* prog) {
+	std::printf("usage: %s [--threads T] [--check-saves] FILE.rrec...\n"
+	            "       %s --generate N --out DIR [--seed S] [--threads T]\n", prog, prog);
+}
+
+// Plays one run to its end with a simple bot: walk towards the boss, then
+// the exit, with the odd random step; in battle use a random ability while
+// mana lasts, sometimes defend or run. Its own dice are separate from the
+// game's.
+static void playBot(Game& game, uint64_t botSeed) {
+	Rng bot(botSeed);
+	game.apply({ GameInputKind::ChooseClass, (uint8_t)bot.bounded(3) });
+
+	const int MAX_INPUTS = 5000;
+	while ((int)game.getInputs().size() < MAX_INPUTS) {
+		game.settle();
+		GameState state = game.getState();
+		if (state == GameState::GameOver || state == GameState::Victory) break;
+
+		if (state == GameState::InBattle) {
+			const Player& p = *game.getPlayer();
+			CombatAction a = CombatAction::Attack;
+			uint32_t r = bot.bounded(20);
+			if (r == 0) a = CombatAction::Run;
+			else if (r < 3) a = CombatAction::Defend;
+			else if (p.abilityCount() > 0 && p.mana >= ABILITY_MANA_COST) a = CombatAction::Ability;
+			int ability = a == CombatAction::Ability ? (int)bot.bounded((uint32_t)p.abilityCount()) : 0;
+			if (p.mana < p.ability(ability).manaCost) ability = 0;
+			game.apply({ GameInputKind::BattleAction, battleInputValue(a, ability) });
+			continue;
+		}
+
+		if (game.getMovePoints() == 0) {
+			game.apply({ GameInputKind::Roll });
+			continue;
+		}
+		const Player& p = *game.getPlayer();
+		Reachability& reach = game.getReach();
+		const DistanceField& goal = game.isLevelBossDefeated() ? reach.distanceToExit() : reach.distanceToBoss();
+		MoveDir dir = (MoveDir)bot.bounded(4);
+		int nr, nc;
+		if (bot.bounded(8) != 0 && goal.nextStep(p.posR, p.posC, nr, nc)) {
+			if (nr < p.posR) dir = MoveDir::Up;
+			else if (nr > p.posR) dir = MoveDir::Down;
+			else if (nc < p.posC) dir = MoveDir::Left;
+			else dir = MoveDir::Right;
+		}
+		game.apply({ GameInputKind::Move, (uint8_t)dir });
+	}
+	game.settle();
+}
+
+// Replays `rec`, and before every input saves the game, loads the snapshot
+// into a second Game and compares their hashes. Adds the time spent in
+// saveSnapshot and loadSnapshot to the totals.
+static bool checkSaves(const GameRecording& rec, const LevelPack& levels, std::string& error,
+                       double& saveSecs, double& loadSecs, long long& snapshots, long long& bytes) {
+	std::ostream silent(nullptr);
+	Game game(levels, rec.seed, silent);
+	Game restored(levels, 0, silent);
+	std::vector<uint8_t> snapshot;
+
+	for (size_t i = 0; i <= rec.inputs.size(); i++) {
+		game.settle();
+		auto t0 = std::chrono::steady_clock::now();
+		game.saveSnapshot(snapshot);
+		auto t1 = std::chrono::steady_clock::now();
+		bool ok = restored.loadSnapshot(snapshot.data(), snapshot.size(), error);
+		auto t2 = std::chrono::steady_clock::now();
+		saveSecs += std::chrono::duration<double>(t1 - t0).count();
+		loadSecs += std::chrono::duration<double>(t2 - t1).count();
+		snapshots++;
+		bytes += (long long)snapshot.size();
+		if (!ok) return false;
+		if (restored.stateHash() != game.stateHash()) {
+			error = "snapshot before input " + std::to_string(i) + " restores a different state";
+			return false;
+		}
+		if (i == rec.inputs.size()) break;
+		if (!game.apply(rec.inputs[i])) {
+			error = "input " + std::to_string(i) + " rejected";
+			return false;
+		}
+	}
+	if (recordingHash(game, rec.version) != rec.finalHash) {
+		error = "final state differs";
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	int threads = 0;
+	int generate = 0;
+	bool saves = false;
+	std::string outDir;
+	unsigned long long seed = 1;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--threads") && hasValue) threads = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--generate") && hasValue) generate = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--out") && hasValue) outDir = argv[++i];
+		else if (!std::strcmp(argv[i], "--seed") && hasValue && parseSeed(argv[i + 1], seed)) i++;
+		else if (!std::strcmp(argv[i], "--check-saves")) saves = true;
+		else if (argv[i][0] == '-') { usage(argv[0]); return 1; }
+		else files.push_back(argv[i]);
+	}
+	if ((generate > 0) == !files.empty() || (generate > 0 && outDir.empty())) { usage(argv[0]); return 1; }
+	if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+	if (generate > 0) {
+		std::error_code ec;
+		std::filesystem::create_directories(outDir, ec);
+		if (ec) {
+			std::fprintf(stderr, "cannot create %s: %s\n", outDir.c_str(), ec.message().c_str());
+			return 1;
+		}
+	}
+
+	LevelPack levels;
+	std::string error;
+	if (!levels.open("assets/levels.rlv", error) && !levels.compileFromFile("assets/levels.txt", error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	int jobs = generate > 0 ? generate : (int)files.size();
+	std::atomic<int> next(0), failed(0);
+	std::atomic<long long> inputs(0);
+	std::atomic<long long> snapshots(0), snapshotBytes(0);
+	std::mutex timeMutex;
+	double saveSecs = 0, loadSecs = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++) {
+		workers.emplace_back([&]() {
+			std::ostream silent(nullptr);
+			for (int i = next++; i < jobs; i = next++) {
+				std::string err;
+				if (generate > 0) {
+					Game game(levels, seed + (uint64_t)i, silent);
+					playBot(game, ~(seed + (uint64_t)i));
+					GameRecording rec = GameRecording::capture(game);
+					inputs += (long long)rec.inputs.size();
+					char name[64];
+					std::snprintf(name, sizeof(name), "/run%06d.rrec", i);
+					if (!rec.save(outDir + name, err)) {
+						std::fprintf(stderr, "%s\n", err.c_str());
+						failed++;
+					}
+					continue;
+				}
+
+				GameRecording rec;
+				bool ok = rec.load(files[i], err);
+				if (ok && saves) {
+					double s = 0, l = 0;
+					long long n = 0, b = 0;
+					ok = checkSaves(rec, levels, err, s, l, n, b);
+					snapshots += n;
+					snapshotBytes += b;
+					std::lock_guard<std::mutex> lock(timeMutex);
+					saveSecs += s;
+					loadSecs += l;
+				} else if (ok) {
+					ok = replayRecording(rec, levels, err);
+				}
+				inputs += (long long)rec.inputs.size();
+				if (!ok) {
+					std::fprintf(stderr, "FAIL %s: %s\n", files[i].c_str(), err.c_str());
+					failed++;
+				}
+			}
+		});
+	}
+	for (auto& w : workers) w.join();
+
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("%s %d runs (%lld inputs) on %d threads in %.3f s: %.0f runs/min, %d failed\n",
+	            generate > 0 ? "generated" : "replayed", jobs, inputs.load(), threads, secs,
+	            jobs / secs * 60.0, failed.load());
+	if (snapshots > 0) {
+		std::printf("%lld snapshots round-tripped, avg %.0f bytes, save %.2f us, load %.2f us\n",
+		            snapshots.load(), (double)snapshotBytes / snapshots, saveSecs * 1e6 / snapshots,
+		            loadSecs * 1e6 / snapshots);
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+// Headless Monte Carlo balance check: every class against every encounter
+// startBattle() can produce, at every level index.
+//
+//   g++ -std=c++17 -O2 -pthread tools/simulate.cpp Simulator.cpp CombatAI.cpp CombatOdds.cpp CombatSystem.cpp CombatLog.cpp Dice.cpp Entity.cpp StatusEffects.cpp Player.cpp Enemy.cpp LevelPack.cpp Tile.cpp TileBitboard.cpp -o simulate
+//   ./simulate --battles 1000000 --levels 3 --policy ability --threads 8
+
+#include "../include/Simulator.h"
+#include "../include/LevelPack.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static void usage(const char* prog) {
+	std::printf("usage: %s [--battles N] [--levels L] [--threads T] [--policy attack|ability|search|effects] [--seed S]\n", prog);
+}
+
+int main(int argc, char** argv) {
+	long long battles = 100000;
+	int levels = 0;		// default: as many as the campaign pack holds
+	int threads = 0;
+	SimPolicy policy = SimPolicy::Attack;
+	unsigned long long seed = 1;
+
+	for (int i = 1; i < argc; i++) {
+		bool hasValue = i + 1 < argc;
+		if (!std::strcmp(argv[i], "--battles") && hasValue) battles = std::atoll(argv[++i]);
+		else if (!std::strcmp(argv[i], "--levels") && hasValue) levels = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--threads") && hasValue) threads = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--seed") && hasValue && parseSeed(argv[i + 1], seed)) i++;
+		else if (!std::strcmp(argv[i], "--policy") && hasValue) {
+			const char* p = argv[++i];
+			if (!std::strcmp(p, "attack")) policy = SimPolicy::Attack;
+			else if (!std::strcmp(p, "ability")) policy = SimPolicy::Ability;
+			else if (!std::strcmp(p, "search")) policy = SimPolicy::Search;
+			else if (!std::strcmp(p, "effects")) policy = SimPolicy::Effects;
+			else { usage(argv[0]); return 1; }
+		}
+		else { usage(argv[0]); return 1; }
+	}
+	if (levels == 0) {
+		LevelPack pack;
+		std::string error;
+		levels = pack.open("assets/levels.rlv", error) ? pack.count() : 3;
+	}
+	if (battles <= 0 || levels <= 0) { usage(argv[0]); return 1; }
+	if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+	const PlayerClass classes[] = { PlayerClass::Soldier, PlayerClass::Archer, PlayerClass::Mage };
+	const EnemyKind enemies[] = { EnemyKind::Goblin, EnemyKind::Ogre, EnemyKind::Boss };
+
+	std::printf("%lld battles per matchup, %d threads, policy=%s, seed=%llu\n\n", battles, threads,
+	            simPolicyName(policy), seed);
+	std::printf("%-8s %-7s %3s | %7s %8s %8s | %6s %4s %4s %4s | %6s %6s | %-13s | %-13s\n",
+	            "class", "enemy", "lvl", "win%", "timeout", "fled", "turns", "p10", "p50", "p90",
+	            "hit%", "crit%", "hp% p10/50/90", "foe% p10/50/90");
+
+	auto start = std::chrono::steady_clock::now();
+	long long total = 0;
+
+	for (PlayerClass cls : classes) {
+		for (EnemyKind kind : enemies) {
+			for (int lvl = 0; lvl < levels; lvl++) {
+				MatchupStats s = runMatchup(cls, kind, lvl, battles, policy, threads, seed);
+				total += s.battles;
+				std::printf("%-8s %-7s %3d | %6.2f%% %8lld %8lld | %6.2f %4d %4d %4d | %5.1f%% %5.1f%% | %3d/%3d/%3d   | %3d/%3d/%3d\n",
+				            playerClassName(cls), enemyKindName(kind), lvl + 1,
+				            100.0 * s.winRate(), s.timeouts, s.flees, s.meanTurns(),
+				            s.turnPercentile(0.1), s.turnPercentile(0.5), s.turnPercentile(0.9),
+				            100.0 * s.playerHitRate(), 100.0 * s.playerCritRate(),
+				            s.hpPercentile(s.playerHpHist, 0.1), s.hpPercentile(s.playerHpHist, 0.5),
+				            s.hpPercentile(s.playerHpHist, 0.9),
+				            s.hpPercentile(s.enemyHpHist, 0.1), s.hpPercentile(s.enemyHpHist, 0.5),
+				            s.hpPercentile(s.enemyHpHist, 0.9));
+			}
+		}
+	}
+
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("\n%lld battles in %.2fs (%.0f battles/s)\n", total, secs, total / secs);
+	return 0;
+}